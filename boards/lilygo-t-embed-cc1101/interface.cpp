@@ -262,6 +262,7 @@ void checkReboot() {
                     powerDownNFC();
                     powerDownCC1101();
                     tft.sleep(true);
+                    bruceConfig.flush();
                     digitalWrite(PIN_POWER_ON, LOW);
                     esp_sleep_enable_ext0_wakeup(GPIO_NUM_6, LOW);
                     esp_deep_sleep_start();
@@ -156,6 +156,28 @@ async function requestPost (url, data) {
   });
 }
 
+// Same as requestGet/requestPost, but resolves with the XMLHttpRequest so headers and binary bodies can be read
+async function requestRaw (method, url, data, body, responseType) {
+  return new Promise((resolve, reject) => {
+    let realUrl = url;
+    if (IS_DEV) realUrl = "/bruce" + url;
+    if (data) realUrl += "?" + new URLSearchParams(data).toString();
+    let req = new XMLHttpRequest();
+    req.open(method, realUrl, true);
+    if (responseType) req.responseType = responseType;
+    if (body !== undefined) req.setRequestHeader("Content-Type", "application/octet-stream");
+    req.onload = () => {
+      if (req.status >= 200 && req.status < 300) {
+        resolve(req);
+      } else {
+        reject(new Error(`Request failed with status ${req.status}`));
+      }
+    };
+    req.onerror = () => reject(new Error("Network error"));
+    req.send(body);
+  });
+}
+
 function stringToId(str) {
   let hash = 0, i, chr;
   if (str.length === 0) return hash.toString();
@@ -332,6 +354,11 @@ function renderFileRow(fileList) {
       e.querySelector(".col-name").textContent = name;
       e.querySelector(".col-name").setAttribute("title", name);
       e.querySelector(".col-action").classList.add("type-folder");
+
+      let downloadUrl = `/file?fs=${currentDrive}&name=${encodeURIComponent(dPath)}&action=downloadfolder`;
+      if (IS_DEV) downloadUrl = "/bruce" + downloadUrl;
+      e.querySelector(".act-download").setAttribute("download", name + ".tar");
+      e.querySelector(".act-download").setAttribute("href", downloadUrl);
     }
     $("table.explorer tbody").appendChild(e);
   });
@@ -364,6 +391,77 @@ async function fetchSystemInfo() {
   Dialog.loading.hide();
 }
 
+// Files are edited one page at a time, so the device never holds more than a fixed buffer of them
+const EDITOR_PAGE_SIZE = 64 * 1024;
+const editorPage = {
+  offset: 0,  // byte offset of the page in the file
+  length: 0,  // byte length of the page as stored in the file
+  size: 0,    // total file size
+  history: [] // offsets of the previous pages, pages end on a line break so they can't be computed back
+};
+
+// Cut a page on its last line break, or at least on a UTF-8 character boundary
+function pageBoundary(bytes, isLast) {
+  if (isLast) return bytes.length;
+  let end = bytes.lastIndexOf(0x0A) + 1;
+  if (end > 0) return end;
+  end = bytes.length;
+  while (end > 0 && (bytes[end - 1] & 0xC0) === 0x80) end--;
+  if (end > 0 && bytes[end - 1] >= 0xC0) end--;
+  return end || bytes.length;
+}
+
+async function loadEditorPage(file, offset) {
+  let editor = $(".dialog.editor .file-content");
+  let req = await requestRaw("GET", "/file", {
+    fs: currentDrive,
+    name: file,
+    action: "read",
+    offset: offset,
+    length: EDITOR_PAGE_SIZE
+  }, undefined, "arraybuffer");
+
+  let bytes = new Uint8Array(req.response);
+  editorPage.size = parseInt(req.getResponseHeader("X-File-Size")) || bytes.length;
+  editorPage.offset = offset;
+  editorPage.length = pageBoundary(bytes, offset + bytes.length >= editorPage.size);
+
+  let text = new TextDecoder().decode(bytes.subarray(0, editorPage.length));
+  editor.value = text;
+  editor.setAttribute("data-hash", calcHash(text));
+  $(".act-save-edit-file").disabled = true;
+  updateEditorPager();
+}
+
+function updateEditorPager() {
+  let paged = editorPage.size > EDITOR_PAGE_SIZE;
+  $(".dialog.editor .editor-pager").classList.toggle("hidden", !paged);
+  if (!paged) return;
+  let end = editorPage.offset + editorPage.length;
+  let kb = (n) => (n / 1024).toFixed(1);
+  $(".dialog.editor .editor-page-info").textContent = `${kb(editorPage.offset)}-${kb(end)} of ${kb(editorPage.size)} KB`;
+  $(".act-editor-prev").disabled = editorPage.history.length === 0;
+  $(".act-editor-next").disabled = end >= editorPage.size;
+}
+
+async function moveEditorPage(forward) {
+  let editor = $(".dialog.editor .file-content");
+  let filename = $(".dialog.editor .editor-file-name").textContent.trim();
+  if (isModified(editor)) await saveEditorFile();
+
+  Dialog.loading.show('Fetching content...');
+  let offset;
+  if (forward) {
+    editorPage.history.push(editorPage.offset);
+    offset = editorPage.offset + editorPage.length;
+  } else {
+    offset = editorPage.history.pop() || 0;
+  }
+  await loadEditorPage(filename, offset);
+  editor.scrollTop = 0;
+  Dialog.loading.hide();
+}
+
 async function saveEditorFile(runFile = false) {
   Dialog.loading.show('Saving...');
   let editor = $(".dialog.editor .file-content");
@@ -371,11 +469,16 @@ async function saveEditorFile(runFile = false) {
   if (isModified(editor)) {
     $(".act-save-edit-file").disabled = true;
     editor.setAttribute("data-hash", calcHash(editor.value));
-    await requestPost("/edit", {
+    let bytes = new TextEncoder().encode(editor.value);
+    let req = await requestRaw("POST", "/editpatch", {
       fs: currentDrive,
       name: filename,
-      content: editor.value
-    });
+      offset: editorPage.offset,
+      remove: editorPage.length
+    }, bytes);
+    editorPage.length = bytes.length;
+    editorPage.size = parseInt(req.getResponseHeader("X-File-Size")) || editorPage.size;
+    updateEditorPager();
   }
 
   if (runFile) {
@@ -839,13 +942,10 @@ $(".container").addEventListener("click", async (e) => {
     $(".dialog.editor .editor-file-name").textContent = file;
     editor.value = "";
 
-    // Load file content
+    // Load the first page of the file
     Dialog.loading.show('Fetching content...');
-    let r = await requestGet(`/file?fs=${currentDrive}&name=${encodeURIComponent(file)}&action=edit`);
-    editor.value = r;
-    editor.setAttribute("data-hash", calcHash(r));
-
-    $(".act-save-edit-file").disabled = true;
+    editorPage.history = [];
+    await loadEditorPage(file, 0);
 
     let serial = getSerialCommand(file);
     if (serial === undefined) {
@@ -906,6 +1006,31 @@ $(".container").addEventListener("click", async (e) => {
     return;
   }
 
+  let actHash = e.target.closest(".act-hash");
+  if (actHash) {
+    e.preventDefault();
+    let file = actHash.closest(".file-row").getAttribute("data-file");
+    if (!file) return;
+
+    Dialog.loading.show('Hashing...');
+    try {
+      let digest = await requestGet("/file", {
+        fs: currentDrive,
+        action: 'hash',
+        algo: 'sha256',
+        name: file
+      });
+      // The answer is committed to 200 before hashing ends, a failure comes as "FAIL hashing: ..."
+      digest = digest.trim();
+      if (!/^[0-9a-f]{64}$/i.test(digest)) throw new Error(digest || "empty answer");
+      prompt(`SHA-256 of ${file}`, digest);
+    } catch (error) {
+      alert("Failed to hash file: " + error.message);
+    }
+    Dialog.loading.hide();
+    return;
+  }
+
   let actPlay = e.target.closest(".act-play");
   if (actPlay) {
     e.preventDefault();
@@ -997,6 +1122,14 @@ $(".act-save-edit-file").addEventListener("click", async (e) => {
   await saveEditorFile();
 });
 
+$(".act-editor-prev").addEventListener("click", async (e) => {
+  await moveEditorPage(false);
+});
+
+$(".act-editor-next").addEventListener("click", async (e) => {
+  await moveEditorPage(true);
+});
+
 const runEditorBtn = $(".act-run-edit-file");
 runEditorBtn.addEventListener("click", async (e) => {
   await saveEditorFile(true);
@@ -44,6 +44,19 @@ enum tftFuncs : uint8_t { // DO NOT CHANGE THE ORDER, ADD NEW FUNCTIONS TO THE E
 struct tftLog {
     uint8_t data[MAX_LOG_SIZE];
 };
+
+#define MAX_PROFILE_SCREENS 16
+// Per screen frame statistics, pixels and SPI bytes are estimated from the primitive geometry
+struct tftFrameStats {
+    const char *name;
+    uint32_t frames;
+    uint32_t lastUs;
+    uint32_t maxUs;
+    uint64_t totalUs;
+    uint32_t primitives; // counters of the last frame
+    uint32_t pixels;
+    uint32_t spiBytes;
+};
 class tft_logger : public BRUCE_TFT_DRIVER {
 private:
     tftLog log[MAX_LOG_ENTRIES];
@@ -53,6 +66,18 @@ private:
     bool _logging = false;
     void clearLog();
 
+    // Frame profiler, disabled by default
+    bool profiling = false;
+    bool profileOverlay = false;
+    uint8_t profileDepth = 0; // nested primitives (ex: fillCircle -> drawFastHLine) are counted once
+    uint8_t frameDepth = 0;
+    const char *frameName = nullptr;
+    uint32_t frameStart = 0;
+    uint32_t framePrimitives = 0;
+    uint32_t framePixels = 0;
+    uint32_t frameSpiBytes = 0;
+    tftFrameStats profileStats[MAX_PROFILE_SCREENS];
+
 public:
     tft_logger(int16_t w = TFT_WIDTH, int16_t h = TFT_HEIGHT);
     virtual ~tft_logger();
@@ -67,6 +92,16 @@ public:
 
     void imageToBin(uint8_t fs, String file, int x, int y, bool center, int Ms);
 
+    void setProfiling(bool enable, bool overlay = false);
+    bool inline getProfiling(void) { return profiling; };
+    void beginFrame(const char *name);
+    void endFrame();
+    void resetProfile();
+    void printProfile(Print &out);
+
+    using BRUCE_TFT_DRIVER::pushImage;
+    void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data);
+
     void drawLine(int32_t x, int32_t y, int32_t x1, int32_t y1, int32_t color);
     void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t color);
     void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t color);
@@ -127,6 +162,10 @@ protected:
     void addLogEntry(const uint8_t *buffer, uint8_t size);
     void logWriteHeader(uint8_t *buffer, uint8_t &pos, tftFuncs fn);
     void writeUint16(uint8_t *buffer, uint8_t &pos, uint16_t value);
+
+    void profileIn(uint32_t pixels, uint32_t windows = 1);
+    void profileOut();
+    void drawProfileOverlay(const tftFrameStats &st);
 };
 
 #endif //__DISPLAY_LOGER
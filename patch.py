@@ -108,7 +108,8 @@ def prepare_www_files():
         files_to_gzip.extend(glob.glob(join(data_src_dir, "*." + extension)))
 
     files_checksum = hash_files(files_to_gzip)
-    if files_checksum == checksum:
+    header_ok = exists(HEADER_FILE) and "WEB_FILES_CHECKSUM" in open(HEADER_FILE).read()
+    if files_checksum == checksum and header_ok:
         print("[GZIP & EMBED INTO HEADER] - Nothing to process.")
         return
 
@@ -123,6 +124,8 @@ def prepare_www_files():
         header.write(
             "// THIS FILE IS AUTOGENERATED DO NOT MODIFY IT. MODIFY FILES IN /embedded_resources/web_interface\n\n"
         )
+        # used by the WebUI as ETag of the embedded files
+        header.write(f'#define WEB_FILES_CHECKSUM "{files_checksum}"\n\n')
 
         for file in files_to_gzip:
             gz_file = file + ".gz"
@@ -0,0 +1,130 @@
+#include "boot_profile.h"
+#include <ArduinoJson.h>
+#include <esp_timer.h>
+
+struct BootPhaseRecord {
+    const char *name;
+    int64_t start; // us since the reset
+    int64_t end;   // 0 while running
+    uint8_t core;
+    bool task; // ran in its own task
+};
+
+struct BootTaskArgs {
+    const char *name;
+    void (*fn)();
+    EventBits_t after;
+    EventBits_t done;
+};
+
+static BootPhaseRecord bootPhases[BOOT_PROFILE_MAX];
+static int bootPhaseCount = 0;
+static int setupPhase = -1; // phase of setup() in progress
+static int64_t bootReadyAt = 0;
+static portMUX_TYPE bootProfileMux = portMUX_INITIALIZER_UNLOCKED;
+static EventGroupHandle_t bootStages = xEventGroupCreate();
+
+static int phaseBegin(const char *name, bool task) {
+    int slot = -1;
+    taskENTER_CRITICAL(&bootProfileMux);
+    if (bootPhaseCount < BOOT_PROFILE_MAX) slot = bootPhaseCount++;
+    taskEXIT_CRITICAL(&bootProfileMux);
+    if (slot >= 0) bootPhases[slot] = {name, esp_timer_get_time(), 0, (uint8_t)xPortGetCoreID(), task};
+    return slot;
+}
+
+static void phaseEnd(int slot) {
+    if (slot >= 0) bootPhases[slot].end = esp_timer_get_time();
+}
+
+void bootMark(const char *name) {
+    phaseEnd(setupPhase);
+    setupPhase = name ? phaseBegin(name, false) : -1;
+}
+
+static void bootTaskLoop(void *arg) {
+    BootTaskArgs *args = (BootTaskArgs *)arg;
+    bootWaitFor(args->after);
+    int slot = phaseBegin(args->name, true);
+    args->fn();
+    phaseEnd(slot);
+    bootStageDone(args->done);
+    delete args;
+    vTaskDelete(NULL);
+}
+
+void bootTask(
+    const char *name, void (*fn)(), EventBits_t after, EventBits_t done, uint32_t stack, bool parallel
+) {
+    BootTaskArgs *args = new BootTaskArgs{name, fn, after, done};
+    // Same priority as setup(), so the scheduler can put it on the other core
+    if (parallel && xTaskCreate(bootTaskLoop, name, stack, args, 1, NULL) == pdPASS) return;
+
+    delete args;
+    bootWaitFor(after);
+    int slot = phaseBegin(name, false);
+    fn();
+    phaseEnd(slot);
+    bootStageDone(done);
+}
+
+void bootWaitFor(EventBits_t stages, const char *name) {
+    if (stages == 0) return;
+    int slot = -1;
+    if (name && (xEventGroupGetBits(bootStages) & stages) != stages) slot = phaseBegin(name, false);
+    xEventGroupWaitBits(bootStages, stages, pdFALSE, pdTRUE, portMAX_DELAY);
+    phaseEnd(slot);
+}
+
+void bootStageDone(EventBits_t stages) {
+    if (stages) xEventGroupSetBits(bootStages, stages);
+}
+
+void bootProfileFinish() {
+    bootMark(NULL);
+    bootReadyAt = esp_timer_get_time();
+    bootStageDone(BOOT_MENU);
+    bootProfilePrint(Serial);
+}
+
+/*********************************************************************
+**  Function: bootProfilePrint
+**  One line per phase, in the order they started
+**********************************************************************/
+void bootProfilePrint(Print &out) {
+    out.println("Boot profile, ms since reset (* = own task):");
+    out.printf("  %-16s %8s %8s %8s %4s\n", "phase", "start", "end", "took", "core");
+    for (int i = 0; i < bootPhaseCount; i++) {
+        BootPhaseRecord &p = bootPhases[i];
+        int64_t end = p.end ? p.end : esp_timer_get_time();
+        out.printf(
+            "  %-15s%c %8.1f %8.1f %8.1f %4u%s\n",
+            p.name,
+            p.task ? '*' : ' ',
+            p.start / 1000.0,
+            end / 1000.0,
+            (end - p.start) / 1000.0,
+            p.core,
+            p.end ? "" : " running"
+        );
+    }
+    if (bootReadyAt) out.printf("Menu ready at %.1fms\n", bootReadyAt / 1000.0);
+    else out.println("Still booting");
+}
+
+String bootProfileJson() {
+    JsonDocument doc;
+    doc["ready"] = bootReadyAt / 1000.0;
+    JsonArray phases = doc["phases"].to<JsonArray>();
+    for (int i = 0; i < bootPhaseCount; i++) {
+        JsonObject phase = phases.add<JsonObject>();
+        phase["name"] = bootPhases[i].name;
+        phase["start"] = bootPhases[i].start / 1000.0;
+        phase["end"] = bootPhases[i].end / 1000.0;
+        phase["core"] = bootPhases[i].core;
+        phase["task"] = bootPhases[i].task;
+    }
+    String json;
+    serializeJson(doc, json);
+    return json;
+}
@@ -0,0 +1,46 @@
+#ifndef __BOOT_PROFILE_H__
+#define __BOOT_PROFILE_H__
+
+#include <Arduino.h>
+#include <freertos/event_groups.h>
+
+// Boot stages other tasks can wait for
+#define BOOT_CLOCK BIT0  // RTC read
+#define BOOT_CONFIG BIT1 // LittleFS and SD mounted, config loaded
+#define BOOT_LED BIT2    // RGB led started
+#define BOOT_THEME BIT3  // theme read and menu icons decoded
+#define BOOT_MENU BIT4   // setup() is over, the screen belongs to the menus
+
+// Phases kept for the report, the ones past this are not recorded
+#ifndef BOOT_PROFILE_MAX
+#define BOOT_PROFILE_MAX 24
+#endif
+
+/*
+ * setup() marks each of its phases with bootMark, and the phases that don't
+ * depend on each other run in their own task with bootTask. Every phase is
+ * timed from the reset, the report is printed once the menu is ready and can
+ * be read again with the "boot" serial command or /bootprofile on the WebUI.
+ */
+
+// Ends the setup() phase in progress and starts "name", NULL only ends it
+void bootMark(const char *name);
+
+// Runs fn in a task once the "after" stages are done, then marks the "done" stages.
+// With parallel false (ex: a shared bus) fn runs right away in the caller instead
+void bootTask(
+    const char *name, void (*fn)(), EventBits_t after, EventBits_t done, uint32_t stack = 4096,
+    bool parallel = true
+);
+
+// Blocks until every stage is done, the wait is recorded as a phase when name is set
+void bootWaitFor(EventBits_t stages, const char *name = NULL);
+void bootStageDone(EventBits_t stages);
+
+// Ends the last phase, marks BOOT_MENU and prints the report on Serial
+void bootProfileFinish();
+
+void bootProfilePrint(Print &out);
+String bootProfileJson();
+
+#endif
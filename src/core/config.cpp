@@ -1,5 +1,20 @@
 #include "config.h"
+#include "config_snapshot.h"
 #include "sd_functions.h"
+#include <esp32/rom/crc.h>
+#include <esp_system.h>
+#include <globals.h>
+
+// Serialized config waiting for the save task, the mutex is held while it is written
+static SemaphoreHandle_t configSaveMutex = xSemaphoreCreateMutex();
+static String pendingConfig = "";
+static std::vector<uint8_t> pendingSnapshot;
+static bool configDirty = false;
+static uint32_t lastConfigChange = 0;
+static uint32_t writtenConfigCrc = 0; // CRC32 of the config file on LittleFS
+static uint32_t writtenSnapshotCrc = 0;
+static TaskHandle_t configSaveTask = NULL;
+static bool shutdownHandlerSet = false;
 
 JsonDocument BruceConfig::toJson() const {
     JsonDocument jsonDoc;
@@ -94,6 +109,7 @@ void BruceConfig::fromFile(bool checkFS) {
         else return;
     }
 
+    recoverTmpFile(*fs, filepath); // a save that removed the config but couldn't rename the new one
     if (!fs->exists(filepath)) {
         log_i("Config file not found. Creating default config");
         return saveFile();
@@ -105,14 +121,25 @@ void BruceConfig::fromFile(bool checkFS) {
         log_i("Config file not found. Using default values");
         return;
     }
+    uint32_t start = millis();
+    String content = file.readString();
+    file.close();
+    uint32_t crc = crc32_le(0, (const uint8_t *)content.c_str(), content.length());
+    // Saving the same content again won't touch the flash
+    if (fs == &LittleFS) writtenConfigCrc = crc;
+
+    if (configSnapshotLoad(*this, crc)) {
+        validateConfig();
+        log_i("Config loaded from snapshot in %lums", millis() - start);
+        return;
+    }
 
     // Deserialize the JSON document
     JsonDocument jsonDoc;
-    if (deserializeJson(jsonDoc, file)) {
+    if (deserializeJson(jsonDoc, content)) {
         Serial.println("Failed to read config file, using default configuration");
         return;
     }
-    file.close();
 
     JsonObject setting = jsonDoc.as<JsonObject>();
     int count = 0;
@@ -425,36 +452,108 @@ void BruceConfig::fromFile(bool checkFS) {
     }
 
     validateConfig();
-    if (count > 0) saveFile();
+    // Also writes the snapshot for the next boot
+    saveFile();
 
-    log_i("Using config from file");
+    log_i("Using config from file, parsed in %lums%s", millis() - start, count > 0 ? ", fixed" : "");
 }
 
-void BruceConfig::saveFile() {
-    FS *fs = &LittleFS;
-    JsonDocument jsonDoc = toJson();
+// The snapshot only lives on LittleFS, it changes alone when the theme file does
+static void writeConfigSnapshot(const std::vector<uint8_t> &snapshot) {
+    if (snapshot.empty()) return;
+    uint32_t crc = crc32_le(0, snapshot.data(), snapshot.size());
+    if (crc == writtenSnapshotCrc) return;
+    if (!writeFileAtomic(LittleFS, CONFIG_SNAPSHOT_PATH, snapshot.data(), snapshot.size())) {
+        log_e("Failed to write config snapshot");
+        return;
+    }
+    writtenSnapshotCrc = crc;
+}
 
-    // Open file for writing
-    File file = fs->open(filepath, FILE_WRITE);
-    if (!file) {
-        log_e("Failed to open config file");
-        file.close();
+// Writes to LittleFS, and to SD when it is mounted, only if the content changed
+static void writeConfigFile(const char *filepath, const String &content) {
+    uint32_t crc = crc32_le(0, (const uint8_t *)content.c_str(), content.length());
+    if (crc == writtenConfigCrc) {
+        log_i("config file unchanged");
+        return;
+    }
+    uint32_t start = millis();
+    if (!writeFileAtomic(LittleFS, filepath, content)) {
+        log_e("Failed to write config file");
         return;
-    };
+    }
+    writtenConfigCrc = crc;
+    if (sdcardMounted && !writeFileAtomic(SD, filepath, content)) log_e("Failed to copy config file to SD");
+    log_i("config file written in %lums, %u bytes", millis() - start, content.length());
+}
+
+static void configSaveTaskLoop(void *arg) {
+    BruceConfig *config = (BruceConfig *)arg;
+    while (true) {
+        vTaskDelay(pdMS_TO_TICKS(100));
+        xSemaphoreTake(configSaveMutex, portMAX_DELAY);
+        bool quiet = millis() - lastConfigChange >= CONFIG_SAVE_DELAY_MS;
+        if (quiet && !configDirty) {
+            configSaveTask = NULL;
+            xSemaphoreGive(configSaveMutex);
+            break;
+        }
+        xSemaphoreGive(configSaveMutex);
+        if (quiet) config->flush();
+    }
+    vTaskDelete(NULL);
+}
 
-    // Serialize JSON to file
-    serializeJsonPretty(jsonDoc, Serial);
-    if (serializeJsonPretty(jsonDoc, file) < 5) log_e("Failed to write config file");
-    else log_i("config file written successfully");
+// Runs on ESP.restart(), so a change made just before rebooting is kept
+static void configShutdownHandler() { bruceConfig.flush(); }
 
-    file.close();
+/*
+ * The setters call this on every change, ex: for each step of a slider. The
+ * config is serialized now, the file is written by a task once no change came
+ * for CONFIG_SAVE_DELAY_MS.
+ */
+void BruceConfig::saveFile() {
+    String content;
+    serializeJson(toJson(), content);
+    std::vector<uint8_t> snapshot =
+        configSnapshotEncode(*this, crc32_le(0, (const uint8_t *)content.c_str(), content.length()));
 
-    if (setupSdCard()) copyToFs(LittleFS, SD, filepath, false);
+    xSemaphoreTake(configSaveMutex, portMAX_DELAY);
+    pendingConfig = content;
+    pendingSnapshot.swap(snapshot);
+    configDirty = true;
+    lastConfigChange = millis();
+    if (!shutdownHandlerSet) {
+        shutdownHandlerSet = esp_register_shutdown_handler(configShutdownHandler) == ESP_OK;
+    }
+    if (configSaveTask == NULL) xTaskCreate(configSaveTaskLoop, "ConfigSave", 6144, this, 1, &configSaveTask);
+    bool scheduled = configSaveTask != NULL;
+    xSemaphoreGive(configSaveMutex);
+
+    if (!scheduled) flush();
+}
+
+void BruceConfig::flush() {
+    xSemaphoreTake(configSaveMutex, portMAX_DELAY);
+    if (configDirty) {
+        configDirty = false;
+        writeConfigFile(filepath, pendingConfig);
+        writeConfigSnapshot(pendingSnapshot);
+        pendingConfig = "";
+        pendingSnapshot.clear();
+    }
+    xSemaphoreGive(configSaveMutex);
 }
 
 void BruceConfig::factoryReset() {
+    // Nothing may write the config back once it is moved away
+    xSemaphoreTake(configSaveMutex, portMAX_DELAY);
+    configDirty = false;
+    xSemaphoreGive(configSaveMutex);
+
     FS *fs = &LittleFS;
     fs->rename(String(filepath), "/bak." + String(filepath).substring(1));
+    fs->remove(CONFIG_SNAPSHOT_PATH);
     if (setupSdCard()) SD.rename(String(filepath), "/bak." + String(filepath).substring(1));
     ESP.restart();
 }
@@ -8,6 +8,11 @@
 #include <set>
 #include <vector>
 
+// Quiet time after the last change before the config file is written
+#ifndef CONFIG_SAVE_DELAY_MS
+#define CONFIG_SAVE_DELAY_MS 2000
+#endif
+
 enum RFIDModules {
     M5_RFID2_MODULE = 0,
     PN532_I2C_MODULE = 1,
@@ -119,7 +124,10 @@ public:
     /////////////////////////////////////////////////////////////////////////////////////
     // Operations
     /////////////////////////////////////////////////////////////////////////////////////
+    // Schedules a write of the config, changes made within CONFIG_SAVE_DELAY_MS are written together
     void saveFile();
+    // Writes a scheduled change now, ex: before sleeping or powering off
+    void flush();
     void fromFile(bool checkFS = true);
     void factoryReset();
     void validateConfig();
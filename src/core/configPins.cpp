@@ -108,6 +108,7 @@ void BruceConfigPins::loadFile(JsonDocument &jsonDoc, bool checkFS) {
         else return;
     }
 
+    recoverTmpFile(*fs, filepath);
     if (!fs->exists(filepath)) return createFile();
 
     File file;
@@ -133,27 +134,23 @@ void BruceConfigPins::fromFile(bool checkFS) {
     if (!jsonDoc.isNull()) fromJson(jsonDoc.as<JsonObject>());
 }
 
-void BruceConfigPins::createFile() {
-    JsonDocument jsonDoc;
-    toJson(jsonDoc.to<JsonObject>());
-    serializeJsonPretty(jsonDoc, Serial);
-
-    // Open file for writing
-    FS *fs = &LittleFS;
-    File file = fs->open(filepath, FILE_WRITE);
-    if (!file) {
-        log_e("Failed to open config file");
-        file.close();
+void BruceConfigPins::writeFile(const String &content) {
+    if (!writeFileAtomic(LittleFS, filepath, content)) {
+        log_e("Failed to write config file");
         return;
-    };
+    }
+    log_i("config file written successfully");
 
-    // Serialize JSON to file
-    if (serializeJsonPretty(jsonDoc, file) < 5) log_e("Failed to write config file");
-    else log_i("config file written successfully");
+    if (setupSdCard() && !writeFileAtomic(SD, filepath, content)) log_e("Failed to copy config file to SD");
+}
 
-    file.close();
+void BruceConfigPins::createFile() {
+    JsonDocument jsonDoc;
+    toJson(jsonDoc.to<JsonObject>());
 
-    if (setupSdCard()) copyToFs(LittleFS, SD, filepath, false);
+    String content;
+    serializeJson(jsonDoc, content);
+    writeFile(content);
 }
 
 void BruceConfigPins::saveFile() {
@@ -162,24 +159,19 @@ void BruceConfigPins::saveFile() {
 
     if (jsonDoc.isNull()) return createFile();
 
+    // The file holds the pins of every device it was used on, only this one changes
+    String previous;
+    serializeJson(jsonDoc, previous);
     jsonDoc.remove(getMacAddress());
     toJson(jsonDoc.as<JsonObject>());
 
-    // Open file for writing
-    FS *fs = &LittleFS;
-    File file = fs->open(filepath, FILE_WRITE);
-    if (!file) {
-        log_e("Failed to open config file");
+    String content;
+    serializeJson(jsonDoc, content);
+    if (content == previous) {
+        log_i("config file unchanged");
         return;
-    };
-
-    // Serialize JSON to file
-    if (serializeJsonPretty(jsonDoc, file) < 5) log_e("Failed to write config file");
-    else log_i("config file written successfully");
-
-    file.close();
-
-    if (setupSdCard()) copyToFs(LittleFS, SD, filepath, false);
+    }
+    writeFile(content);
 }
 
 void BruceConfigPins::factoryReset() {
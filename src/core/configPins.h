@@ -146,6 +146,7 @@ public:
     // Operations
     /////////////////////////////////////////////////////////////////////////////////////
     void createFile();
+    void writeFile(const String &content);
     void saveFile();
     void fromFile(bool checkFS = true);
     void loadFile(JsonDocument &jsonDoc, bool checkFS = true);
@@ -0,0 +1,261 @@
+#include "config_snapshot.h"
+#include <esp32/rom/crc.h>
+#include <globals.h>
+
+#define CONFIG_SNAPSHOT_MAGIC 0x31534342 // "BCS1"
+// A config is a few KB, anything bigger is a broken file
+#define CONFIG_SNAPSHOT_MAX (32 * 1024)
+
+struct ConfigSnapshotHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t configCrc; // CRC32 of the JSON file the snapshot was made from
+    uint32_t payloadLen;
+    uint32_t payloadCrc;
+};
+
+class SnapshotWriter {
+public:
+    std::vector<uint8_t> buf;
+
+    void raw(const void *data, size_t len) {
+        const uint8_t *bytes = (const uint8_t *)data;
+        buf.insert(buf.end(), bytes, bytes + len);
+    }
+    template <typename T> void num(T &value) { raw(&value, sizeof(T)); }
+    void str(String &value) {
+        uint16_t len = value.length();
+        num(len);
+        raw(value.c_str(), len);
+    }
+    void strings(std::set<String> &values) {
+        uint16_t count = values.size();
+        num(count);
+        for (String value : values) str(value);
+    }
+    void strings(std::vector<String> &values) {
+        uint16_t count = values.size();
+        num(count);
+        for (String &value : values) str(value);
+    }
+    void strings(std::map<String, String> &values) {
+        uint16_t count = values.size();
+        num(count);
+        for (auto &pair : values) {
+            String key = pair.first;
+            str(key);
+            str(pair.second);
+        }
+    }
+    void qrCodes(std::vector<BruceConfig::QrCodeEntry> &values) {
+        uint16_t count = values.size();
+        num(count);
+        for (auto &entry : values) {
+            str(entry.menuName);
+            str(entry.content);
+        }
+    }
+};
+
+// Reads stop at the end of the payload and mark the snapshot as broken
+class SnapshotReader {
+public:
+    const uint8_t *pos;
+    const uint8_t *end;
+    bool ok = true;
+
+    SnapshotReader(const uint8_t *data, size_t len) : pos(data), end(data + len) {}
+
+    void raw(void *data, size_t len) {
+        if (!ok || (size_t)(end - pos) < len) {
+            ok = false;
+            memset(data, 0, len);
+            return;
+        }
+        memcpy(data, pos, len);
+        pos += len;
+    }
+    template <typename T> void num(T &value) { raw(&value, sizeof(T)); }
+    void str(String &value) {
+        uint16_t len = 0;
+        num(len);
+        if (!ok || (size_t)(end - pos) < len) {
+            ok = false;
+            return;
+        }
+        value = String((const char *)pos, len);
+        pos += len;
+    }
+    void strings(std::set<String> &values) {
+        uint16_t count = 0;
+        num(count);
+        values.clear();
+        for (uint16_t i = 0; ok && i < count; i++) {
+            String value;
+            str(value);
+            values.insert(value);
+        }
+    }
+    void strings(std::vector<String> &values) {
+        uint16_t count = 0;
+        num(count);
+        values.clear();
+        for (uint16_t i = 0; ok && i < count; i++) {
+            String value;
+            str(value);
+            values.push_back(value);
+        }
+    }
+    void strings(std::map<String, String> &values) {
+        uint16_t count = 0;
+        num(count);
+        values.clear();
+        for (uint16_t i = 0; ok && i < count; i++) {
+            String key, value;
+            str(key);
+            str(value);
+            values[key] = value;
+        }
+    }
+    void qrCodes(std::vector<BruceConfig::QrCodeEntry> &values) {
+        uint16_t count = 0;
+        num(count);
+        values.clear();
+        for (uint16_t i = 0; ok && i < count; i++) {
+            BruceConfig::QrCodeEntry entry;
+            str(entry.menuName);
+            str(entry.content);
+            values.push_back(entry);
+        }
+    }
+};
+
+// The one list of fields, used both to write and to read the snapshot
+template <typename IO> static void snapshotFields(IO &io, BruceConfig &c) {
+    io.num(c.priColor);
+    io.num(c.secColor);
+    io.num(c.bgColor);
+    io.str(c.themePath);
+    io.num(c.themeFileCrc);
+
+    themeInfo &t = c.theme;
+    io.num(t.fs);
+    bool *flags[] = {&t.border, &t.label, &t.wifi, &t.ble, &t.ethernet, &t.rf, &t.rfid,
+                     &t.fm, &t.ir, &t.files, &t.gps, &t.nrf, &t.interpreter, &t.others,
+                     &t.clock, &t.connect, &t.config, &t.boot_img, &t.boot_sound};
+    for (bool *flag : flags) io.num(*flag);
+    themeFiles &p = t.paths;
+    String *paths[] = {&p.wifi, &p.ble, &p.ethernet, &p.rf, &p.rfid, &p.fm, &p.ir, &p.files, &p.gps,
+                       &p.nrf, &p.interpreter, &p.others, &p.clock, &p.connect, &p.config, &p.boot_img,
+                       &p.boot_sound};
+    for (String *path : paths) io.str(*path);
+
+    io.num(c.rotation);
+    io.num(c.dimmerSet);
+    io.num(c.bright);
+    io.num(c.tmz);
+    io.num(c.soundEnabled);
+    io.num(c.soundVolume);
+    io.num(c.wifiAtStartup);
+    io.num(c.instantBoot);
+
+    io.num(c.ledBright);
+    io.num(c.ledColor);
+    io.num(c.ledBlinkEnabled);
+    io.num(c.ledEffect);
+    io.num(c.ledEffectSpeed);
+    io.num(c.ledEffectDirection);
+
+    io.str(c.webUI.user);
+    io.str(c.webUI.pwd);
+    io.str(c.wifiAp.ssid);
+    io.str(c.wifiAp.pwd);
+    io.strings(c.wifi);
+    io.strings(c.evilWifiNames);
+    io.str(c.wifiMAC);
+
+    io.str(c.bleName);
+
+    io.num(c.irTx);
+    io.num(c.irTxRepeats);
+    io.num(c.irRx);
+
+    io.num(c.rfTx);
+    io.num(c.rfRx);
+    io.num(c.rfModule);
+    io.num(c.rfFreq);
+    io.num(c.rfFxdFreq);
+    io.num(c.rfScanRange);
+
+    io.num(c.iButton);
+
+    io.num(c.rfidModule);
+    io.strings(c.mifareKeys);
+
+    io.num(c.gpsBaudrate);
+
+    io.str(c.startupApp);
+    io.str(c.wigleBasicToken);
+    io.num(c.devMode);
+    io.num(c.colorInverted);
+    io.strings(c.disabledMenus);
+    io.qrCodes(c.qrCodes);
+}
+
+/***************************************************************************************
+** Function name: configSnapshotEncode
+** Description:   header and fields of the config, ready to be written
+***************************************************************************************/
+std::vector<uint8_t> configSnapshotEncode(BruceConfig &config, uint32_t configCrc) {
+    SnapshotWriter writer;
+    ConfigSnapshotHeader header = {};
+    writer.num(header); // filled in once the payload size is known
+    snapshotFields(writer, config);
+
+    header.magic = CONFIG_SNAPSHOT_MAGIC;
+    header.version = CONFIG_SNAPSHOT_VERSION;
+    header.headerSize = sizeof(header);
+    header.configCrc = configCrc;
+    header.payloadLen = writer.buf.size() - sizeof(header);
+    header.payloadCrc = crc32_le(0, writer.buf.data() + sizeof(header), header.payloadLen);
+    memcpy(writer.buf.data(), &header, sizeof(header));
+    return writer.buf;
+}
+
+/***************************************************************************************
+** Function name: configSnapshotLoad
+** Description:   restore the config from the snapshot when it matches the JSON file
+***************************************************************************************/
+bool configSnapshotLoad(BruceConfig &config, uint32_t configCrc) {
+    File file = LittleFS.open(CONFIG_SNAPSHOT_PATH, FILE_READ);
+    if (!file) return false;
+
+    ConfigSnapshotHeader header;
+    bool ok = file.read((uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+              header.magic == CONFIG_SNAPSHOT_MAGIC && header.version == CONFIG_SNAPSHOT_VERSION &&
+              header.headerSize == sizeof(header) && header.configCrc == configCrc &&
+              header.payloadLen <= CONFIG_SNAPSHOT_MAX;
+    uint8_t *payload = ok ? (uint8_t *)malloc(header.payloadLen) : NULL;
+    if (payload) {
+        ok = file.read(payload, header.payloadLen) == header.payloadLen &&
+             crc32_le(0, payload, header.payloadLen) == header.payloadCrc;
+    } else {
+        ok = false;
+    }
+    file.close();
+
+    if (ok) {
+        SnapshotReader reader(payload, header.payloadLen);
+        snapshotFields(reader, config);
+        ok = reader.ok && reader.pos == reader.end;
+        if (!ok) {
+            // The JSON fills the config back in, but not the theme state
+            config.theme = themeInfo();
+            config.themeFileCrc = 0;
+        }
+    }
+    free(payload);
+    if (!ok) log_i("Config snapshot missing or outdated");
+    return ok;
+}
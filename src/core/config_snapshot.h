@@ -0,0 +1,23 @@
+#ifndef __CONFIG_SNAPSHOT_H__
+#define __CONFIG_SNAPSHOT_H__
+
+#include "config.h"
+#include <vector>
+
+// Binary copy of the config kept on LittleFS next to the JSON file
+#define CONFIG_SNAPSHOT_PATH "/bruce.snap"
+// Bump when a field is added, removed or changes type, older snapshots are then ignored
+#define CONFIG_SNAPSHOT_VERSION 1
+
+/*
+ * The snapshot holds every config field, plus the theme state worked out by
+ * openThemeFile, in a fixed order with no keys. It is tied to the CRC32 of
+ * the JSON it was made from, so a config edited outside of Bruce (web UI,
+ * computer) is noticed and the JSON is parsed again.
+ */
+std::vector<uint8_t> configSnapshotEncode(BruceConfig &config, uint32_t configCrc);
+
+// Fills config from the snapshot if it matches configCrc, false when the JSON must be parsed instead
+bool configSnapshotLoad(BruceConfig &config, uint32_t configCrc);
+
+#endif
@@ -0,0 +1,229 @@
+#include "copy_engine.h"
+#include <globals.h>
+#include <vector>
+
+// Stack of the reader task, FATFS and LittleFS reads go a few calls deep
+#define COPY_READER_STACK 6144
+
+struct CopyChunk {
+    uint8_t *buf;
+    size_t len; // 0 marks the end of the file, or an aborted copy
+};
+
+struct CopyJob {
+    File *src;
+    size_t bufSize;
+    QueueHandle_t freeQ; // buffers the reader can fill
+    QueueHandle_t fullQ; // buffers ready to be written
+    volatile bool abort;
+};
+
+struct CopyContext {
+    uint8_t *buf[2];
+    size_t bufSize;
+    uint64_t done;
+    uint64_t total;
+    uint32_t files;
+    uint32_t lastProgress;
+    CopyProgressCb progress;
+};
+
+static String joinPath(const String &folder, const String &name) {
+    return folder.endsWith("/") ? folder + name : folder + "/" + name;
+}
+
+std::vector<String> listFolder(File &dir) {
+    std::vector<String> names;
+    File entry = dir.openNextFile();
+    while (entry) {
+        String name = entry.name();
+        names.push_back(name.substring(name.lastIndexOf('/') + 1));
+        entry.close();
+        entry = dir.openNextFile();
+    }
+    return names;
+}
+
+static void reportProgress(CopyContext &c, bool force) {
+    if (c.progress == NULL) return;
+    uint32_t now = millis();
+    if (!force && now - c.lastProgress < COPY_PROGRESS_MS) return;
+    c.lastProgress = now;
+    c.progress(c.done, c.total);
+}
+
+static void copyReaderTask(void *arg) {
+    CopyJob *job = (CopyJob *)arg;
+    CopyChunk chunk;
+    do {
+        xQueueReceive(job->freeQ, &chunk, portMAX_DELAY);
+        chunk.len = job->abort ? 0 : job->src->read(chunk.buf, job->bufSize);
+        // job belongs to the writer, it may be gone once the last chunk is sent
+        xQueueSend(job->fullQ, &chunk, portMAX_DELAY);
+    } while (chunk.len > 0);
+    vTaskDelete(NULL);
+}
+
+// Copy with a single buffer, used for small files or when the reader task can't start
+static size_t copySerial(File &src, File &dst, CopyContext &c) {
+    size_t copied = 0;
+    size_t n;
+    while ((n = src.read(c.buf[0], c.bufSize)) > 0) {
+        if (dst.write(c.buf[0], n) != n) break;
+        copied += n;
+        c.done += n;
+        reportProgress(c, false);
+    }
+    return copied;
+}
+
+static size_t copyPipelined(File &src, File &dst, CopyContext &c) {
+    CopyJob job = {&src, c.bufSize, NULL, NULL, false};
+    job.freeQ = xQueueCreate(2, sizeof(CopyChunk));
+    job.fullQ = xQueueCreate(2, sizeof(CopyChunk));
+    TaskHandle_t reader = NULL;
+    if (job.freeQ && job.fullQ) {
+        for (int i = 0; i < 2; i++) {
+            CopyChunk chunk = {c.buf[i], 0};
+            xQueueSend(job.freeQ, &chunk, 0);
+        }
+        xTaskCreate(
+            copyReaderTask, "CopyReader", COPY_READER_STACK, &job, uxTaskPriorityGet(NULL), &reader
+        );
+    }
+    if (reader == NULL) {
+        if (job.freeQ) vQueueDelete(job.freeQ);
+        if (job.fullQ) vQueueDelete(job.fullQ);
+        return copySerial(src, dst, c);
+    }
+
+    // After a failed write keep handing buffers back until the reader sees the abort
+    size_t copied = 0;
+    CopyChunk chunk;
+    while (xQueueReceive(job.fullQ, &chunk, portMAX_DELAY) == pdTRUE && chunk.len > 0) {
+        if (!job.abort && dst.write(chunk.buf, chunk.len) == chunk.len) {
+            copied += chunk.len;
+            c.done += chunk.len;
+            reportProgress(c, false);
+        } else {
+            job.abort = true;
+        }
+        xQueueSend(job.freeQ, &chunk, portMAX_DELAY);
+    }
+    vQueueDelete(job.freeQ);
+    vQueueDelete(job.fullQ);
+    return copied;
+}
+
+static bool copyTree(FS &from, const String &src, FS &to, const String &dst, CopyContext &c) {
+    File source = from.open(src, FILE_READ);
+    if (!source) {
+        Serial.printf("Could not open %s\n", src.c_str());
+        return false;
+    }
+
+    if (!source.isDirectory()) {
+        File dest = to.open(dst, FILE_WRITE);
+        if (!dest) {
+            Serial.printf("Could not create %s\n", dst.c_str());
+            source.close();
+            return false;
+        }
+        size_t size = source.size();
+        // Not worth a task for files that fit in one buffer
+        size_t copied =
+            size > c.bufSize && c.buf[1] ? copyPipelined(source, dest, c) : copySerial(source, dest, c);
+        source.close();
+        dest.close();
+        if (copied != size) {
+            Serial.printf("Failed copying %s (%u of %u bytes)\n", src.c_str(), copied, size);
+            to.remove(dst);
+            return false;
+        }
+        c.files++;
+        return true;
+    }
+
+    std::vector<String> names = listFolder(source);
+    source.close();
+    if (!to.exists(dst) && !to.mkdir(dst)) {
+        Serial.printf("Could not create %s\n", dst.c_str());
+        return false;
+    }
+    for (auto &name : names) {
+        if (!copyTree(from, joinPath(src, name), to, joinPath(dst, name), c)) return false;
+    }
+    return true;
+}
+
+/***************************************************************************************
+** Function name: pathSize
+** Description:   size of a file, or of everything inside a folder
+***************************************************************************************/
+uint64_t pathSize(FS &fs, const String &path, uint32_t *files) {
+    File file = fs.open(path, FILE_READ);
+    if (!file) return 0;
+    if (!file.isDirectory()) {
+        uint64_t size = file.size();
+        file.close();
+        if (files) (*files)++;
+        return size;
+    }
+    std::vector<String> names = listFolder(file);
+    file.close();
+    uint64_t size = 0;
+    for (auto &name : names) size += pathSize(fs, joinPath(path, name), files);
+    return size;
+}
+
+/***************************************************************************************
+** Function name: copyPath
+** Description:   copy a file or folder, overlapping reads and writes
+***************************************************************************************/
+bool copyPath(
+    FS &from, const String &src, FS &to, const String &dst, CopyProgressCb progress, CopyStats *stats
+) {
+    CopyContext c = {};
+    c.progress = progress;
+    c.total = pathSize(from, src);
+
+    // Two buffers for the pipeline, smaller ones if memory is tight, a single one at worst
+    for (c.bufSize = COPY_ENGINE_CHUNK; c.bufSize >= 1024; c.bufSize /= 4) {
+        c.buf[0] = (uint8_t *)heap_caps_malloc(c.bufSize, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        c.buf[1] = (uint8_t *)heap_caps_malloc(c.bufSize, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (c.buf[0] && c.buf[1]) break;
+        free(c.buf[0]);
+        free(c.buf[1]);
+        c.buf[0] = c.buf[1] = NULL;
+    }
+    if (c.buf[0] == NULL) {
+        c.bufSize = 1024;
+        c.buf[0] = (uint8_t *)malloc(c.bufSize);
+    }
+    if (c.buf[0] == NULL) {
+        Serial.println("Not enough memory to copy");
+        return false;
+    }
+
+    uint32_t start = millis();
+    reportProgress(c, true);
+    bool result = copyTree(from, src, to, dst, c);
+    reportProgress(c, true);
+
+    free(c.buf[0]);
+    free(c.buf[1]);
+
+    CopyStats summary;
+    summary.bytes = c.done;
+    summary.files = c.files;
+    summary.elapsedMs = millis() - start;
+    Serial.printf(
+        "Copied %lu file(s), %llu bytes in %lu ms (%.2f MB/s)\n",
+        summary.files,
+        summary.bytes,
+        summary.elapsedMs,
+        summary.mbPerSec()
+    );
+    if (stats) *stats = summary;
+    return result;
+}
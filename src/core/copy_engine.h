@@ -0,0 +1,46 @@
+#ifndef __COPY_ENGINE_H__
+#define __COPY_ENGINE_H__
+
+#include <FS.h>
+#include <vector>
+
+// Size of each of the two copy buffers
+#ifndef COPY_ENGINE_CHUNK
+#define COPY_ENGINE_CHUNK 16384
+#endif
+
+// Minimum time between two progress callbacks
+#ifndef COPY_PROGRESS_MS
+#define COPY_PROGRESS_MS 250
+#endif
+
+struct CopyStats {
+    uint64_t bytes = 0;
+    uint32_t files = 0;
+    uint32_t elapsedMs = 0;
+
+    float mbPerSec() const { return elapsedMs ? bytes / (elapsedMs * 1000.0f) : 0; }
+};
+
+typedef void (*CopyProgressCb)(uint64_t done, uint64_t total);
+
+/*
+ * Copies a file, or a folder and everything below it, from src on one FS
+ * to dst on another (or the same) FS. Files larger than a buffer are read
+ * by a separate task into one buffer while this task writes the other, so
+ * reading the source and writing the destination overlap.
+ * progress is called on the calling task at most every COPY_PROGRESS_MS,
+ * and once at the start and at the end. A file that fails is removed.
+ */
+bool copyPath(
+    FS &from, const String &src, FS &to, const String &dst, CopyProgressCb progress = NULL,
+    CopyStats *stats = NULL
+);
+
+// Size of a file, or the total size of the files in a folder
+uint64_t pathSize(FS &fs, const String &path, uint32_t *files = NULL);
+
+// Names in a folder, read before recursing so only one directory is open at a time
+std::vector<String> listFolder(File &dir);
+
+#endif
@@ -0,0 +1,286 @@
+#include "dir_cursor.h"
+#include <algorithm>
+#include <globals.h>
+
+static String baseName(const String &path) { return path.substring(path.lastIndexOf('/') + 1); }
+
+bool DirCursor::accept(const String &name, bool isDir) {
+    if (isDir || _allowedExt == "*") return true;
+    return checkExt(name.substring(name.lastIndexOf('.') + 1), _allowedExt);
+}
+
+void DirCursor::close() {
+    free(_keys);
+    _keys = NULL;
+    _count = 0;
+    _pageStart = 0;
+    _page.clear();
+    _page.shrink_to_fit();
+}
+
+/*********************************************************************
+**  Function: open
+**  Read the listing once, keeping only the sort keys
+**********************************************************************/
+bool DirCursor::open(FS &fs, const String &folder, const String &allowedExt) {
+    close();
+    File root = fs.open(folder);
+    if (!root || !root.isDirectory()) return false;
+    _fs = &fs;
+    _folder = folder;
+    _allowedExt = allowedExt;
+
+    size_t limit = psramFound() ? SIZE_MAX : DIR_CURSOR_HEAP_ENTRIES;
+    size_t capacity = 0;
+    bool sorted = true;
+    uint32_t ordinal = 0;
+    bool isDir;
+    // getNextFileName doesn't open each entry like openNextFile does
+    String path = root.getNextFileName(&isDir);
+    while (path.length() > 0) {
+        String name = baseName(path);
+        if (accept(name, isDir)) {
+            if (sorted && (size_t)_count == capacity) {
+                size_t grow = min<size_t>(capacity ? capacity * 2 : 64, limit);
+                Key *keys = NULL;
+                if (grow > capacity) {
+                    keys = (Key *)(psramFound() ? ps_realloc(_keys, grow * sizeof(Key))
+                                                : realloc(_keys, grow * sizeof(Key)));
+                }
+                if (keys == NULL) {
+                    free(_keys);
+                    _keys = NULL;
+                    sorted = false;
+                } else {
+                    _keys = keys;
+                    capacity = grow;
+                }
+            }
+            if (sorted) {
+                Key &key = _keys[_count];
+                memset(key.name, 0, sizeof(key.name));
+                for (size_t i = 0; i < sizeof(key.name) && i < name.length(); i++) {
+                    key.name[i] = toupper(name[i]);
+                }
+                key.folder = isDir;
+                key.ordinal = ordinal;
+            }
+            _count++;
+        }
+        ordinal++;
+        path = root.getNextFileName(&isDir);
+    }
+    root.close();
+
+    if (_keys) {
+        std::sort(_keys, _keys + _count, [](const Key &a, const Key &b) {
+            if (a.folder != b.folder) return a.folder > b.folder;
+            int cmp = memcmp(a.name, b.name, sizeof(a.name));
+            if (cmp != 0) return cmp < 0;
+            return a.ordinal < b.ordinal;
+        });
+        breakTies();
+    }
+    Serial.printf("Files listed with: %d files/folders found%s\n", _count, _keys ? "" : " (unsorted)");
+    return true;
+}
+
+/*********************************************************************
+**  Function: breakTies
+**  Order the entries sharing their whole key by the rest of the name
+**********************************************************************/
+void DirCursor::breakTies() {
+    // A tied entry, with the next DIR_CURSOR_KEY folded characters of its name
+    struct Tie {
+        Key key;
+        int run; // index in _keys of the first entry of its run
+        char next[DIR_CURSOR_KEY];
+    };
+
+    // Runs of tied entries as (first index, length). A key not filled up is the
+    // whole name, so those entries only differ in case and keep directory order.
+    auto sameKey = [](const Key &a, const Key &b) {
+        return a.folder == b.folder && memcmp(a.name, b.name, sizeof(a.name)) == 0;
+    };
+    std::vector<std::pair<int, int>> runs;
+    for (int i = 0, j; i < _count; i = j) {
+        j = i + 1;
+        while (j < _count && sameKey(_keys[i], _keys[j])) j++;
+        if (j - i > 1 && _keys[i].name[DIR_CURSOR_KEY - 1] != 0) runs.push_back({i, j - i});
+    }
+
+    for (size_t offset = DIR_CURSOR_KEY; !runs.empty(); offset += DIR_CURSOR_KEY) {
+        size_t tied = 0;
+        for (auto &run : runs) tied += run.second;
+        Tie *ties = (Tie *)(psramFound() ? ps_malloc(tied * sizeof(Tie)) : malloc(tied * sizeof(Tie)));
+        File root = ties ? _fs->open(_folder) : File();
+        if (!root) {
+            // These runs stay in directory order
+            free(ties);
+            return;
+        }
+        size_t t = 0;
+        for (auto &run : runs) {
+            for (int i = run.first; i < run.first + run.second; i++, t++) {
+                ties[t].key = _keys[i];
+                ties[t].run = run.first;
+                memset(ties[t].next, 0, sizeof(ties[t].next));
+            }
+        }
+
+        // One pass over the listing reads the next part of every tied name
+        std::sort(ties, ties + tied, [](const Tie &a, const Tie &b) {
+            return a.key.ordinal < b.key.ordinal;
+        });
+        bool isDir;
+        String path = root.getNextFileName(&isDir);
+        uint32_t ordinal = 0;
+        for (t = 0; path.length() > 0 && t < tied; ordinal++) {
+            if (ordinal == ties[t].key.ordinal) {
+                String name = baseName(path);
+                for (size_t i = 0; i < sizeof(ties[t].next) && offset + i < name.length(); i++) {
+                    ties[t].next[i] = toupper(name[offset + i]);
+                }
+                t++;
+            }
+            path = root.getNextFileName(&isDir);
+        }
+        root.close();
+
+        std::sort(ties, ties + tied, [](const Tie &a, const Tie &b) {
+            if (a.run != b.run) return a.run < b.run;
+            int cmp = memcmp(a.next, b.next, sizeof(a.next));
+            if (cmp != 0) return cmp < 0;
+            return a.key.ordinal < b.key.ordinal;
+        });
+
+        // Runs are disjoint and in _keys order, so the ties go back in sequence
+        std::vector<std::pair<int, int>> longer;
+        t = 0;
+        for (auto &run : runs) {
+            for (int i = run.first, j; i < run.first + run.second; i = j) {
+                const char *next = ties[t].next;
+                int end = run.first + run.second;
+                j = i + 1;
+                while (j < end && memcmp(next, ties[t + j - i].next, DIR_CURSOR_KEY) == 0) j++;
+                if (j - i > 1 && next[DIR_CURSOR_KEY - 1] != 0) longer.push_back({i, j - i});
+                for (int k = i; k < j; k++) _keys[k] = ties[t++].key;
+            }
+        }
+        free(ties);
+        runs.swap(longer);
+    }
+}
+
+/*********************************************************************
+**  Function: loadPage
+**  Read the names of DIR_CURSOR_PAGE entries starting at "first"
+**********************************************************************/
+void DirCursor::loadPage(int first) {
+    _page.clear();
+    _pageStart = first;
+    int last = min(first + DIR_CURSOR_PAGE, _count);
+    if (first >= last) return;
+    File root = _fs->open(_folder);
+    if (!root) return;
+    _page.resize(last - first, _blank);
+
+    bool isDir;
+    String path = root.getNextFileName(&isDir);
+    if (_keys) {
+        // Listing positions wanted by the page, in the order they will be read
+        std::vector<std::pair<uint32_t, int>> wanted;
+        wanted.reserve(last - first);
+        for (int i = first; i < last; i++) wanted.push_back({_keys[i].ordinal, i - first});
+        std::sort(wanted.begin(), wanted.end());
+
+        uint32_t ordinal = 0;
+        for (size_t w = 0; path.length() > 0 && w < wanted.size(); ordinal++) {
+            if (ordinal == wanted[w].first) _page[wanted[w++].second] = {baseName(path), isDir, false};
+            path = root.getNextFileName(&isDir);
+        }
+    } else {
+        for (int index = 0; path.length() > 0 && index < last;) {
+            String name = baseName(path);
+            if (accept(name, isDir)) {
+                if (index >= first) _page[index - first] = {name, isDir, false};
+                index++;
+            }
+            path = root.getNextFileName(&isDir);
+        }
+    }
+    root.close();
+}
+
+const FileList &DirCursor::at(int index) {
+    if (index == _count) return _back;
+    if (index < 0 || index > _count) return _blank;
+    if (index < _pageStart || index >= _pageStart + (int)_page.size()) {
+        // Centered, so scrolling either way doesn't reload right away
+        loadPage(max(0, index - DIR_CURSOR_PAGE / 2));
+    }
+    if (index - _pageStart >= (int)_page.size()) return _blank;
+    return _page[index - _pageStart];
+}
+
+int DirCursor::findLetter(char letter, int from) {
+    letter = toupper(letter);
+    from = max(from, 0);
+    if (_keys) {
+        for (int i = from; i < _count; i++) {
+            if (_keys[i].name[0] == letter) return i;
+        }
+        return -1;
+    }
+
+    // Unsorted: one pass over the listing instead of a page load per DIR_CURSOR_PAGE entries
+    File root = _fs->open(_folder);
+    if (!root) return -1;
+    int found = -1;
+    bool isDir;
+    String path = root.getNextFileName(&isDir);
+    for (int index = 0; path.length() > 0;) {
+        String name = baseName(path);
+        if (accept(name, isDir)) {
+            if (index >= from && toupper(name[0]) == letter) {
+                found = index;
+                break;
+            }
+            index++;
+        }
+        path = root.getNextFileName(&isDir);
+    }
+    root.close();
+    return found;
+}
+
+int DirCursor::indexOf(const String &name) {
+    if (_keys) {
+        // Only entries with the same key need their name read
+        char key[DIR_CURSOR_KEY] = {0};
+        for (size_t i = 0; i < sizeof(key) && i < name.length(); i++) key[i] = toupper(name[i]);
+        for (int i = 0; i < _count; i++) {
+            if (memcmp(_keys[i].name, key, sizeof(key)) == 0 && at(i).filename == name) return i;
+        }
+        return -1;
+    }
+
+    File root = _fs->open(_folder);
+    if (!root) return -1;
+    int found = -1;
+    bool isDir;
+    String path = root.getNextFileName(&isDir);
+    for (int index = 0; path.length() > 0;) {
+        String entry = baseName(path);
+        if (accept(entry, isDir)) {
+            if (entry == name) {
+                found = index;
+                break;
+            }
+            index++;
+        }
+        path = root.getNextFileName(&isDir);
+    }
+    root.close();
+    return found;
+}
@@ -0,0 +1,74 @@
+#ifndef __DIR_CURSOR_H__
+#define __DIR_CURSOR_H__
+
+#include "sd_functions.h" // FileList
+#include <FS.h>
+#include <vector>
+
+// Entries kept in memory around the last one read
+#ifndef DIR_CURSOR_PAGE
+#define DIR_CURSOR_PAGE 48
+#endif
+// Length of the case-folded name prefix kept per entry for sorting
+#ifndef DIR_CURSOR_KEY
+#define DIR_CURSOR_KEY 11
+#endif
+// Largest sorted folder without PSRAM, bigger ones are listed in directory order
+#ifndef DIR_CURSOR_HEAP_ENTRIES
+#define DIR_CURSOR_HEAP_ENTRIES 2048
+#endif
+
+/*
+ * Walks a folder for the file browser without holding every name in memory.
+ * open() reads the listing once and keeps a 16 byte sort key per entry
+ * (folders first, then the upper-cased name prefix). Entries tied on the
+ * prefix, like capture_1.pcap and capture_2.pcap, are then ordered by the
+ * rest of their name, read in one pass over the listing per further prefix
+ * length. Names are read back a page at a time when at() leaves the loaded
+ * page. When the keys don't fit,
+ * entries come in directory order instead, so every file is still reachable.
+ * The last entry is the "> Back" item, as with the old readFs list.
+ */
+class DirCursor {
+public:
+    DirCursor() {}
+    ~DirCursor() { close(); }
+    DirCursor(const DirCursor &) = delete;
+    DirCursor &operator=(const DirCursor &) = delete;
+
+    bool open(FS &fs, const String &folder, const String &allowedExt = "*");
+    void close();
+
+    // Number of entries, including "> Back"
+    int size() { return _count + 1; }
+    // The returned reference is valid until the next call to at()
+    const FileList &at(int index);
+    // First entry at or after "from" whose name starts with letter (any case), -1 if none
+    int findLetter(char letter, int from);
+    // Position of the entry with this exact name, -1 if none
+    int indexOf(const String &name);
+    bool isSorted() { return _keys != NULL; }
+
+private:
+    struct Key {
+        char name[DIR_CURSOR_KEY];
+        uint8_t folder;
+        uint32_t ordinal; // position in the directory listing
+    };
+
+    FS *_fs = NULL;
+    String _folder;
+    String _allowedExt;
+    Key *_keys = NULL;
+    int _count = 0;
+    int _pageStart = 0;
+    std::vector<FileList> _page;
+    FileList _back = {"> Back", false, true};
+    FileList _blank = {"", false, false};
+
+    bool accept(const String &name, bool isDir);
+    void breakTies();
+    void loadPage(int first);
+};
+
+#endif
@@ -1,10 +1,11 @@
 #include "display.h"
 #include "core/wifi/webInterface.h" // for server
 #include "core/wifi/wg.h"           //for isConnectedWireguard to print wireguard lock
+#include "icon_cache.h"
+#include "jpeg_stream.h"
 #include "mykeyboard.h"
 #include "settings.h" //for timeStr
 #include "utils.h"
-#include <JPEGDecoder.h>
 #include <interface.h> //for charging ischarging to print charging indicator
 
 #define MAX_MENU_SIZE (int)(tftHeight / 25)
@@ -477,6 +478,11 @@ int loopOptions(
         }
 
         if (redraw) {
+            tft.beginFrame(
+                menuType == MENU_TYPE_MAIN      ? "mainMenu"
+                : menuType == MENU_TYPE_SUBMENU ? "submenu"
+                                                : "loopOptions"
+            );
             menuOptionType = menuType; // updates menutype to the remote controller
             menuOptionLabel = subText;
             // update the hovered
@@ -501,6 +507,7 @@ int loopOptions(
             }
             firstRender = false;
             redraw = false;
+            tft.endFrame();
         }
 
         // handleSerialCommands(); // always use serial task for it
@@ -929,13 +936,12 @@ void drawWireguardStatus(int x, int y) {
 ** Description:   Função para desenhar e mostrar o menu principal
 ***************************************************************************************/
 #define MAX_ITEMS (int)(tftHeight - 20) / (LH * FM)
-Opt_Coord listFiles(int index, std::vector<FileList> fileList) {
+Opt_Coord listFiles(int index, DirCursor &files) {
     Opt_Coord coord;
     if (index == 0) { tft.fillScreen(bruceConfig.bgColor); }
     tft.setCursor(10, 10);
     tft.setTextSize(FM);
-    int i = 0;
-    int arraySize = fileList.size();
+    int arraySize = files.size();
     int start = 0;
     if (index >= MAX_ITEMS) {
         start = index - MAX_ITEMS + 1;
@@ -943,28 +949,25 @@ Opt_Coord listFiles(int index, std::vector<FileList> fileList) {
     }
     int nchars = (tftWidth - 20) / (6 * tft.textsize);
     String txt = ">";
-    while (i < arraySize) {
-        if (i >= start) {
-            tft.setCursor(10, tft.getCursorY());
-            if (fileList[i].folder == true)
-                tft.setTextColor(getColorVariation(bruceConfig.priColor), bruceConfig.bgColor);
-            else if (fileList[i].operation == true) tft.setTextColor(ALCOLOR, bruceConfig.bgColor);
-            else { tft.setTextColor(bruceConfig.priColor, bruceConfig.bgColor); }
-
-            if (index == i) {
-                txt = ">";
-                coord.x = 10 + FM * LW;
-                coord.y = tft.getCursorY();
-                coord.size = nchars;
-                coord.fgcolor =
-                    fileList[i].folder ? getColorVariation(bruceConfig.priColor) : bruceConfig.priColor;
-                coord.bgcolor = bruceConfig.bgColor;
-            } else txt = " ";
-            txt += fileList[i].filename + "                 ";
-            tft.println(txt.substring(0, nchars));
-        }
-        i++;
-        if (i == (start + MAX_ITEMS) || i == arraySize) break;
+    // Only the visible rows are read, the cursor loads them from the folder as needed
+    for (int i = start; i < arraySize && i < start + MAX_ITEMS; i++) {
+        const FileList &file = files.at(i);
+        tft.setCursor(10, tft.getCursorY());
+        if (file.folder == true)
+            tft.setTextColor(getColorVariation(bruceConfig.priColor), bruceConfig.bgColor);
+        else if (file.operation == true) tft.setTextColor(ALCOLOR, bruceConfig.bgColor);
+        else { tft.setTextColor(bruceConfig.priColor, bruceConfig.bgColor); }
+
+        if (index == i) {
+            txt = ">";
+            coord.x = 10 + FM * LW;
+            coord.y = tft.getCursorY();
+            coord.size = nchars;
+            coord.fgcolor = file.folder ? getColorVariation(bruceConfig.priColor) : bruceConfig.priColor;
+            coord.bgcolor = bruceConfig.bgColor;
+        } else txt = " ";
+        txt += file.filename + "                 ";
+        tft.println(txt.substring(0, nchars));
     }
     tft.drawRoundRect(5, 5, tftWidth - 10, tftHeight - 10, 5, bruceConfig.priColor);
     tft.drawRoundRect(5, 5, tftWidth - 10, tftHeight - 10, 5, bruceConfig.priColor);
@@ -1075,82 +1078,8 @@ void drawMfkey64Icon(int x, int y) {
 // ####################################################################################################
 //  Draw a JPEG on the TFT, images will be cropped on the right/bottom sides if they do not fit
 // ####################################################################################################
-//  from:
-//  https://github.com/Bodmer/TFT_eSPI/blob/master/examples/Generic/ESP32_SDcard_jpeg/ESP32_SDcard_jpeg.ino
-//  This function assumes xpos,ypos is a valid screen coordinate. For convenience images that do not
-//  fit totally on the screen are cropped to the nearest MCU size and may leave right/bottom borders.
-void jpegRender(int xpos, int ypos) {
-
-    // jpegInfo(); // Print information from the JPEG file (could comment this line out)
-
-    uint16_t *pImg;
-    uint16_t mcu_w = JpegDec.MCUWidth;
-    uint16_t mcu_h = JpegDec.MCUHeight;
-    uint32_t max_x = JpegDec.width;
-    uint32_t max_y = JpegDec.height;
-
-    bool swapBytes = tft.getSwapBytes();
-    tft.setSwapBytes(true);
-
-    // Jpeg images are draw as a set of image block (tiles) called Minimum Coding Units (MCUs)
-    // Typically these MCUs are 16x16 pixel blocks
-    // Determine the width and height of the right and bottom edge image blocks
-    uint32_t min_w = jpg_min(mcu_w, max_x % mcu_w);
-    uint32_t min_h = jpg_min(mcu_h, max_y % mcu_h);
-
-    // save the current image block size
-    uint32_t win_w = mcu_w;
-    uint32_t win_h = mcu_h;
-
-    // save the coordinate of the right and bottom edges to assist image cropping
-    // to the screen size
-    max_x += xpos;
-    max_y += ypos;
-
-    // Fetch data from the file, decode and display
-    tft.fillRect(xpos, ypos, JpegDec.width, JpegDec.height, TFT_BLACK);
-    while (JpegDec.read()) {   // While there is more data in the file
-        pImg = JpegDec.pImage; // Decode a MCU (Minimum Coding Unit, typically a 8x8 or 16x16 pixel block)
-
-        // Calculate coordinates of top left corner of current MCU
-        int mcu_x = JpegDec.MCUx * mcu_w + xpos;
-        int mcu_y = JpegDec.MCUy * mcu_h + ypos;
-
-        // check if the image block size needs to be changed for the right edge
-        if (mcu_x + mcu_w <= max_x) win_w = mcu_w;
-        else win_w = min_w;
-
-        // check if the image block size needs to be changed for the bottom edge
-        if (mcu_y + mcu_h <= max_y) win_h = mcu_h;
-        else win_h = min_h;
-
-        // copy pixels into a contiguous block
-        if (win_w != mcu_w) {
-            uint16_t *cImg;
-            int p = 0;
-            cImg = pImg + win_w;
-            for (int h = 1; h < win_h; h++) {
-                p += mcu_w;
-                for (int w = 0; w < win_w; w++) {
-                    *cImg = *(pImg + w + p);
-                    cImg++;
-                }
-            }
-        }
-
-        // calculate how many pixels must be drawn
-        uint32_t mcu_pixels = win_w * win_h;
-
-        // draw image MCU block only if it will fit on the screen
-        if ((mcu_x + win_w) <= tft.width() && (mcu_y + win_h) <= tft.height())
-            tft.pushImage(mcu_x, mcu_y, win_w, win_h, pImg);
-        else if ((mcu_y + win_h) > tft.height())
-            JpegDec.abort(); // Image has run off bottom of screen so abort decoding
-    }
-
-    tft.setSwapBytes(swapBytes);
-}
-
+//  The file is streamed through JpegStream, so only a small read buffer and one MCU tile
+//  (typically 16x16 pixels) are held in memory, whatever the image size.
 bool showJpeg(FS &fs, String filename, int x, int y, bool center) {
     // record the current time so we can measure how long it takes to draw an image
     uint32_t drawTime = millis();
@@ -1158,62 +1087,33 @@ bool showJpeg(FS &fs, String filename, int x, int y, bool center) {
     if (fs.exists(filename)) picture = fs.open(filename, FILE_READ);
     else return false;
 
-    const size_t data_size = picture.size();
-
-    // Alloc memory into heap
-    uint8_t *data_array = new uint8_t[data_size];
-    if (data_array == nullptr) {
-        // Fail allocating memory
+    JpegStream jpeg;
+    if (!jpeg.open(picture)) {
         picture.close();
-        delete[] data_array;
+        displayError(filename + " Fail");
+        delay(2500);
         return false;
     }
 
-    uint8_t data;
-    int i = 0;
-    byte line_len = 0;
-
-    while (picture.available()) {
-        data = picture.read();
-        data_array[i] = data;
-        i++;
-
-        // print array on Serial
-        /*
-        Serial.print("0x");
-        if (abs(data) < 16) {
-          Serial.print("0");
-        }
-
-        Serial.print(data, HEX);
-        Serial.print(","); // Add value and comma
-        line_len++;
-        if (line_len >= 32) {
-          line_len = 0;
-          Serial.println();
-        }
-        */
+    if (center) {
+        x = x + (tftWidth - jpeg.width) / 2;
+        y = y + (tftHeight - jpeg.height) / 2;
     }
 
-    picture.close();
-
-    bool decoded = false;
-    if (data_array) {
-        decoded = JpegDec.decodeArray(data_array, data_size);
-    } else {
-        displayError(filename + " Fail");
-        delay(2500);
-        delete[] data_array; // free heap before leaving
-        return false;
+    bool swapBytes = tft.getSwapBytes();
+    tft.setSwapBytes(true);
+    tft.fillRect(x, y, jpeg.width, jpeg.height, TFT_BLACK);
+    while (jpeg.readMCU()) {
+        int mcu_x = x + jpeg.mcuX;
+        int mcu_y = y + jpeg.mcuY;
+        // draw image MCU block only if it will fit on the screen
+        if ((mcu_x + jpeg.blockW) <= tft.width() && (mcu_y + jpeg.blockH) <= tft.height())
+            tft.pushImage(mcu_x, mcu_y, jpeg.blockW, jpeg.blockH, jpeg.pImage);
+        else if ((mcu_y + jpeg.blockH) > tft.height()) break; // Image has run off bottom of screen
     }
+    tft.setSwapBytes(swapBytes);
+    picture.close();
 
-    if (decoded) {
-        if (center) {
-            x = x + (tftWidth - JpegDec.width) / 2;
-            y = y + (tftHeight - JpegDec.height) / 2;
-        }
-        jpegRender(x, y);
-    }
     // calculate how long it took to draw the image
     drawTime = millis() - drawTime; // Calculate the time it took
 
@@ -1223,7 +1123,6 @@ bool showJpeg(FS &fs, String filename, int x, int y, bool center) {
     Serial.println(" ms");
     Serial.println("=====================================");
 
-    delete[] data_array; // free heap before leaving
     return true;
 }
 #if !defined(LITE_VERSION)
@@ -1633,6 +1532,16 @@ bool drawImg(FS &fs, String filename, int x, int y, bool center, int playDuratio
     return false;
 }
 
+bool drawCachedImg(FS &fs, String filename, int x, int y, bool center) {
+    uint8_t fls = 2;         // 2 for Little FS
+    if (&fs == &SD) fls = 0; // 0 for SD
+    if (iconCache.draw(fs, filename, x, y, center)) {
+        tft.imageToBin(fls, filename, x, y, center, 0);
+        return true;
+    }
+    return drawImg(fs, filename, x, y, center);
+}
+
 #if !defined(LITE_VERSION)
 /// Draw PNG files
 
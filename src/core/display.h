@@ -2,6 +2,7 @@
 #define __DISPLAY_H__
 
 #include "core/serialcmds.h"
+#include "dir_cursor.h"
 #include "sd_functions.h" // to catch FileList Struct
 #include <FS.h>
 #include <LittleFS.h>
@@ -90,6 +91,12 @@ private:
  * @param playDurationMs: time that the GIF will be played
  */
 bool drawImg(FS &fs, String filename, int x = 0, int y = 0, bool center = false, int playDurationMs = 0);
+/*
+ * @name drawCachedImg
+ * Same as drawImg, but keeps the decoded image in iconCache so the next draw is a memory blit.
+ * Used for theme icons, GIFs and unsupported formats fall back to drawImg
+ */
+bool drawCachedImg(FS &fs, String filename, int x = 0, int y = 0, bool center = false);
 bool drawPNG(FS &fs, String filename, int x, int y, bool center);
 bool drawBmp(FS &fs, String filename, int x = 0, int y = 0, bool center = false);
 #if !defined(LITE_VERSION)
@@ -179,7 +186,7 @@ void printSubtitle(String subtitle, bool withLine = true);
 void printFootnote(String text);
 void printCenterFootnote(String text);
 
-Opt_Coord listFiles(int index, std::vector<FileList> fileList);
+Opt_Coord listFiles(int index, DirCursor &files);
 
 void drawWireguardStatus(int x, int y);
 
@@ -0,0 +1,489 @@
+#include "file_index.h"
+#include "sd_functions.h"
+#include <globals.h>
+
+#define FILE_INDEX_HEADER "#bruce-index 1"
+// Longest index line handled when searching from the file
+#define FILE_INDEX_LINE_MAX 512
+// Bytes read from .sub and .ir files to find their tags
+#define FILE_INDEX_TAG_SCAN 768
+
+static FileIndex sdIndex(SD, "SD");
+static FileIndex littleFsIndex(LittleFS, "LittleFS");
+
+// The menus pass SD and LittleFS around by value, copies share the implementation of the original
+struct FSImplOf : fs::FS {
+    static const void *get(fs::FS &fs) { return (fs.*(&FSImplOf::_impl)).get(); }
+};
+
+FileIndex *fileIndexFor(FS &fs) {
+    if (FSImplOf::get(fs) == FSImplOf::get(SD)) return &sdIndex;
+    if (FSImplOf::get(fs) == FSImplOf::get(LittleFS)) return &littleFsIndex;
+    return NULL;
+}
+
+static void fileIndexChanged(FS &fs, const String &path, bool removed) {
+    FileIndex *index = fileIndexFor(fs);
+    if (index == NULL) return;
+    if (removed) index->remove(path);
+    else index->update(path);
+}
+static bool fileIndexListening = addFileChangeListener(fileIndexChanged);
+
+// The mutex is recursive: an append can start a rebuild, which takes it again
+class IndexLock {
+public:
+    IndexLock(SemaphoreHandle_t mutex) : _mutex(mutex) { xSemaphoreTakeRecursive(_mutex, portMAX_DELAY); }
+    ~IndexLock() { xSemaphoreGiveRecursive(_mutex); }
+
+private:
+    SemaphoreHandle_t _mutex;
+};
+
+static void *indexAlloc(void *ptr, size_t size) {
+    return psramFound() ? ps_realloc(ptr, size) : realloc(ptr, size);
+}
+
+static String joinPath(const String &folder, const String &name) {
+    return folder.endsWith("/") ? folder + name : folder + "/" + name;
+}
+
+// Hidden files, including the index itself, and the folder Windows adds to cards
+static bool skipName(const String &name) {
+    return name.startsWith(".") || name == "System Volume Information";
+}
+
+// Entries of a folder with their type, read before recursing to keep one directory open
+static std::vector<std::pair<String, bool>> listFolder(File &dir) {
+    std::vector<std::pair<String, bool>> entries;
+    bool isDir;
+    String path = dir.getNextFileName(&isDir);
+    while (path.length() > 0) {
+        entries.push_back({path.substring(path.lastIndexOf('/') + 1), isDir});
+        path = dir.getNextFileName(&isDir);
+    }
+    return entries;
+}
+
+/*********************************************************************
+**  Function: fileTags
+**  Frequency and protocol of .sub files, protocols of .ir files and
+**  link type of .pcap files
+**********************************************************************/
+static String fileTags(File &file, const String &path) {
+    String ext = path.substring(path.lastIndexOf('.') + 1);
+    ext.toLowerCase();
+    String tags = "";
+
+    if (ext == "pcap") {
+        uint8_t header[24];
+        if (file.read(header, sizeof(header)) != sizeof(header)) return tags;
+        bool littleEndian = header[0] == 0xD4;
+        uint32_t linkType = littleEndian ? header[20] | header[21] << 8 : header[23] | header[22] << 8;
+        if (linkType == 105) tags = "802.11";
+        else if (linkType == 127) tags = "radiotap";
+        else if (linkType == 1) tags = "ethernet";
+        return tags;
+    }
+    if (ext != "sub" && ext != "ir") return tags;
+
+    char buf[FILE_INDEX_TAG_SCAN + 1];
+    size_t len = file.read((uint8_t *)buf, FILE_INDEX_TAG_SCAN);
+    buf[len] = '\0';
+    char *save = NULL;
+    for (char *line = strtok_r(buf, "\r\n", &save); line; line = strtok_r(NULL, "\r\n", &save)) {
+        char *colon = strchr(line, ':');
+        if (colon == NULL) continue;
+        *colon = '\0';
+        char *value = colon + 1;
+        while (*value == ' ') value++;
+        for (char *c = value; *c; c++) {
+            if (*c == '\t') *c = ' ';
+        }
+        if (*value == '\0') continue;
+
+        String tag = "";
+        if (ext == "sub" && strcasecmp(line, "Frequency") == 0) {
+            tag = String(strtoul(value, NULL, 10) / 1000000.0, 2) + "MHz";
+        } else if (strcasecmp(line, "Protocol") == 0) {
+            tag = value;
+        } else if (ext == "ir" && strcasecmp(line, "type") == 0 && strcasecmp(value, "raw") == 0) {
+            tag = "raw";
+        }
+        // .ir files repeat the protocol for every button
+        if (tag.length() == 0 || (" " + tags + " ").indexOf(" " + tag + " ") >= 0) continue;
+        if (tags.length()) tags += " ";
+        tags += tag;
+    }
+    return tags;
+}
+
+static String recordLine(const String &path, File &file) {
+    String line = path + "\t" + String((uint32_t)file.size()) + "\t" + String((uint32_t)file.getLastWrite());
+    line += "\t" + fileTags(file, path) + "\n";
+    return line;
+}
+
+FileIndex::FileIndex(FS &fs, const char *name) : _fs(fs), _name(name) {
+    _mutex = xSemaphoreCreateRecursiveMutex();
+}
+
+/*********************************************************************
+**  Function: load
+**  Check the index header and keep a copy of the file if it fits
+**********************************************************************/
+bool FileIndex::load() {
+    free(_buf);
+    _buf = NULL;
+    _len = _cap = 0;
+    _loaded = true;
+    _exists = false;
+
+    File file = _fs.open(FILE_INDEX_PATH, FILE_READ);
+    if (!file) return false;
+    // "#bruce-index 1 <bytes written by the rebuild>"
+    char header[40];
+    size_t n = file.readBytesUntil('\n', header, sizeof(header) - 1);
+    header[n] = '\0';
+    if (strncmp(header, FILE_INDEX_HEADER " ", strlen(FILE_INDEX_HEADER) + 1) != 0) {
+        file.close();
+        return false;
+    }
+    _exists = true;
+    _builtBytes = strtoul(header + strlen(FILE_INDEX_HEADER) + 1, NULL, 10);
+    _fileBytes = file.size();
+
+    size_t limit = psramFound() ? FILE_INDEX_PSRAM_MAX : FILE_INDEX_HEAP_MAX;
+    if (_fileBytes < limit) {
+        // Some room for the lines appended later
+        _cap = min(limit, _fileBytes + 2048);
+        _buf = (char *)indexAlloc(NULL, _cap);
+        if (_buf) {
+            file.seek(0);
+            _len = file.read((uint8_t *)_buf, _fileBytes);
+        } else {
+            _cap = 0;
+        }
+    }
+    file.close();
+    return true;
+}
+
+void FileIndex::append(const String &line) {
+    File out = _fs.open(FILE_INDEX_PATH, FILE_APPEND);
+    if (!out) return;
+    out.print(line);
+    out.close();
+    _fileBytes += line.length();
+
+    if (_buf) {
+        if (_len + line.length() > _cap) {
+            size_t limit = psramFound() ? FILE_INDEX_PSRAM_MAX : FILE_INDEX_HEAP_MAX;
+            size_t cap = min(limit, _cap * 2);
+            char *buf = _len + line.length() <= cap ? (char *)indexAlloc(_buf, cap) : NULL;
+            if (buf) {
+                _buf = buf;
+                _cap = cap;
+            } else {
+                // Too big to keep, searches read the file from now on
+                free(_buf);
+                _buf = NULL;
+                _len = _cap = 0;
+            }
+        }
+        if (_buf) {
+            memcpy(_buf + _len, line.c_str(), line.length());
+            _len += line.length();
+        }
+    }
+
+    if (_fileBytes - _builtBytes > FILE_INDEX_JOURNAL_MAX) rebuild(true);
+}
+
+void FileIndex::updateLocked(const String &path) {
+    String name = path.substring(path.lastIndexOf('/') + 1);
+    if (skipName(name) || path.indexOf('\t') >= 0 || path.indexOf('\n') >= 0) return;
+
+    File file = _fs.open(path, FILE_READ);
+    if (!file) {
+        append(path + "\t-\n");
+        return;
+    }
+    if (!file.isDirectory()) {
+        String line = recordLine(path, file);
+        file.close();
+        append(line);
+        return;
+    }
+    std::vector<std::pair<String, bool>> entries = listFolder(file);
+    file.close();
+    for (auto &entry : entries) updateLocked(joinPath(path, entry.first));
+}
+
+void FileIndex::update(const String &path) {
+    IndexLock lock(_mutex);
+    if (!_loaded) load();
+    if (_building) _pending.push_back(path);
+    if (_exists) updateLocked(path);
+}
+
+void FileIndex::remove(const String &path) {
+    IndexLock lock(_mutex);
+    if (!_loaded) load();
+    if (_building) _pending.push_back(path);
+    if (_exists) append(path + "\t-\n");
+}
+
+void FileIndex::unload() {
+    _abort = true;
+    for (int i = 0; i < 200 && _building; i++) delay(10);
+    IndexLock lock(_mutex);
+    free(_buf);
+    _buf = NULL;
+    _len = _cap = 0;
+    _loaded = false;
+    _pending.clear();
+}
+
+/*********************************************************************
+**  Function: walk
+**  Write an index line for every file under folder
+**********************************************************************/
+bool FileIndex::walk(File &out, const String &folder, uint32_t &files) {
+    File dir = _fs.open(folder);
+    if (!dir || !dir.isDirectory()) return true;
+    std::vector<std::pair<String, bool>> entries = listFolder(dir);
+    dir.close();
+
+    for (auto &entry : entries) {
+        if (_abort) return false;
+        String path = joinPath(folder, entry.first);
+        if (skipName(entry.first) || path.indexOf('\t') >= 0 || path.indexOf('\n') >= 0) continue;
+        if (entry.second) {
+            if (!walk(out, path, files)) return false;
+            continue;
+        }
+        File file = _fs.open(path, FILE_READ);
+        if (!file) continue;
+        String line = recordLine(path, file);
+        file.close();
+        if (out.print(line) != line.length()) return false;
+        // Let the other tasks at the card
+        if (++files % 32 == 0) vTaskDelay(1);
+    }
+    return true;
+}
+
+/*********************************************************************
+**  Function: build
+**  Write the index to a temporary file, then swap it in and apply
+**  the updates made meanwhile. _building must already be set.
+**********************************************************************/
+bool FileIndex::build() {
+    uint32_t start = millis();
+    uint32_t files = 0;
+    bool ok = false;
+    File out = _fs.open(FILE_INDEX_TMP_PATH, FILE_WRITE);
+    if (out) {
+        // The size is filled in once known, the header keeps the same length
+        out.printf("%s %10u\n", FILE_INDEX_HEADER, 0u);
+        ok = walk(out, "/", files);
+        size_t bytes = out.position();
+        ok = ok && out.seek(0) && out.printf("%s %10u\n", FILE_INDEX_HEADER, bytes) > 0;
+        out.close();
+    }
+
+    IndexLock lock(_mutex);
+    if (ok) {
+        _fs.remove(FILE_INDEX_PATH);
+        ok = _fs.rename(FILE_INDEX_TMP_PATH, FILE_INDEX_PATH);
+    }
+    _fs.remove(FILE_INDEX_TMP_PATH);
+    if (ok) {
+        load();
+        for (auto &path : _pending) updateLocked(path);
+        Serial.printf("%s index: %lu files in %lu ms\n", _name, files, millis() - start);
+    } else {
+        Serial.printf("%s index: rebuild %s\n", _name, _abort ? "cancelled" : "failed");
+    }
+    _pending.clear();
+    _building = false;
+    return ok;
+}
+
+void FileIndex::buildTask(void *arg) {
+    ((FileIndex *)arg)->build();
+    vTaskDelete(NULL);
+}
+
+bool FileIndex::rebuild(bool background) {
+    {
+        IndexLock lock(_mutex);
+        if (_building) return false;
+        _building = true;
+        _abort = false;
+    }
+    if (!background) return build();
+    if (xTaskCreate(buildTask, "FileIndex", 8192, this, 1, NULL) != pdPASS) {
+        _building = false;
+        return false;
+    }
+    return true;
+}
+
+/*********************************************************************
+**  Function: find
+**  Scan the index lines in order, later lines replacing earlier ones
+**********************************************************************/
+struct IndexQuery {
+    const char *query;
+    size_t queryLen;
+    bool byPath;
+    std::vector<String> exts; // empty for any
+    size_t maxResults;
+    std::vector<FileIndexHit> hits;
+};
+
+static bool startsWithNoCase(const char *text, size_t textLen, const char *prefix, size_t prefixLen) {
+    return textLen >= prefixLen && strncasecmp(text, prefix, prefixLen) == 0;
+}
+
+static bool matchLine(IndexQuery &q, const char *path, size_t pathLen, const char *tags, size_t tagsLen) {
+    const char *name = path;
+    for (size_t i = 0; i < pathLen; i++) {
+        if (path[i] == '/') name = path + i + 1;
+    }
+    size_t nameLen = path + pathLen - name;
+
+    if (!q.exts.empty()) {
+        const char *dot = path + pathLen - 1;
+        while (dot > name && *dot != '.') dot--;
+        if (*dot != '.') return false;
+        size_t extLen = path + pathLen - dot - 1;
+        bool found = false;
+        for (auto &ext : q.exts) {
+            if (ext.length() == extLen && strncasecmp(dot + 1, ext.c_str(), extLen) == 0) found = true;
+        }
+        if (!found) return false;
+    }
+
+    if (q.queryLen == 0) return true;
+    if (q.byPath) return startsWithNoCase(path, pathLen, q.query, q.queryLen);
+    if (startsWithNoCase(name, nameLen, q.query, q.queryLen)) return true;
+    for (size_t i = 0; i < tagsLen; i++) {
+        if ((i == 0 || tags[i - 1] == ' ') && startsWithNoCase(tags + i, tagsLen - i, q.query, q.queryLen)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// journal is true past the rebuilt part, where a path can appear again or be removed
+static void scanLine(IndexQuery &q, const char *line, size_t len, bool journal) {
+    if (len == 0 || line[0] != '/') return;
+    const char *fields[4] = {line, NULL, NULL, NULL};
+    size_t lens[4] = {len, 0, 0, 0};
+    int count = 1;
+    for (size_t i = 0; i < len && count < 4; i++) {
+        if (line[i] != '\t') continue;
+        lens[count - 1] = line + i - fields[count - 1];
+        fields[count] = line + i + 1;
+        lens[count] = line + len - fields[count];
+        count++;
+    }
+    if (count < 2) return;
+    const char *path = fields[0];
+    size_t pathLen = lens[0];
+
+    if (journal) {
+        bool removed = lens[1] == 1 && fields[1][0] == '-';
+        for (auto it = q.hits.begin(); it != q.hits.end();) {
+            const String &hit = it->path;
+            bool same = hit.length() == pathLen && memcmp(hit.c_str(), path, pathLen) == 0;
+            // A removed folder takes its files with it
+            bool inside = removed && hit.length() > pathLen && memcmp(hit.c_str(), path, pathLen) == 0 &&
+                          hit[pathLen] == '/';
+            if (same || inside) it = q.hits.erase(it);
+            else it++;
+        }
+        if (removed) return;
+    }
+    if (count < 4 || q.hits.size() >= q.maxResults) return;
+    if (!matchLine(q, path, pathLen, fields[3], lens[3])) return;
+
+    FileIndexHit hit;
+    hit.path = String(path, pathLen);
+    hit.size = strtoul(fields[1], NULL, 10);
+    hit.mtime = strtoul(fields[2], NULL, 10);
+    hit.tags = String(fields[3], lens[3]);
+    q.hits.push_back(hit);
+}
+
+std::vector<FileIndexHit> FileIndex::find(const String &query, const String &exts, size_t maxResults) {
+    IndexQuery q;
+    q.query = query.c_str();
+    q.queryLen = query.length();
+    q.byPath = query.startsWith("/");
+    q.maxResults = maxResults;
+    if (exts != "*" && exts.length() > 0) {
+        int start = 0;
+        int end;
+        while ((end = exts.indexOf('|', start)) >= 0) {
+            q.exts.push_back(exts.substring(start, end));
+            start = end + 1;
+        }
+        q.exts.push_back(exts.substring(start));
+    }
+
+    bool exists;
+    {
+        IndexLock lock(_mutex);
+        if (!_loaded) load();
+        exists = _exists;
+    }
+    if (!exists) {
+        if (!_building) rebuild(false);
+        while (_building) delay(50);
+    }
+
+    IndexLock lock(_mutex);
+    if (!_loaded) load();
+    uint32_t start = millis();
+    if (_buf) {
+        size_t pos = 0;
+        while (pos < _len) {
+            const char *line = _buf + pos;
+            const char *end = (const char *)memchr(line, '\n', _len - pos);
+            size_t len = end ? end - line : _len - pos;
+            scanLine(q, line, len, pos >= _builtBytes);
+            pos += len + 1;
+        }
+    } else if (_exists) {
+        // Too big for memory: read it in blocks, a line can span two of them
+        File file = _fs.open(FILE_INDEX_PATH, FILE_READ);
+        char *buf = (char *)malloc(2 * FILE_INDEX_LINE_MAX);
+        size_t have = 0;
+        size_t offset = 0; // file position of buf[0]
+        while (file && buf) {
+            size_t n = file.read((uint8_t *)buf + have, 2 * FILE_INDEX_LINE_MAX - have);
+            have += n;
+            size_t pos = 0;
+            while (true) {
+                const char *end = (const char *)memchr(buf + pos, '\n', have - pos);
+                if (end == NULL) break;
+                scanLine(q, buf + pos, end - (buf + pos), offset + pos >= _builtBytes);
+                pos = end - buf + 1;
+            }
+            // A line longer than the buffer is skipped
+            if (pos == 0 && have == 2 * FILE_INDEX_LINE_MAX) pos = have;
+            if (n == 0) break;
+            memmove(buf, buf + pos, have - pos);
+            have -= pos;
+            offset += pos;
+        }
+        free(buf);
+        file.close();
+    }
+    log_i("%s index: %d hits in %lu ms", _name, (int)q.hits.size(), millis() - start);
+    return q.hits;
+}
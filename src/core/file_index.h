@@ -0,0 +1,95 @@
+#ifndef __FILE_INDEX_H__
+#define __FILE_INDEX_H__
+
+#include <Arduino.h>
+#include <FS.h>
+#include <vector>
+
+// Index file kept at the root of each filesystem
+#define FILE_INDEX_PATH "/.bruce_index.tsv"
+#define FILE_INDEX_TMP_PATH "/.bruce_index.tmp"
+
+// Largest index kept in memory, bigger ones are searched from the file
+#ifndef FILE_INDEX_PSRAM_MAX
+#define FILE_INDEX_PSRAM_MAX (2 * 1024 * 1024)
+#endif
+#ifndef FILE_INDEX_HEAP_MAX
+#define FILE_INDEX_HEAP_MAX (24 * 1024)
+#endif
+// Bytes of incremental updates appended before the index is rebuilt in the background
+#ifndef FILE_INDEX_JOURNAL_MAX
+#define FILE_INDEX_JOURNAL_MAX (16 * 1024)
+#endif
+#ifndef FILE_INDEX_MAX_RESULTS
+#define FILE_INDEX_MAX_RESULTS 50
+#endif
+
+struct FileIndexHit {
+    String path;
+    uint32_t size;
+    uint32_t mtime;
+    String tags; // ex: "433.92MHz RAW" for a .sub, "NEC" for a .ir
+};
+
+/*
+ * Index of every file on a filesystem, so searches don't walk the folders.
+ * The index is a text file with one "path\tsize\tmtime\ttags" line per file.
+ * Files reported to fileChanged() append a line (or a "path\t-" line when they
+ * are removed), and later lines replace earlier ones for the same path.
+ * After FILE_INDEX_JOURNAL_MAX bytes of appended lines the index is rebuilt
+ * in the background, which also picks up files changed from a computer.
+ */
+class FileIndex {
+public:
+    FileIndex(FS &fs, const char *name);
+
+    // Walks the filesystem and writes a new index, in a task when background is true
+    bool rebuild(bool background);
+    bool isBuilding() { return _building; }
+    // Stops a background rebuild and drops the loaded copy, ex: before the SD card is unmounted
+    void unload();
+
+    // A file or folder was written or removed
+    void update(const String &path);
+    void remove(const String &path);
+
+    /*
+     * Files whose name starts with query, or with a tag starting with it (any case).
+     * A query starting with "/" matches the start of the path instead. exts is
+     * "*" or a list like "sub|ir". An empty query matches every file.
+     * Builds the index first if there is none.
+     */
+    std::vector<FileIndexHit>
+    find(const String &query, const String &exts = "*", size_t maxResults = FILE_INDEX_MAX_RESULTS);
+
+    FS &fs() { return _fs; }
+    const char *name() { return _name; }
+    size_t memoryUsed() { return _buf ? _cap : 0; }
+
+private:
+    FS &_fs;
+    const char *_name;
+    SemaphoreHandle_t _mutex;
+    char *_buf = NULL; // copy of the index file when it fits in memory
+    size_t _len = 0;
+    size_t _cap = 0;
+    bool _loaded = false;
+    bool _exists = false;
+    size_t _builtBytes = 0; // size of the index when it was built, the journal follows
+    size_t _fileBytes = 0;
+    volatile bool _building = false;
+    volatile bool _abort = false;
+    std::vector<String> _pending; // updated while a rebuild runs, applied to the new index
+
+    bool load();
+    void append(const String &line);
+    void updateLocked(const String &path);
+    bool walk(File &out, const String &folder, uint32_t &files);
+    bool build();
+    static void buildTask(void *arg);
+};
+
+// Index of SD or LittleFS, NULL for other filesystems
+FileIndex *fileIndexFor(FS &fs);
+
+#endif
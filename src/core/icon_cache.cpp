@@ -0,0 +1,268 @@
+#include "icon_cache.h"
+#include "jpeg_stream.h"
+#include "sd_functions.h"
+#include <globals.h>
+
+IconCache iconCache;
+
+// Any written file may be a theme image
+static void iconCacheFileChanged(FS &fs, const String &path, bool removed) { iconCache.invalidate(); }
+static bool iconCacheListening = addFileChangeListener(iconCacheFileChanged);
+
+static void *iconAlloc(size_t size) { return psramFound() ? ps_malloc(size) : malloc(size); }
+
+size_t IconCache::getBudget() {
+    if (_budget == 0) _budget = psramFound() ? ICON_CACHE_PSRAM_BUDGET : ICON_CACHE_HEAP_BUDGET;
+    return _budget;
+}
+
+void IconCache::setBudget(size_t bytes) {
+    _budget = bytes;
+    makeRoom(0);
+}
+
+void IconCache::clear() {
+    for (auto &e : _entries) free(e.pixels);
+    _entries.clear();
+    _used = 0;
+}
+
+void IconCache::remove(size_t index) {
+    _used -= (size_t)_entries[index].width * _entries[index].height * 2;
+    free(_entries[index].pixels);
+    _entries.erase(_entries.begin() + index);
+}
+
+/*********************************************************************
+**  Function: makeRoom
+**  Drop least recently used entries until "bytes" fit in the budget
+**********************************************************************/
+bool IconCache::makeRoom(size_t bytes) {
+    if (bytes > getBudget()) return false;
+    while (!_entries.empty() && _used + bytes > getBudget()) {
+        size_t lru = 0;
+        for (size_t i = 1; i < _entries.size(); i++) {
+            if (_entries[i].lastUse < _entries[lru].lastUse) lru = i;
+        }
+        log_d("IconCache: evicting %s", _entries[lru].path.c_str());
+        remove(lru);
+    }
+    return true;
+}
+
+IconCache::Entry *IconCache::find(FS &fs, const String &filename) {
+    if (_stale) {
+        _stale = false;
+        for (auto &e : _entries) e.verified = false;
+    }
+    for (size_t i = 0; i < _entries.size(); i++) {
+        Entry &e = _entries[i];
+        if (e.fs != &fs || e.path != filename) continue;
+
+        // Files changed since invalidate(), decode this one again if it was edited
+        if (!e.verified) {
+            File f = fs.open(filename, FILE_READ);
+            if (!f || f.getLastWrite() != e.mtime || f.size() != e.fileSize) {
+                if (f) f.close();
+                remove(i);
+                return nullptr;
+            }
+            f.close();
+            e.verified = true;
+        }
+        return &e;
+    }
+    return nullptr;
+}
+
+IconCache::Entry *IconCache::load(FS &fs, const String &filename) {
+    Entry *entry = find(fs, filename);
+    if (entry == nullptr) {
+        _misses++;
+        Entry e = {&fs, filename, 0, 0, 0, 0, nullptr, 0, true};
+        if (!decode(fs, filename, e)) return nullptr;
+        _entries.push_back(e);
+        _used += (size_t)e.width * e.height * 2;
+        entry = &_entries.back();
+    } else {
+        _hits++;
+    }
+    entry->lastUse = ++_tick;
+    return entry;
+}
+
+bool IconCache::preload(FS &fs, const String &filename) { return load(fs, filename) != nullptr; }
+
+bool IconCache::draw(FS &fs, const String &filename, int x, int y, bool center) {
+    Entry *entry = load(fs, filename);
+    if (entry == nullptr) return false;
+
+    if (center) {
+        x = x + (tftWidth - entry->width) / 2;
+        y = y + (tftHeight - entry->height) / 2;
+    }
+    bool swapBytes = tft.getSwapBytes();
+    tft.setSwapBytes(true);
+    tft.pushImage(x, y, entry->width, entry->height, entry->pixels);
+    tft.setSwapBytes(swapBytes);
+    return true;
+}
+
+bool IconCache::decode(FS &fs, const String &filename, Entry &entry) {
+    String ext = filename.substring(filename.lastIndexOf('.'));
+    ext.toLowerCase();
+    if (!ext.endsWith("jpg") && !ext.endsWith("bmp") && !ext.endsWith("png")) return false;
+
+    File file = fs.open(filename, FILE_READ);
+    if (!file) return false;
+    entry.mtime = file.getLastWrite();
+    entry.fileSize = file.size();
+
+    uint32_t t = millis();
+    bool ok = false;
+    if (ext.endsWith("jpg")) ok = decodeJpeg(file, entry);
+    else if (ext.endsWith("bmp")) ok = decodeBmp(file, entry);
+    file.close();
+    if (ext.endsWith("png")) ok = decodePng(fs, filename, entry);
+
+    if (ok) log_d("IconCache: %s decoded in %lums", filename.c_str(), millis() - t);
+    return ok;
+}
+
+bool IconCache::decodeJpeg(File &file, Entry &entry) {
+    JpegStream jpeg;
+    if (!jpeg.open(file)) return false;
+
+    size_t bytes = (size_t)jpeg.width * jpeg.height * 2;
+    if (!makeRoom(bytes) || !(entry.pixels = (uint16_t *)iconAlloc(bytes))) return false;
+    entry.width = jpeg.width;
+    entry.height = jpeg.height;
+
+    while (jpeg.readMCU()) {
+        for (int row = 0; row < jpeg.blockH; row++) {
+            memcpy(
+                entry.pixels + (jpeg.mcuY + row) * entry.width + jpeg.mcuX,
+                jpeg.pImage + row * jpeg.blockW,
+                jpeg.blockW * sizeof(uint16_t)
+            );
+        }
+    }
+    return true;
+}
+
+bool IconCache::decodeBmp(File &file, Entry &entry) {
+    uint8_t header[54];
+    if (file.read(header, sizeof(header)) != sizeof(header)) return false;
+    if (header[0] != 'B' || header[1] != 'M') return false;
+
+    uint32_t seekOffset = *(uint32_t *)&header[10];
+    uint32_t w = *(uint32_t *)&header[18];
+    uint32_t h = *(uint32_t *)&header[22];
+    // Same restriction as drawBmp: 1 plane, 24 bits, no compression
+    if (*(uint16_t *)&header[26] != 1 || *(uint16_t *)&header[28] != 24 || *(uint32_t *)&header[30] != 0)
+        return false;
+
+    // Icons never exceed the screen (in any rotation), this also rejects top-down bitmaps (negative height)
+    uint32_t maxSide = tftWidth > tftHeight ? tftWidth : tftHeight;
+    if (w == 0 || h == 0 || w > maxSide || h > maxSide) return false;
+
+    size_t bytes = (size_t)w * h * 2;
+    if (!makeRoom(bytes) || !(entry.pixels = (uint16_t *)iconAlloc(bytes))) return false;
+    entry.width = w;
+    entry.height = h;
+
+    size_t rowSize = ((w * 3) + 3) & ~3; // rows are padded to 4 bytes
+    uint8_t *lineBuffer = (uint8_t *)malloc(rowSize);
+    bool ok = lineBuffer && file.seek(seekOffset);
+    // BMP rows are stored bottom up
+    for (int row = h - 1; ok && row >= 0; row--) {
+        ok = file.read(lineBuffer, rowSize) == rowSize;
+        uint8_t *bptr = lineBuffer;
+        uint16_t *tptr = entry.pixels + row * w;
+        for (uint32_t col = 0; ok && col < w; col++) {
+            uint8_t b = *bptr++;
+            uint8_t g = *bptr++;
+            uint8_t r = *bptr++;
+            *tptr++ = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+        }
+    }
+    free(lineBuffer);
+    if (!ok) {
+        free(entry.pixels);
+        entry.pixels = nullptr;
+    }
+    return ok;
+}
+
+#if !defined(LITE_VERSION)
+#include <PNGdec.h>
+
+static File iconPngFile;
+static FS *iconPngFs;
+
+static void *iconPngOpen(const char *filename, int32_t *size) {
+    iconPngFile = iconPngFs->open(filename);
+    *size = iconPngFile.size();
+    return &iconPngFile;
+}
+static void iconPngClose(void *handle) {
+    if (iconPngFile) iconPngFile.close();
+}
+static int32_t iconPngRead(PNGFILE *handle, uint8_t *buffer, int32_t length) {
+    if (!iconPngFile) return 0;
+    return iconPngFile.read(buffer, length);
+}
+static int32_t iconPngSeek(PNGFILE *handle, int32_t position) {
+    if (!iconPngFile) return 0;
+    return iconPngFile.seek(position);
+}
+
+struct IconPngCtx {
+    PNG *png;
+    IconCache::Entry *entry;
+};
+
+static int iconPngDraw(PNGDRAW *pDraw) {
+    IconPngCtx *ctx = (IconPngCtx *)pDraw->pUser;
+    // Transparent pixels are blended with the background, same as PNGDraw in display.cpp
+    uint8_t r = ((uint16_t)bruceConfig.bgColor & 0xF800) >> 8;
+    uint8_t g = ((uint16_t)bruceConfig.bgColor & 0x07E0) >> 3;
+    uint8_t b = ((uint16_t)bruceConfig.bgColor & 0x001F) << 3;
+    ctx->png->getLineAsRGB565(
+        pDraw,
+        ctx->entry->pixels + pDraw->y * ctx->entry->width,
+        PNG_RGB565_LITTLE_ENDIAN,
+        b << 16 | g << 8 | r
+    );
+    return 1;
+}
+
+bool IconCache::decodePng(FS &fs, const String &filename, Entry &entry) {
+    void *mem = iconAlloc(sizeof(PNG));
+    if (!mem) return false;
+    PNG *png = new (mem) PNG();
+    iconPngFs = &fs;
+
+    bool ok = false;
+    if (png->open(filename.c_str(), iconPngOpen, iconPngClose, iconPngRead, iconPngSeek, iconPngDraw) ==
+        PNG_SUCCESS) {
+        size_t bytes = (size_t)png->getWidth() * png->getHeight() * 2;
+        if (makeRoom(bytes) && (entry.pixels = (uint16_t *)iconAlloc(bytes))) {
+            entry.width = png->getWidth();
+            entry.height = png->getHeight();
+            IconPngCtx ctx = {png, &entry};
+            ok = png->decode(&ctx, 0) == PNG_SUCCESS;
+            if (!ok) {
+                free(entry.pixels);
+                entry.pixels = nullptr;
+            }
+        }
+        png->close();
+    }
+    png->~PNG();
+    free(mem);
+    return ok;
+}
+#else
+bool IconCache::decodePng(FS &fs, const String &filename, Entry &entry) { return false; }
+#endif
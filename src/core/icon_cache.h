@@ -0,0 +1,77 @@
+#ifndef __ICON_CACHE_H__
+#define __ICON_CACHE_H__
+
+#include <Arduino.h>
+#include <FS.h>
+#include <vector>
+
+// Byte budget for decoded icons, can be overridden in platformio.ini
+#ifndef ICON_CACHE_PSRAM_BUDGET
+#define ICON_CACHE_PSRAM_BUDGET (512 * 1024)
+#endif
+#ifndef ICON_CACHE_HEAP_BUDGET
+#define ICON_CACHE_HEAP_BUDGET (48 * 1024)
+#endif
+
+/*
+ * Keeps decoded RGB565 copies of theme images (JPG, BMP and PNG), so redrawing
+ * a menu icon is a single pushImage instead of a filesystem read plus decode.
+ * Entries are keyed by filesystem, path and last write time, and the least
+ * recently used ones are dropped when the byte budget is exceeded. A hit
+ * doesn't touch the filesystem: the cache is cleared when the theme changes,
+ * and the write time of an entry is only checked again after invalidate(),
+ * which every fileChanged() calls.
+ */
+class IconCache {
+public:
+    struct Entry {
+        FS *fs;
+        String path;
+        time_t mtime;
+        size_t fileSize;
+        uint16_t width;
+        uint16_t height;
+        uint16_t *pixels; // native endian RGB565
+        uint32_t lastUse;
+        bool verified; // false after invalidate() until the file is checked again
+    };
+
+    // Draws the image from cache, decoding and storing it on a miss.
+    // Returns false if the image could not be cached, so the caller can fall back to drawImg
+    bool draw(FS &fs, const String &filename, int x, int y, bool center);
+    // Decodes the image into the cache without drawing it, ex: while the device boots
+    bool preload(FS &fs, const String &filename);
+
+    void clear();
+    // Files may have changed, each entry is checked against its file on its next use.
+    // Only sets a flag, so it can be called from any task
+    void invalidate() { _stale = true; }
+    void setBudget(size_t bytes);
+    size_t getBudget();
+    size_t getUsedBytes() { return _used; }
+    size_t getEntryCount() { return _entries.size(); }
+    uint32_t getHits() { return _hits; }
+    uint32_t getMisses() { return _misses; }
+
+private:
+    std::vector<Entry> _entries;
+    size_t _budget = 0;
+    size_t _used = 0;
+    uint32_t _tick = 0;
+    uint32_t _hits = 0;
+    uint32_t _misses = 0;
+    volatile bool _stale = false;
+
+    Entry *find(FS &fs, const String &filename);
+    Entry *load(FS &fs, const String &filename);
+    void remove(size_t index);
+    bool makeRoom(size_t bytes);
+    bool decode(FS &fs, const String &filename, Entry &entry);
+    bool decodeJpeg(File &file, Entry &entry);
+    bool decodeBmp(File &file, Entry &entry);
+    bool decodePng(FS &fs, const String &filename, Entry &entry);
+};
+
+extern IconCache iconCache;
+
+#endif
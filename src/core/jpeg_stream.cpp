@@ -0,0 +1,84 @@
+#include "jpeg_stream.h"
+
+unsigned char
+JpegStream::needBytes(unsigned char *pBuf, unsigned char bufSize, unsigned char *pBytesRead, void *pData) {
+    JpegStream *s = (JpegStream *)pData;
+    if (s->_pos >= s->_len) {
+        s->_len = s->_file->read(s->_buf, sizeof(s->_buf));
+        s->_pos = 0;
+    }
+    size_t n = s->_len - s->_pos;
+    if (n > bufSize) n = bufSize;
+    memcpy(pBuf, s->_buf + s->_pos, n);
+    s->_pos += n;
+    *pBytesRead = n;
+    return 0;
+}
+
+bool JpegStream::open(File &file) {
+    _file = &file;
+    _pos = _len = 0;
+    _col = _row = 0;
+
+    uint8_t status = pjpeg_decode_init(&_info, needBytes, this, 0);
+    if (status) {
+        log_e("JPEG: decode init failed (%d)", status);
+        return false;
+    }
+    width = _info.m_width;
+    height = _info.m_height;
+    mcuWidth = _info.m_MCUWidth;
+    mcuHeight = _info.m_MCUHeight;
+    return true;
+}
+
+/*********************************************************************
+**  Function: readMCU
+**  Decode one MCU and convert its 8x8 blocks into a packed RGB565 tile,
+**  cropping the right and bottom edges of the image
+**********************************************************************/
+bool JpegStream::readMCU() {
+    if (_file == nullptr || _row >= _info.m_MCUSPerCol) return false;
+
+    uint8_t status = pjpeg_decode_mcu();
+    if (status) {
+        if (status != PJPG_NO_MORE_BLOCKS) log_e("JPEG: decode failed (%d)", status);
+        _file = nullptr;
+        return false;
+    }
+
+    mcuX = _col * mcuWidth;
+    mcuY = _row * mcuHeight;
+    blockW = min<int>(mcuWidth, width - mcuX);
+    blockH = min<int>(mcuHeight, height - mcuY);
+
+    for (int y = 0; y < blockH; y += 8) {
+        int by_limit = min(8, blockH - y);
+        for (int x = 0; x < blockW; x += 8) {
+            int bx_limit = min(8, blockW - x);
+            // Blocks are stored 64 bytes apart in the decoder's MCU buffer
+            unsigned int src_ofs = (x * 8U) + (y * 16U);
+            const uint8_t *pSrcR = _info.m_pMCUBufR + src_ofs;
+            const uint8_t *pSrcG = _info.m_pMCUBufG + src_ofs;
+            const uint8_t *pSrcB = _info.m_pMCUBufB + src_ofs;
+
+            for (int by = 0; by < by_limit; by++) {
+                uint16_t *pDst = pImage + (y + by) * blockW + x;
+                for (int bx = 0; bx < bx_limit; bx++) {
+                    if (_info.m_scanType == PJPG_GRAYSCALE)
+                        *pDst++ = (pSrcR[bx] & 0xF8) << 8 | (pSrcR[bx] & 0xFC) << 3 | pSrcR[bx] >> 3;
+                    else *pDst++ = (pSrcR[bx] & 0xF8) << 8 | (pSrcG[bx] & 0xFC) << 3 | pSrcB[bx] >> 3;
+                }
+                pSrcR += 8;
+                pSrcG += 8;
+                pSrcB += 8;
+            }
+        }
+    }
+
+    if (++_col == _info.m_MCUSPerRow) {
+        _col = 0;
+        _row++;
+    }
+    return true;
+}
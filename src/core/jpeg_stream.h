@@ -0,0 +1,50 @@
+#ifndef __JPEG_STREAM_H__
+#define __JPEG_STREAM_H__
+
+#include <FS.h>
+#include <picojpeg.h>
+
+// Size of the bulk read buffer that feeds the decoder
+#ifndef JPEG_STREAM_CHUNK
+#define JPEG_STREAM_CHUNK 512
+#endif
+
+/*
+ * Decodes a baseline JPEG straight from a File, one MCU at a time.
+ * The file is read in JPEG_STREAM_CHUNK blocks, so the image never needs
+ * to fit in memory. picojpeg keeps global state, only one stream may be
+ * decoding at any time.
+ */
+class JpegStream {
+public:
+    bool open(File &file);
+    // Decodes the next MCU into pImage. Returns false when the image is done or on error
+    bool readMCU();
+
+    uint16_t width = 0;
+    uint16_t height = 0;
+    uint8_t mcuWidth = 0;
+    uint8_t mcuHeight = 0;
+
+    // Position (relative to the image) and cropped size of the last decoded MCU,
+    // pImage holds blockW x blockH native endian RGB565 pixels with no padding
+    uint16_t mcuX = 0;
+    uint16_t mcuY = 0;
+    uint8_t blockW = 0;
+    uint8_t blockH = 0;
+    uint16_t pImage[16 * 16];
+
+private:
+    File *_file = nullptr;
+    uint8_t _buf[JPEG_STREAM_CHUNK];
+    size_t _pos = 0;
+    size_t _len = 0;
+    uint16_t _col = 0;
+    uint16_t _row = 0;
+    pjpeg_image_info_t _info;
+
+    static unsigned char
+    needBytes(unsigned char *pBuf, unsigned char bufSize, unsigned char *pBytesRead, void *pData);
+};
+
+#endif
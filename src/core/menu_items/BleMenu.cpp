@@ -40,7 +40,7 @@ void BleMenu::optionsMenu() {
     loopOptions(options, MENU_TYPE_SUBMENU, "Bluetooth");
 }
 void BleMenu::drawIconImg() {
-    drawImg(
+    drawCachedImg(
         *bruceConfig.themeFS(), bruceConfig.getThemeItemImg(bruceConfig.theme.paths.ble), 0, imgCenterY, true
     );
 }
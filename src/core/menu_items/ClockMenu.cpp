@@ -4,7 +4,7 @@
 
 void ClockMenu::optionsMenu() { runClockLoop(); }
 void ClockMenu::drawIconImg() {
-    drawImg(
+    drawCachedImg(
         *bruceConfig.themeFS(),
         bruceConfig.getThemeItemImg(bruceConfig.theme.paths.clock),
         0,
@@ -53,8 +53,14 @@ void ConfigMenu::optionsMenu() {
         {"Reiniciar", [=]() { ESP.restart(); }},
     };
 
-    options.push_back({"Apagar", powerOff});
-    options.push_back({"Sueño profundo", goToDeepSleep});
+    options.push_back({"Apagar", [=]() {
+                           bruceConfig.flush();
+                           powerOff();
+                       }});
+    options.push_back({"Sueño profundo", [=]() {
+                           bruceConfig.flush();
+                           goToDeepSleep();
+                       }});
 
     if (bruceConfig.devMode) options.push_back({"Configurar pines del dispositivo", [=]() { devMenu(); }});
 
@@ -80,7 +86,7 @@ void ConfigMenu::devMenu() {
     loopOptions(options, MENU_TYPE_SUBMENU, "Modo desarrollador");
 }
 void ConfigMenu::drawIconImg() {
-    drawImg(
+    drawCachedImg(
         *bruceConfig.themeFS(),
         bruceConfig.getThemeItemImg(bruceConfig.theme.paths.config),
         0,
@@ -19,7 +19,7 @@ void ConnectMenu::optionsMenu() {
     loopOptions(options, MENU_TYPE_SUBMENU, getName().c_str());
 }
 void ConnectMenu::drawIconImg() {
-    drawImg(
+    drawCachedImg(
         *bruceConfig.themeFS(),
         bruceConfig.getThemeItemImg(bruceConfig.theme.paths.connect),
         0,
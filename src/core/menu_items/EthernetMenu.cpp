@@ -43,7 +43,7 @@ void EthernetMenu::optionsMenu() {
 }
 
 void EthernetMenu::drawIconImg() {
-    drawImg(
+    drawCachedImg(
         *bruceConfig.themeFS(), bruceConfig.getThemeItemImg(bruceConfig.theme.paths.rfid), 0, imgCenterY, true
     );
 }
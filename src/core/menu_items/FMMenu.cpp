@@ -19,7 +19,7 @@ void FMMenu::optionsMenu() {
     loopOptions(options, MENU_TYPE_SUBMENU, "FM");
 }
 void FMMenu::drawIconImg() {
-    drawImg(
+    drawCachedImg(
         *bruceConfig.themeFS(), bruceConfig.getThemeItemImg(bruceConfig.theme.paths.fm), 0, imgCenterY, true
     );
 }
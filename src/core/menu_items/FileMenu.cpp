@@ -9,6 +9,11 @@ void FileMenu::optionsMenu() {
     options.clear();
     if(sdcardMounted) options.push_back({"Tarjeta SD", [=]() { loopSD(SD); }});
     options.push_back({"LittleFS", [=]() { loopSD(LittleFS); }});
+    options.push_back({"Buscar archivos", [=]() {
+                           FS *fs = NULL;
+                           String path = searchFiles(fs, true);
+                           if (path != "") browseToFile(*fs, path);
+                       }});
     options.push_back({"WebUI", loopOptionsWebUi});
 #if defined(ARDUINO_USB_MODE) && !defined(USE_SD_MMC)
     options.push_back({"Almacenamiento masivo", [=]() { MassStorage(); }});
@@ -18,7 +23,7 @@ void FileMenu::optionsMenu() {
     loopOptions(options, MENU_TYPE_SUBMENU, "Archivos");
 }
 void FileMenu::drawIconImg() {
-    drawImg(
+    drawCachedImg(
         *bruceConfig.themeFS(),
         bruceConfig.getThemeItemImg(bruceConfig.theme.paths.files),
         0,
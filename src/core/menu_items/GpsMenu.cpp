@@ -28,7 +28,7 @@ void GpsMenu::configMenu() {
     loopOptions(options, MENU_TYPE_SUBMENU, "Config GPS");
 }
 void GpsMenu::drawIconImg() {
-    drawImg(
+    drawCachedImg(
         *bruceConfig.themeFS(), bruceConfig.getThemeItemImg(bruceConfig.theme.paths.gps), 0, imgCenterY, true
     );
 }
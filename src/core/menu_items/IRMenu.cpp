@@ -34,7 +34,7 @@ void IRMenu::configMenu() {
     loopOptions(options, MENU_TYPE_SUBMENU, "Config IR");
 }
 void IRMenu::drawIconImg() {
-    drawImg(
+    drawCachedImg(
         *bruceConfig.themeFS(), bruceConfig.getThemeItemImg(bruceConfig.theme.paths.ir), 0, imgCenterY, true
     );
 }
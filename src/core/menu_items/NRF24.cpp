@@ -63,7 +63,7 @@ void NRF24Menu::configMenu() {
     }
 }
 void NRF24Menu::drawIconImg() {
-    drawImg(
+    drawCachedImg(
         *bruceConfig.themeFS(), bruceConfig.getThemeItemImg(bruceConfig.theme.paths.nrf), 0, imgCenterY, true
     );
 }
@@ -36,7 +36,7 @@ void OthersMenu::optionsMenu() {
         loopOptions(options, MENU_TYPE_SUBMENU, "Otros");
 }
 void OthersMenu::drawIconImg() {
-    drawImg(
+    drawCachedImg(
         *bruceConfig.themeFS(),
         bruceConfig.getThemeItemImg(bruceConfig.theme.paths.others),
         0,
@@ -50,7 +50,7 @@ void RFIDMenu::configMenu() {
     loopOptions(options, MENU_TYPE_SUBMENU, "Config RFID");
 }
 void RFIDMenu::drawIconImg() {
-    drawImg(
+    drawCachedImg(
         *bruceConfig.themeFS(), bruceConfig.getThemeItemImg(bruceConfig.theme.paths.rfid), 0, imgCenterY, true
     );
 }
@@ -49,7 +49,7 @@ void RFMenu::configMenu() {
     loopOptions(options, MENU_TYPE_SUBMENU, "Config RF");
 }
 void RFMenu::drawIconImg() {
-    drawImg(
+    drawCachedImg(
         *bruceConfig.themeFS(), bruceConfig.getThemeItemImg(bruceConfig.theme.paths.rf), 0, imgCenterY, true
     );
 }
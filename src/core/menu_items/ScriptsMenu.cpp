@@ -59,7 +59,7 @@ void ScriptsMenu::optionsMenu() {
     loopOptions(options, MENU_TYPE_SUBMENU, "Scripts");
 }
 void ScriptsMenu::drawIconImg() {
-    drawImg(
+    drawCachedImg(
         *bruceConfig.themeFS(),
         bruceConfig.getThemeItemImg(bruceConfig.theme.paths.interpreter),
         0,
@@ -119,7 +119,7 @@ void WifiMenu::configMenu() {
     loopOptions(options, MENU_TYPE_SUBMENU, "Config WiFi");
 }
 void WifiMenu::drawIconImg() {
-    drawImg(
+    drawCachedImg(
         *bruceConfig.themeFS(), bruceConfig.getThemeItemImg(bruceConfig.theme.paths.wifi), 0, imgCenterY, true
     );
 }
@@ -445,6 +445,7 @@ String generalKeyboard(
     // main loop
     while (1) {
         if (redraw) {
+            tft.beginFrame("keyboard");
             // setup
             tft.setCursor(0, 0);
             tft.setTextColor(getComplementaryColor2(bruceConfig.bgColor), bruceConfig.bgColor);
@@ -612,6 +613,7 @@ String generalKeyboard(
             old_x = x;
             old_y = y;
             redraw = false;
+            tft.endFrame();
         }
 
         // Cursor Handler
@@ -8,8 +8,7 @@
 #include "type_convertion.h"
 #include <globals.h>
 
-String xorEncryptDecryptMD5(const String &input, const String &password, const int MD5_PASSES) {
-
+void xorKeyMD5(const String &password, uint8_t key[16], const int MD5_PASSES) {
     MD5Builder md5;
     String hash = password;
 
@@ -19,8 +18,12 @@ String xorEncryptDecryptMD5(const String &input, const String &password, const i
         md5.calculate();
     }
 
+    md5.getBytes(key); // Store MD5 hash in the output array
+}
+
+String xorEncryptDecryptMD5(const String &input, const String &password, const int MD5_PASSES) {
     uint8_t md5Hash[16];
-    md5.getBytes(md5Hash); // Store MD5 hash in the output array
+    xorKeyMD5(password, md5Hash, MD5_PASSES);
 
     String output = input; // Copy input to output for modification
     for (size_t i = 0; i < input.length(); i++) {
@@ -163,12 +166,15 @@ String encryptString(String &plaintext, const String &password_str) {
     dataStrHex.toUpperCase();
     dataStrHex.trim();
 
+    return encryptedFileHeader() + dataStrHex + "\n";
+}
+
+String encryptedFileHeader() {
     String out = "Filetype: Bruce Encrypted File\nVersion: 1\n";
     out += "Algo: XOR\n"; // TODO: add AES
     out += "KeyDerivationAlgo: MD5\n";
     out += "KeyDerivationPasses: 10\n";
-    out += "Data: " + dataStrHex + "\n";
-
+    out += "Data: ";
     return out;
 }
 
@@ -6,6 +6,11 @@
 
 String encryptString(String &plaintext, const String &password_str);
 
+// Building blocks of encryptString, used to encrypt files chunk by chunk:
+// the header ends with "Data: ", each byte i is then written as "%02X " of (byte ^ key[i % 16])
+String encryptedFileHeader();
+void xorKeyMD5(const String &password, uint8_t key[16], const int MD5_PASSES = 10);
+
 String decryptString(String &cypertext, const String &password_str);
 
 String readDecryptedFile(FS &fs, String filepath);
@@ -30,6 +30,7 @@ void checkPowerSaveTime() {
 }
 
 void sleepModeOn() {
+    bruceConfig.flush();
     isSleeping = true;
     setCpuFrequencyMhz(80);
 
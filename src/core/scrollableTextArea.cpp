@@ -1,9 +1,94 @@
 #include "scrollableTextArea.h"
+#include "mykeyboard.h"
 #define _scrollBuffer tft
+
+/*
+ * Splits a file in display rows the same way addLine splits a line, reading
+ * it through a small buffer. Used to build the index and to read rows back.
+ */
+class TextRowReader {
+public:
+    TextRowReader(File &file, uint16_t rowChars, bool indent)
+        : _file(file), _rowChars(rowChars), _indent(indent) {}
+
+    void seek(const TextRowPos &pos) {
+        _file.seek(pos.offset);
+        _pos = _len = 0;
+        _at = pos;
+    }
+    TextRowPos tell() { return _at; }
+
+    // Reads the next row into "row" (when not NULL), false at the end of the file
+    bool next(String *row) {
+        if (peek(0) < 0) return false;
+        size_t max = _rowChars;
+        if (row) *row = "";
+        if (_at.midLine && _indent) {
+            max--;
+            if (row) *row = " ";
+        }
+
+        bool lineEnd = false;
+        for (size_t n = 0; n < max;) {
+            int c = get();
+            if (c < 0 || c == '\n') {
+                lineEnd = true;
+                break;
+            }
+            if (c == '\r' && peek(0) == '\n') continue;
+            if (row) *row += (char)c;
+            n++;
+        }
+        // A full row right before the end of its line doesn't leave an empty row behind
+        if (!lineEnd && peek(0) == '\r' && peek(1) == '\n') get();
+        if (!lineEnd && peek(0) == '\n') {
+            get();
+            lineEnd = true;
+        }
+        if (lineEnd || peek(0) < 0) {
+            _at.line++;
+            _at.midLine = false;
+        } else {
+            _at.midLine = true;
+        }
+        return true;
+    }
+
+private:
+    File &_file;
+    uint16_t _rowChars;
+    bool _indent;
+    uint8_t _buf[512];
+    size_t _pos = 0;
+    size_t _len = 0;
+    TextRowPos _at = {0, 0, false};
+
+    int peek(size_t ahead) {
+        if (_pos + ahead >= _len) {
+            // Keep the bytes not read yet, then fill the rest of the buffer
+            memmove(_buf, _buf + _pos, _len - _pos);
+            _len -= _pos;
+            _pos = 0;
+            int got = _file.read(_buf + _len, sizeof(_buf) - _len);
+            if (got > 0) _len += got;
+            if (ahead >= _len) return -1;
+        }
+        return _buf[_pos + ahead];
+    }
+    int get() {
+        int c = peek(0);
+        if (c >= 0) {
+            _pos++;
+            _at.offset++;
+        }
+        return c;
+    }
+};
+
 ScrollableTextArea::ScrollableTextArea(const String &title)
     : firstVisibleLine{0}, _redraw{true}, _title(title), _fontSize(FP), _startX(BORDER_PAD_X),
       _startY(BORDER_PAD_Y), _width(tftWidth - 2 * BORDER_PAD_X),
-      _height(tftHeight - BORDER_PAD_X - BORDER_PAD_Y) {
+      _height(tftHeight - BORDER_PAD_X - BORDER_PAD_Y), _indentWrappedLines(false), _drawBorders(true) {
     drawMainBorder();
 
     if (!_title.isEmpty()) {
@@ -20,13 +105,14 @@ ScrollableTextArea::ScrollableTextArea(
     bool indentWrappedLines
 )
     : firstVisibleLine{0}, _redraw{true}, _title(""), _fontSize(fontSize), _startX(startX), _startY(startY),
-      _width(width), _height(height), _indentWrappedLines(indentWrappedLines) {
+      _width(width), _height(height), _indentWrappedLines(indentWrappedLines), _drawBorders(drawBorders) {
     if (drawBorders) { drawMainBorder(); }
     setup();
 }
 
 ScrollableTextArea::~ScrollableTextArea() {
     // We don't use Sprites for big things, unfortunetly theres no much RAM in all devices
+    if (_file) _file.close();
 }
 
 void ScrollableTextArea::setup() {
@@ -47,7 +133,8 @@ void ScrollableTextArea::scrollUp() {
 }
 
 void ScrollableTextArea::scrollDown() {
-    if (firstVisibleLine + _maxVisibleLines <= linesBuffer.size()) {
+    if (_file) indexRows(firstVisibleLine + _maxVisibleLines + 1);
+    if (firstVisibleLine + _maxVisibleLines <= rowCount()) {
         if (firstVisibleLine == 0) firstVisibleLine++;
         firstVisibleLine++;
         _redraw = true;
@@ -55,21 +142,37 @@ void ScrollableTextArea::scrollDown() {
 }
 
 void ScrollableTextArea::scrollToLine(size_t lineNumber) {
-    if (linesBuffer.empty()) return; // Ensure there's content to scroll
+    if (_file) indexRows(lineNumber + _maxVisibleLines);
+    size_t rows = rowCount();
+    if (rows == 0) return; // Ensure there's content to scroll
 
-    if (lineNumber > linesBuffer.size() - _maxVisibleLines) {
-        firstVisibleLine =
-            (linesBuffer.size() > _maxVisibleLines) ? linesBuffer.size() - _maxVisibleLines : 0;
+    if (lineNumber > rows - _maxVisibleLines) {
+        firstVisibleLine = (rows > _maxVisibleLines) ? rows - _maxVisibleLines : 0;
     } else {
         firstVisibleLine = lineNumber;
     }
+    _redraw = true;
 }
 
 String ScrollableTextArea::getLine(size_t lineNumber) {
+    if (_file) return row(lineNumber);
     return linesBuffer[(lineNumber >= linesBuffer.size()) ? linesBuffer.size() : lineNumber];
 }
 
-size_t ScrollableTextArea::getMaxLines() { return linesBuffer.size(); }
+size_t ScrollableTextArea::getMaxLines() { return rowCount(); }
+
+size_t ScrollableTextArea::rowCount() { return _file ? _rows : linesBuffer.size(); }
+
+const String &ScrollableTextArea::row(size_t idx) {
+    static const String empty = "";
+    if (!_file) return idx < linesBuffer.size() ? linesBuffer[idx] : empty;
+    if (idx < _windowFirst || idx >= _windowFirst + _window.size()) {
+        // Starts a screen above, so scrolling back up doesn't read the file again right away
+        loadWindow(idx > _maxVisibleLines ? idx - _maxVisibleLines : 0);
+    }
+    if (idx < _windowFirst || idx >= _windowFirst + _window.size()) return empty;
+    return _window[idx - _windowFirst];
+}
 
 void ScrollableTextArea::show(bool force) {
     draw(force);
@@ -78,7 +181,12 @@ void ScrollableTextArea::show(bool force) {
         update(force);
         yield();
     }
-    while (!check(SelPress)) {
+    while (true) {
+        if (_file) {
+            if (check(EscPress) || (check(SelPress) && !fileMenu())) break;
+        } else if (check(SelPress)) {
+            break;
+        }
         update(force);
         yield();
     }
@@ -91,6 +199,8 @@ void ScrollableTextArea::update(bool force) {
     else if (check(NextPress) || check(DownPress)) scrollDown();
 
     draw(force);
+    // A bit more of the file is indexed on every pass, so the number of rows is known in the end
+    if (_file) indexRows(SIZE_MAX, TEXT_AREA_INDEX_CHUNK);
 }
 
 void ScrollableTextArea::fromFile(File file) {
@@ -102,9 +212,195 @@ void ScrollableTextArea::fromFile(File file) {
     draw(true);
 }
 
+/*********************************************************************
+**  Function: openFile
+**  Index the first screens of the file, the rest is indexed while viewing
+**********************************************************************/
+bool ScrollableTextArea::openFile(FS &fs, const String &path) {
+    clear();
+    _file = fs.open(path, FILE_READ);
+    if (!_file) return false;
+    _indexDone = false;
+    indexRows(2 * _maxVisibleLines + 1);
+    draw(true);
+    delay(100);
+    draw(true);
+    return true;
+}
+
+/*********************************************************************
+**  Function: indexRows
+**  Read the file on from the end of the index, until "untilRow" rows are
+**  known or maxBytes were read
+**********************************************************************/
+void ScrollableTextArea::indexRows(size_t untilRow, uint32_t maxBytes) {
+    if (_indexDone || _rows >= untilRow) return;
+    TextRowReader reader(_file, _maxCharactersPerLine, _indentWrappedLines);
+    reader.seek(_indexEnd);
+    uint32_t stop = maxBytes == UINT32_MAX ? UINT32_MAX : _indexEnd.offset + maxBytes;
+
+    while (_rows < untilRow && reader.tell().offset < stop) {
+        TextRowPos pos = reader.tell();
+        if (!reader.next(NULL)) {
+            _indexDone = true;
+            break;
+        }
+        if (_rows % _indexStep == 0) {
+            if (_index.size() >= TEXT_AREA_INDEX_MAX) {
+                // Keep every other entry, the index stays the same size for any file
+                for (size_t i = 0; i < _index.size() / 2; i++) _index[i] = _index[i * 2];
+                _index.resize(_index.size() / 2);
+                _indexStep *= 2;
+            }
+            if (_rows % _indexStep == 0) _index.push_back(pos);
+        }
+        _rows++;
+    }
+    _indexEnd = reader.tell();
+    if (_indexDone) log_i("TextArea: %u rows, index of %u entries", _rows, _index.size());
+}
+
+void ScrollableTextArea::loadWindow(size_t first) {
+    _window.clear();
+    _windowFirst = first;
+    if (first >= _rows) return;
+
+    TextRowReader reader(_file, _maxCharactersPerLine, _indentWrappedLines);
+    reader.seek(_index[first / _indexStep]);
+    for (size_t i = first - first % _indexStep; i < first; i++) reader.next(NULL);
+
+    String text;
+    while (_window.size() < 3 * _maxVisibleLines && _windowFirst + _window.size() < _rows &&
+           reader.next(&text)) {
+        _window.push_back(text);
+    }
+}
+
+/*********************************************************************
+**  Function: findRow
+**  Row where a line of the file starts (byLine), or row holding a byte
+**  offset of the file. Indexes the file up to there if needed.
+**********************************************************************/
+size_t ScrollableTextArea::findRow(bool byLine, uint32_t value) {
+    while (!_indexDone && (byLine ? _indexEnd.line <= value : _indexEnd.offset <= value)) {
+        indexRows(SIZE_MAX, TEXT_AREA_INDEX_CHUNK);
+    }
+    if (_index.empty()) return 0;
+
+    size_t entry = 0;
+    while (entry + 1 < _index.size()) {
+        TextRowPos &pos = _index[entry + 1];
+        bool before = byLine ? pos.line < value || (pos.line == value && !pos.midLine) : pos.offset <= value;
+        if (!before) break;
+        entry++;
+    }
+
+    TextRowReader reader(_file, _maxCharactersPerLine, _indentWrappedLines);
+    reader.seek(_index[entry]);
+    size_t row = entry * _indexStep;
+    while (row + 1 < _rows) {
+        if (byLine && reader.tell().line >= value) break;
+        reader.next(NULL);
+        if (!byLine && reader.tell().offset > value) break;
+        row++;
+    }
+    return row;
+}
+
+size_t ScrollableTextArea::gotoFileLine(size_t line) {
+    size_t found = findRow(true, line);
+    scrollToLine(found);
+    return found;
+}
+
+bool ScrollableTextArea::findInFile(const String &query, size_t fromRow) {
+    if (!_file || query.isEmpty() || fromRow >= _rows) return false;
+    String q = query;
+    q.toLowerCase();
+    size_t n = q.length();
+
+    // Start of fromRow, then a byte by byte compare of the last n bytes read
+    TextRowReader reader(_file, _maxCharactersPerLine, _indentWrappedLines);
+    reader.seek(_index[fromRow / _indexStep]);
+    for (size_t i = fromRow - fromRow % _indexStep; i < fromRow; i++) reader.next(NULL);
+    uint32_t offset = reader.tell().offset;
+    _file.seek(offset);
+
+    std::vector<char> last(n);
+    size_t seen = 0;
+    uint8_t buf[512];
+    int len;
+    while ((len = _file.read(buf, sizeof(buf))) > 0) {
+        for (int i = 0; i < len; i++) {
+            last[seen++ % n] = tolower(buf[i]);
+            offset++;
+            if (seen < n || last[(seen - 1) % n] != q[n - 1]) continue;
+            size_t k = 0;
+            while (k < n && last[(seen - n + k) % n] == q[k]) k++;
+            if (k == n) {
+                scrollToLine(findRow(false, offset - n));
+                return true;
+            }
+        }
+        if (check(EscPress)) break;
+    }
+    return false;
+}
+
+/*********************************************************************
+**  Function: fileMenu
+**  Options of a file view, false when the view must be closed
+**********************************************************************/
+bool ScrollableTextArea::fileMenu() {
+    bool keepOpen = true;
+    auto search = [&](size_t fromRow) {
+        displayTextLine("Searching...");
+        if (!findInFile(_query, fromRow)) displayInfo("Not found", true);
+    };
+    std::vector<Option> menu = {
+        {"Go to line",
+         [&]() {
+             String line = num_keyboard("", 10, "Line number:");
+             if (line != "\x1B" && line.toInt() > 0) gotoFileLine(line.toInt() - 1);
+         }},
+        {"Search",
+         [&]() {
+             String query = keyboard(_query, 64, "Search:");
+             if (query == "\x1B" || query.isEmpty()) return;
+             _query = query;
+             search(firstVisibleLine);
+         }},
+    };
+    if (!_query.isEmpty()) {
+        menu.push_back({"Next \"" + _query + "\"", [&]() { search(firstVisibleLine + 1); }});
+    }
+    menu.push_back({"Top", [&]() { scrollToLine(0); }});
+    menu.push_back({"Bottom", [&]() {
+                        indexRows(SIZE_MAX);
+                        scrollToLine(_rows);
+                    }});
+    menu.push_back({"Close", [&]() { keepOpen = false; }});
+    loopOptions(menu, MENU_TYPE_SUBMENU, "View file");
+
+    if (keepOpen) {
+        if (_drawBorders) drawMainBorder();
+        if (!_title.isEmpty()) printTitle(_title);
+        draw(true);
+    }
+    return keepOpen;
+}
+
 void ScrollableTextArea::clear() {
     firstVisibleLine = 0;
     linesBuffer.clear();
+    if (_file) _file.close();
+    _index.clear();
+    _indexStep = TEXT_AREA_INDEX_STEP;
+    _rows = 0;
+    _indexEnd = {0, 0, false};
+    _indexDone = true;
+    _window.clear();
+    _windowFirst = 0;
 }
 
 void ScrollableTextArea::fromString(const String &text) {
@@ -158,6 +454,7 @@ void ScrollableTextArea::addLine(const String &text) {
 
 void ScrollableTextArea::draw(bool force) {
     if (!_redraw && !force) return;
+    tft.beginFrame("scrollText");
 
     _scrollBuffer.fillRect(_startX, _startY, _width, _height, bruceConfig.bgColor);
     _scrollBuffer.setTextColor(bruceConfig.priColor);
@@ -175,16 +472,17 @@ void ScrollableTextArea::draw(bool force) {
     }
 
     int32_t tmpHeight = _height;
+    if (_file) indexRows(firstVisibleLine + _maxVisibleLines + 1);
     // if there is text below
-    if (linesBuffer.size() - firstVisibleLine >= _maxVisibleLines) {
+    if (rowCount() - firstVisibleLine >= _maxVisibleLines) {
         _scrollBuffer.drawString("...", 0 + _startX, _startY + _height - _pixelsPerLine);
         tmpHeight -= _pixelsPerLine;
         lines++;
     }
 
     size_t idx{firstVisibleLine};
-    while (yOffset < tmpHeight && lines < _maxVisibleLines && idx < linesBuffer.size()) {
-        _scrollBuffer.drawString(linesBuffer[idx], 0 + _startX, _startY + yOffset);
+    while (yOffset < tmpHeight && lines < _maxVisibleLines && idx < rowCount()) {
+        _scrollBuffer.drawString(row(idx), 0 + _startX, _startY + yOffset);
         yOffset += _pixelsPerLine;
         lines++;
         idx++;
@@ -194,4 +492,5 @@ void ScrollableTextArea::draw(bool force) {
     tft.setTextFont(_fSize);
 
     _redraw = false;
+    tft.endFrame();
 }
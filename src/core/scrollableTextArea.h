@@ -1,5 +1,24 @@
 #include "display.h"
 
+// Rows between two entries of the file index, doubled each time the index is full
+#ifndef TEXT_AREA_INDEX_STEP
+#define TEXT_AREA_INDEX_STEP 32
+#endif
+#ifndef TEXT_AREA_INDEX_MAX
+#define TEXT_AREA_INDEX_MAX 512
+#endif
+// Bytes of the file indexed on each update() while it is viewed
+#ifndef TEXT_AREA_INDEX_CHUNK
+#define TEXT_AREA_INDEX_CHUNK 4096
+#endif
+
+// Start of a display row in a file
+struct TextRowPos {
+    uint32_t offset;
+    uint32_t line; // line of the file, from 0
+    bool midLine;  // the row continues a wrapped line
+};
+
 class ScrollableTextArea {
 public:
     ScrollableTextArea(const String &title = "");
@@ -28,6 +47,18 @@ public:
 
     void fromFile(File file);
 
+    /*
+     * Views the file without loading it: the rows are read from the file when
+     * they are drawn, and an index with a row position every few rows is built
+     * while the file is viewed. In show(), Sel opens a menu to go to a line or
+     * search, Esc closes the file.
+     */
+    bool openFile(FS &fs, const String &path);
+    // Scrolls to a line of the file (from 0), returns the row where it starts
+    size_t gotoFileLine(size_t line);
+    // Scrolls to the next occurrence of query (any case) from the start of fromRow, false if none
+    bool findInFile(const String &query, size_t fromRow);
+
     void draw(bool force = false);
 
     void show(bool force = false);
@@ -49,8 +80,27 @@ private:
     size_t _maxVisibleLines;
     uint16_t _maxCharactersPerLine;
     bool _indentWrappedLines;
+    bool _drawBorders;
+
+    // File-backed mode, see openFile
+    File _file;
+    std::vector<TextRowPos> _index; // position of every _indexStep rows
+    size_t _indexStep = TEXT_AREA_INDEX_STEP;
+    size_t _rows = 0;                     // rows found so far in the file
+    TextRowPos _indexEnd = {0, 0, false}; // where the indexing goes on
+    bool _indexDone = true;
+    std::vector<String> _window; // rows read from the file, from _windowFirst
+    size_t _windowFirst = 0;
+    String _query;
 
     void setup();
 
     void update(bool force = false);
+
+    size_t rowCount();
+    const String &row(size_t idx);
+    void indexRows(size_t untilRow, uint32_t maxBytes = UINT32_MAX);
+    void loadWindow(size_t first);
+    size_t findRow(bool byLine, uint32_t value);
+    bool fileMenu();
 };
@@ -1,4 +1,7 @@
 #include "sd_functions.h"
+#include "copy_engine.h"
+#include "dir_cursor.h"
+#include "file_index.h"
 #include "display.h" // using displayRedStripe as error msg
 #include "modules/badusb_ble/ducky_typer.h"
 #include "modules/bjs_interpreter/interpreter.h"
@@ -16,10 +19,10 @@
 #include <MD5Builder.h>
 #include <algorithm>       // for std::sort
 #include <esp32/rom/crc.h> // for CRC32
+#include <mbedtls/sha256.h>
 
 // SPIClass sdcardSPI;
 String fileToCopy;
-std::vector<FileList> fileList;
 
 /***************************************************************************************
 ** Function name: setupSdCard
@@ -86,6 +89,8 @@ bool setupSdCard() {
     } else {
         Serial.println("SDCARD mounted successfully");
         sdcardMounted = true;
+        // First mount of this card, index it while it's being used
+        if (!SD.exists(FILE_INDEX_PATH)) fileIndexFor(SD)->rebuild(true);
         return true;
     }
 }
@@ -95,6 +100,7 @@ bool setupSdCard() {
 ** Description:   Turn Off SDCard, set sdcardMounted state to false
 ***************************************************************************************/
 void closeSdCard() {
+    fileIndexFor(SD)->unload();
     SD.end();
     Serial.println("SD Card Unmounted...");
     sdcardMounted = false;
@@ -114,6 +120,29 @@ bool ToggleSDCard() {
         return sdcardMounted;
     }
 }
+/***************************************************************************************
+** Function name: fileChanged
+** Description:   tell the listeners that a file was written or removed
+***************************************************************************************/
+// Plain array, so listeners can register from static initializers in any order
+static FileChangeCb fileChangeListeners[FILE_CHANGE_LISTENERS];
+
+bool addFileChangeListener(FileChangeCb cb) {
+    for (auto &listener : fileChangeListeners) {
+        if (listener == NULL || listener == cb) {
+            listener = cb;
+            return true;
+        }
+    }
+    return false;
+}
+
+void fileChanged(FS &fs, const String &path, bool removed) {
+    for (auto listener : fileChangeListeners) {
+        if (listener) listener(fs, path, removed);
+    }
+}
+
 /***************************************************************************************
 ** Function name: deleteFromSd
 ** Description:   delete file or folder
@@ -122,8 +151,11 @@ bool deleteFromSd(FS fs, String path) {
     File dir = fs.open(path);
     if (!dir.isDirectory()) {
         dir.close();
+        fileChanged(fs, path, true);
         return fs.remove(path);
     }
+    // Removing the folder removes its files from the index
+    fileChanged(fs, path, true);
 
     dir.rewindDirectory();
     bool success = true;
@@ -153,22 +185,42 @@ bool deleteFromSd(FS fs, String path) {
 ***************************************************************************************/
 bool renameFile(FS fs, String path, String filename) {
     String newName = keyboard(filename, 76, "Type the new Name:");
+    String newPath = path.substring(0, path.lastIndexOf('/')) + "/" + newName;
     // Rename the file of folder
-    if (fs.rename(path, path.substring(0, path.lastIndexOf('/')) + "/" + newName)) {
+    if (fs.rename(path, newPath)) {
         // Serial.println("Renamed from " + filename + " to " + newName);
+        fileChanged(fs, path, true);
+        fileChanged(fs, newPath);
         return true;
     } else {
         // Serial.println("Fail on rename.");
         return false;
     }
 }
+/***************************************************************************************
+** Function name: drawCopyProgress
+** Description:   progress arc for copyToFs and pasteFile
+***************************************************************************************/
+static void drawCopyProgress(uint64_t done, uint64_t total) {
+    if (total == 0) return;
+    tft.drawArc(
+        tftWidth / 2,
+        tftHeight / 2,
+        tftHeight / 4,
+        tftHeight / 5,
+        0,
+        int(360 * done / total),
+        ALCOLOR,
+        bruceConfig.bgColor,
+        true
+    );
+}
+
 /***************************************************************************************
 ** Function name: copyToFs
-** Description:   copy file from SD or LittleFS to LittleFS or SD
+** Description:   copy file or folder from SD or LittleFS to LittleFS or SD
 ***************************************************************************************/
-bool copyToFs(FS from, FS to, String path, bool draw) {
-    // Using Global Buffer
-    bool result = false;
+bool copyToFs(FS &from, FS &to, String path, bool draw) {
     if (!sdcardMounted) {
         if (!setupSdCard()) {
             sdcardMounted = false;
@@ -182,136 +234,53 @@ bool copyToFs(FS from, FS to, String path, bool draw) {
         return false;
     }
 
-    File source = from.open(path, FILE_READ);
-    if (!source) {
+    if (!from.exists(path)) {
         Serial.println("Fail opening Source file");
         return false;
     }
-    path = path.substring(path.lastIndexOf('/'));
-    if (!path.startsWith("/")) path = "/" + path;
-    File dest = to.open(path, FILE_WRITE);
-    if (!dest) {
-        Serial.println("Fail creating destination file");
-        return false;
-    }
-    size_t bytesRead;
-    int tot = source.size();
-    int prog = 0;
+    String dest = path.substring(path.lastIndexOf('/'));
+    if (!dest.startsWith("/")) dest = "/" + dest;
 
-    if (&to == &LittleFS && (LittleFS.totalBytes() - LittleFS.usedBytes()) < tot) {
+    if (&to == &LittleFS && (LittleFS.totalBytes() - LittleFS.usedBytes()) < pathSize(from, path)) {
         displayError("Not enought space", true);
         return false;
     }
-    const int bufSize = 1024;
-    uint8_t buff[1024] = {0};
-    // tft.drawRect(5,tftHeight-12, (tftWidth-10), 9, bruceConfig.priColor);
-    while ((bytesRead = source.read(buff, bufSize)) > 0) {
-        if (dest.write(buff, bytesRead) != bytesRead) {
-            // Serial.println("Falha ao escrever no arquivo de destino");
-            source.close();
-            dest.close();
-            Serial.println("Error 5");
-            return false;
-        } else {
-            prog += bytesRead;
-            float rad = 360 * prog / tot;
-            if (draw)
-                tft.drawArc(
-                    tftWidth / 2,
-                    tftHeight / 2,
-                    tftHeight / 4,
-                    tftHeight / 5,
-                    0,
-                    int(rad),
-                    ALCOLOR,
-                    bruceConfig.bgColor,
-                    true
-                );
-        }
-    }
-    if (prog == tot) result = true;
-    else {
+
+    bool copied = copyPath(from, path, to, dest, draw ? drawCopyProgress : NULL);
+    // Also when it failed, some files may have been copied
+    fileChanged(to, dest);
+    if (!copied) {
         displayError("Fail Copying File", true);
         return false;
     }
-
-    return result;
+    return true;
 }
 
 /***************************************************************************************
 ** Function name: copyFile
-** Description:   copy file address to memory
+** Description:   copy file or folder address to memory
 ***************************************************************************************/
 bool copyFile(FS fs, String path) {
-    File file = fs.open(path, FILE_READ);
-    if (!file.isDirectory()) {
-        fileToCopy = path;
-        file.close();
-        return true;
-    } else {
-        displayRedStripe("Cannot copy Folder");
-        file.close();
-        return false;
-    }
+    if (!fs.exists(path)) return false;
+    fileToCopy = path;
+    return true;
 }
 
 /***************************************************************************************
 ** Function name: pasteFile
-** Description:   paste file to new folder
+** Description:   paste file or folder to new folder
 ***************************************************************************************/
 bool pasteFile(FS fs, String path) {
-    // Using Global Buffer
-
-    // Abrir o arquivo original
-    File sourceFile = fs.open(fileToCopy, FILE_READ);
-    if (!sourceFile) {
-        // Serial.println("Falha ao abrir o arquivo original para leitura");
+    String dest = path + (path.endsWith("/") ? "" : "/");
+    dest += fileToCopy.substring(fileToCopy.lastIndexOf('/') + 1);
+    // Pasting over itself would truncate the source, and into itself would never end
+    if (dest == fileToCopy || dest.startsWith(fileToCopy + "/")) {
+        displayError("Can't paste here", true);
         return false;
     }
-
-    // Criar o arquivo de destino
-    File destFile = fs.open(path + "/" + fileToCopy.substring(fileToCopy.lastIndexOf('/') + 1), FILE_WRITE);
-    if (!destFile) {
-        // Serial.println("Falha ao criar o arquivo de destino");
-        sourceFile.close();
-        return false;
-    }
-
-    // Ler dados do arquivo original e escrever no arquivo de destino
-    size_t bytesRead;
-    int tot = sourceFile.size();
-    int prog = 0;
-    const int bufSize = 1024;
-    uint8_t buff[1024] = {0};
-    // tft.drawRect(5,tftHeight-12, (tftWidth-10), 9, bruceConfig.priColor);
-    while ((bytesRead = sourceFile.read(buff, bufSize)) > 0) {
-        if (destFile.write(buff, bytesRead) != bytesRead) {
-            // Serial.println("Falha ao escrever no arquivo de destino");
-            sourceFile.close();
-            destFile.close();
-            return false;
-        } else {
-            prog += bytesRead;
-            float rad = 360 * prog / tot;
-            tft.drawArc(
-                tftWidth / 2,
-                tftHeight / 2,
-                tftHeight / 4,
-                tftHeight / 5,
-                0,
-                int(rad),
-                ALCOLOR,
-                bruceConfig.bgColor,
-                true
-            );
-            // tft.fillRect(7,tftHeight-10, (tftWidth-14)*prog/tot, 5, bruceConfig.priColor);
-        }
-    }
-
-    // Fechar ambos os arquivos
-    sourceFile.close();
-    destFile.close();
-    return true;
+    bool copied = copyPath(fs, fileToCopy, fs, dest, drawCopyProgress);
+    fileChanged(fs, dest);
+    return copied;
 }
 
 /***************************************************************************************
@@ -327,6 +296,59 @@ bool createFolder(FS fs, String path) {
     return true;
 }
 
+/***************************************************************************************
+** Function name: replaceFile
+** Description:   rename tmpPath over path. LittleFS renames over an existing file, FAT
+**                needs the target removed first: from then on tmpPath is the only copy
+**                and it is kept if the rename fails, recoverTmpFile() puts it back
+***************************************************************************************/
+bool replaceFile(FS &fs, const String &tmpPath, const String &path) {
+    if (fs.rename(tmpPath, path)) return true;
+    if (fs.exists(path) && !fs.remove(path)) {
+        fs.remove(tmpPath); // the old content is still there
+        return false;
+    }
+    if (fs.rename(tmpPath, path) || fs.rename(tmpPath, path)) return true;
+    log_e("Failed to rename %s, keeping it", tmpPath.c_str());
+    return false;
+}
+
+/***************************************************************************************
+** Function name: recoverTmpFile
+** Description:   finish a replaceFile() that lost path and kept path.tmp
+***************************************************************************************/
+bool recoverTmpFile(FS &fs, const String &path) {
+    String tmpPath = path + ".tmp";
+    if (fs.exists(path) || !fs.exists(tmpPath)) return false;
+    log_i("Recovering %s from %s", path.c_str(), tmpPath.c_str());
+    return fs.rename(tmpPath, path);
+}
+
+/***************************************************************************************
+** Function name: writeFileAtomic
+** Description:   replace a file with new content through a temporary file
+***************************************************************************************/
+bool writeFileAtomic(FS &fs, const String &path, const uint8_t *data, size_t len) {
+    // A kept path.tmp may be the only copy, don't truncate it before it is back in place
+    recoverTmpFile(fs, path);
+
+    String tmpPath = path + ".tmp";
+    File file = fs.open(tmpPath, FILE_WRITE);
+    if (!file) return false;
+    size_t written = file.write(data, len);
+    file.close();
+
+    if (written != len) {
+        fs.remove(tmpPath);
+        return false;
+    }
+    return replaceFile(fs, tmpPath, path);
+}
+
+bool writeFileAtomic(FS &fs, const String &path, const String &content) {
+    return writeFileAtomic(fs, path, (const uint8_t *)content.c_str(), content.length());
+}
+
 /**********************************************************************
 **  Function: readLineFromFile
 **  Read the line of the config file until the ';'
@@ -414,44 +436,87 @@ size_t getFileSize(FS &fs, String filepath) {
     return fileSize;
 }
 
-String md5File(FS &fs, String filepath) {
-    if (!fs.exists(filepath)) return "";
-    String txt = readSmallFile(fs, filepath);
+/***************************************************************************************
+** Function name: hashFile
+** Description:   hash a file of any size, reading it in HASH_FILE_CHUNK blocks
+**                progress, if set, is called along the way (ex: to feed a watchdog)
+**                returns the digest in hex or an empty string on error
+***************************************************************************************/
+String hashFile(FS &fs, String filepath, FileHashType type, void (*progress)(size_t done, size_t total)) {
+    File file = fs.open(filepath, FILE_READ);
+    if (!file) return "";
+    if (file.isDirectory()) {
+        file.close();
+        return "";
+    }
+
+    // Internal RAM is faster than PSRAM for the hashing loop and DMA-able for the SD driver
+    uint8_t stackBuf[512];
+    size_t bufSize = HASH_FILE_CHUNK;
+    uint8_t *buf = (uint8_t *)heap_caps_malloc(bufSize, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (buf == NULL) {
+        buf = stackBuf;
+        bufSize = sizeof(stackBuf);
+    }
+
     MD5Builder md5;
-    md5.begin();
-    md5.add(txt);
-    md5.calculate();
-    return (md5.toString());
+    mbedtls_sha256_context sha;
+    uint32_t crc = 0;
+    if (type == HASH_MD5) md5.begin();
+    if (type == HASH_SHA256) {
+        // uses the SHA peripheral when the IDF is built with MBEDTLS_HARDWARE_SHA
+        mbedtls_sha256_init(&sha);
+        mbedtls_sha256_starts_ret(&sha, 0);
+    }
+
+    size_t fileSize = file.size();
+    size_t done = 0;
+    size_t bytesRead;
+    if (progress) progress(0, fileSize);
+    while ((bytesRead = file.read(buf, bufSize)) > 0) {
+        if (type == HASH_MD5) md5.add(buf, bytesRead);
+        else if (type == HASH_CRC32) crc = crc32_le(crc, buf, bytesRead);
+        else mbedtls_sha256_update_ret(&sha, buf, bytesRead);
+        done += bytesRead;
+        // every 64 chunks is a few hundred ms on SD
+        if (progress && (done / bufSize) % 64 == 0) progress(done, fileSize);
+    }
+    file.close();
+    if (buf != stackBuf) free(buf);
+    if (progress) progress(done, fileSize);
+
+    if (type == HASH_MD5) {
+        md5.calculate();
+        return md5.toString();
+    }
+    if (type == HASH_CRC32) {
+        char s[9];
+        snprintf(s, sizeof(s), "%08lX", crc);
+        return String(s);
+    }
+    uint8_t digest[32];
+    mbedtls_sha256_finish_ret(&sha, digest);
+    mbedtls_sha256_free(&sha);
+    char s[sizeof(digest) * 2 + 1];
+    for (size_t i = 0; i < sizeof(digest); i++) sprintf(s + i * 2, "%02x", digest[i]);
+    return String(s);
 }
 
-String crc32File(FS &fs, String filepath) {
+static void hashProgress(size_t done, size_t total) { progressHandler(done, total, "Hashing"); }
+
+String md5File(FS &fs, String filepath, bool draw) {
     if (!fs.exists(filepath)) return "";
-    String txt = readSmallFile(fs, filepath);
-    // derived from
-    // https://techoverflow.net/2022/08/05/how-to-compute-crc32-with-ethernet-polynomial-0x04c11db7-on-esp32-crc-h/
-    uint32_t romCRC =
-        (~crc32_le((uint32_t)~(0xffffffff), (const uint8_t *)txt.c_str(), txt.length())) ^ 0xffffffff;
-    char s[18] = {0};
-    char crcBytes[4] = {0};
-    memcpy(crcBytes, &romCRC, sizeof(uint32_t));
-    snprintf(s, sizeof(s), "%02X%02X%02X%02X\n", crcBytes[3], crcBytes[2], crcBytes[1], crcBytes[0]);
-    return (String(s));
+    return hashFile(fs, filepath, HASH_MD5, draw ? hashProgress : NULL);
 }
 
-/***************************************************************************************
-** Function name: sortList
-** Description:   sort files for name
-***************************************************************************************/
-bool sortList(const FileList &a, const FileList &b) {
-    if (a.folder != b.folder) {
-        return a.folder > b.folder; // true if a is a folder and b is not
-    }
-    // Order items alfabetically
-    String fa = a.filename.c_str();
-    fa.toUpperCase();
-    String fb = b.filename.c_str();
-    fb.toUpperCase();
-    return fa < fb;
+String crc32File(FS &fs, String filepath, bool draw) {
+    if (!fs.exists(filepath)) return "";
+    return hashFile(fs, filepath, HASH_CRC32, draw ? hashProgress : NULL);
+}
+
+String sha256File(FS &fs, String filepath, bool draw) {
+    if (!fs.exists(filepath)) return "";
+    return hashFile(fs, filepath, HASH_SHA256, draw ? hashProgress : NULL);
 }
 
 /***************************************************************************************
@@ -478,50 +543,44 @@ bool checkExt(String ext, String pattern) {
     return ext == lastExt;
 }
 
-/***************************************************************************************
-** Function name: sortList
-** Description:   sort files for name
-***************************************************************************************/
-void readFs(FS fs, String folder, String allowed_ext) {
-    int allFilesCount = 0;
-    fileList.clear();
-    FileList object;
-
-    File root = fs.open(folder);
-    if (!root || !root.isDirectory()) { return; }
-    File file = root.openNextFile();
-    while (file && fileList.size() < 250) {
-        String fileName = file.name();
-        if (file.isDirectory()) {
-            object.filename = fileName.substring(fileName.lastIndexOf("/") + 1);
-            object.folder = true;
-            object.operation = false;
-            fileList.push_back(object);
-        } else {
-            String ext = fileName.substring(fileName.lastIndexOf(".") + 1);
-            if (allowed_ext == "*" || checkExt(ext, allowed_ext)) {
-                object.filename = fileName.substring(fileName.lastIndexOf("/") + 1);
-                object.folder = false;
-                object.operation = false;
-                fileList.push_back(object);
-            }
+// Selected entry of the last folders visited, so going back lands where you were
+struct FolderPosition {
+    FS *fs;
+    String folder;
+    int index;
+};
+static std::vector<FolderPosition> folderPositions;
+#define FOLDER_POSITIONS_MAX 16
+
+static void rememberFolderPosition(FS &fs, const String &folder, int index) {
+    for (auto it = folderPositions.begin(); it != folderPositions.end(); it++) {
+        if (it->fs == &fs && it->folder == folder) {
+            folderPositions.erase(it);
+            break;
         }
-        file = root.openNextFile();
     }
-    file.close();
-    root.close();
-
-    // Sort folders/files
-    std::sort(fileList.begin(), fileList.end(), sortList);
-
-    Serial.println("Files listed with: " + String(fileList.size()) + " files/folders found");
+    folderPositions.insert(folderPositions.begin(), {&fs, folder, index});
+    if (folderPositions.size() > FOLDER_POSITIONS_MAX) folderPositions.pop_back();
+}
 
-    // Adds Operational btn at the botton
-    object.filename = "> Back";
-    object.folder = false;
-    object.operation = true;
+static int recallFolderPosition(FS &fs, const String &folder) {
+    for (auto &position : folderPositions) {
+        if (position.fs == &fs && position.folder == folder) return position.index;
+    }
+    return 0;
+}
 
-    fileList.push_back(object);
+// Select filepath the next time its folder is listed, returns the folder
+static String selectInFolder(FS &fs, const String &filepath, const String &allowed_ext) {
+    String folder = filepath.substring(0, filepath.lastIndexOf('/'));
+    if (folder == "") folder = "/";
+    DirCursor cursor;
+    int index = -1;
+    if (cursor.open(fs, folder, allowed_ext)) {
+        index = cursor.indexOf(filepath.substring(filepath.lastIndexOf('/') + 1));
+    }
+    rememberFolderPosition(fs, folder, max(index, 0));
+    return folder;
 }
 
 /*********************************************************************
@@ -561,9 +620,12 @@ String loopSD(FS &fs, bool filePicker, String allowed_ext, String rootPath) {
     bool exit = false;
     // returnToMenu=true;  // make sure menu is redrawn when quitting in any point
 
-    readFs(fs, Folder, allowed_ext);
+    DirCursor files;
+    FileList entry; // copy of the selected entry, the cursor may load another page
+    files.open(fs, Folder, allowed_ext);
+    index = min(recallFolderPosition(fs, Folder), files.size() - 1);
 
-    maxFiles = fileList.size() - 1; // discount the >back operator
+    maxFiles = files.size() - 1; // discount the >back operator
     LongPress = false;
     unsigned long LongPressTmp = millis();
     while (1) {
@@ -573,25 +635,27 @@ String loopSD(FS &fs, bool filePicker, String allowed_ext, String rootPath) {
 
         if (redraw) {
             if (strcmp(PreFolder.c_str(), Folder.c_str()) != 0 || reload) {
-                index = 0;
                 tft.fillScreen(bruceConfig.bgColor);
                 tft.drawRoundRect(5, 5, tftWidth - 10, tftHeight - 10, 5, bruceConfig.priColor);
                 Serial.println("reload to read: " + Folder);
-                readFs(fs, Folder, allowed_ext);
+                if (strcmp(PreFolder.c_str(), Folder.c_str()) != 0) {
+                    rememberFolderPosition(fs, PreFolder, index);
+                    index = recallFolderPosition(fs, Folder);
+                }
+                files.open(fs, Folder, allowed_ext);
                 PreFolder = Folder;
-                maxFiles = fileList.size() - 1;
-                if (strcmp(PreFolder.c_str(), Folder.c_str()) != 0 || index > maxFiles) index = 0;
+                maxFiles = files.size() - 1;
+                if (index > maxFiles) index = maxFiles;
                 reload = false;
             }
-            if (fileList.size() < 2) readFs(fs, Folder, allowed_ext);
 
-            coord = listFiles(index, fileList);
+            coord = listFiles(index, files);
 #if defined(HAS_TOUCH)
             TouchFooter();
 #endif
             redraw = false;
         }
-        displayScrollingText(fileList[index].filename, coord);
+        displayScrollingText(files.at(index).filename, coord);
 
 #ifdef HAS_KEYBOARD
         char pressed_letter = checkLetterShortcutPress();
@@ -600,22 +664,12 @@ String loopSD(FS &fs, bool filePicker, String allowed_ext, String rootPath) {
         // check letter shortcuts
         if (pressed_letter > 0) {
             // Serial.println(pressed_letter);
-            if (tolower(fileList[index].filename.c_str()[0]) == pressed_letter) {
-                // already selected, go to the next
-                index += 1;
-                // check if index is still valid
-                if (index <= maxFiles && tolower(fileList[index].filename.c_str()[0]) == pressed_letter) {
-                    redraw = true;
-                    continue;
-                }
-            }
-            // else look again from the start
-            for (int i = 0; i < maxFiles; i++) {
-                if (tolower(fileList[i].filename.c_str()[0]) == pressed_letter) { // check if 1st char matches
-                    index = i;
-                    redraw = true;
-                    break; // quit on 1st match
-                }
+            // go to the next match, or look again from the start
+            int found = files.findLetter(pressed_letter, index + 1);
+            if (found < 0) found = files.findLetter(pressed_letter, 0);
+            if (found >= 0) {
+                index = found;
+                redraw = true;
             }
         }
 #elif defined(T_EMBED) || defined(HAS_TOUCH) || !defined(HAS_SCREEN)
@@ -654,51 +708,67 @@ String loopSD(FS &fs, bool filePicker, String allowed_ext, String rootPath) {
             if (LongPress && millis() - LongPressTmp < 500) goto WAITING;
             LongPress = false;
 
+            entry = files.at(index);
             if (check(SelPress)) {
-                if (fileList[index].folder == true && fileList[index].operation == false) {
+                if (entry.folder == true && entry.operation == false) {
+                    String foldername = entry.filename;
                     options = {
-                        {"New Folder", [=]() { createFolder(fs, Folder); }                                 },
-                        {"Rename",
-                         [=]() {
-                             renameFile(fs, Folder + fileList[index].filename, fileList[index].filename);
-                         }                                                                                 },
-                        {"Delete",     [=]() { deleteFromSd(fs, Folder + "/" + fileList[index].filename); }},
-                        {"Close Menu", [&]() { yield(); }                                                  },
-                        {"Main Menu",  [&]() { exit = true; }                                              },
+                        {"New Folder", [=]() { createFolder(fs, Folder); }                       },
+                        {"Rename",     [=]() { renameFile(fs, Folder + foldername, foldername); }},
+                        {"Delete",     [=]() { deleteFromSd(fs, Folder + "/" + foldername); }    },
                     };
+                    String folderpath = Folder + (Folder == "/" ? "" : "/") + foldername;
+                    options.push_back({"Copy", [=]() { copyFile(fs, folderpath); }});
+                    if (&fs == &SD)
+                        options.push_back({"Copy->LittleFS", [=]() { copyToFs(SD, LittleFS, folderpath); }});
+                    if (&fs == &LittleFS && sdcardMounted)
+                        options.push_back({"Copy->SD", [=]() { copyToFs(LittleFS, SD, folderpath); }});
+                    options.push_back({"Close Menu", [&]() { yield(); }});
+                    options.push_back({"Main Menu", [&]() { exit = true; }});
                     loopOptions(options);
                     tft.drawRoundRect(5, 5, tftWidth - 10, tftHeight - 10, 5, bruceConfig.priColor);
                     reload = true;
                     redraw = true;
-                } else if (fileList[index].folder == false && fileList[index].operation == false) {
+                } else if (entry.folder == false && entry.operation == false) {
                     goto Files;
                 } else {
+                    bool search = false;
                     options = {
                         {"New Folder", [=]() { createFolder(fs, Folder); }},
                     };
                     if (fileToCopy != "") options.push_back({"Paste", [=]() { pasteFile(fs, Folder); }});
+                    if (fileIndexFor(fs)) options.push_back({"Search", [&]() { search = true; }});
                     options.push_back({"Close Menu", [&]() { yield(); }});
                     options.push_back({"Main Menu", [&]() { exit = true; }});
                     loopOptions(options);
+                    if (search) {
+                        FS *searchFs = &fs;
+                        String hit = searchFiles(searchFs, false, allowed_ext);
+                        if (hit != "") {
+                            files.close();
+                            String hitFolder = selectInFolder(fs, hit, allowed_ext);
+                            if (hitFolder == Folder) index = recallFolderPosition(fs, Folder);
+                            Folder = hitFolder;
+                        }
+                    }
                     tft.drawRoundRect(5, 5, tftWidth - 10, tftHeight - 10, 5, bruceConfig.priColor);
                     reload = true;
                     redraw = true;
                 }
             } else {
             Files:
-                if (fileList[index].folder == true && fileList[index].operation == false) {
-                    Folder = Folder + (Folder == "/" ? "" : "/") +
-                             fileList[index].filename; // Folder=="/"? "":"/" +
+                if (entry.folder == true && entry.operation == false) {
+                    Folder = Folder + (Folder == "/" ? "" : "/") + entry.filename; // Folder=="/"? "":"/" +
                     // Debug viewer
                     Serial.println(Folder);
                     redraw = true;
-                } else if (fileList[index].folder == false && fileList[index].operation == false) {
+                } else if (entry.folder == false && entry.operation == false) {
                     // Save the file/folder info to Clear memory to allow other functions to work better
-                    String filepath = Folder + (Folder == "/" ? "" : "/") + fileList[index].filename; //
-                    String filename = fileList[index].filename;
+                    String filepath = Folder + (Folder == "/" ? "" : "/") + entry.filename; //
+                    String filename = entry.filename;
                     // Debug viewer
                     Serial.println(filepath + " --> " + filename);
-                    fileList.clear(); // Clear memory to allow other functions to work better
+                    files.close(); // Clear memory to allow other functions to work better
 
                     options = {
                         {"View File",  [=]() { viewFile(fs, filepath); }            },
@@ -817,13 +887,19 @@ String loopSD(FS &fs, bool filePicker, String allowed_ext, String rootPath) {
                                                delay(200);
                                                qrcode_display(readSmallFile(fs, filepath));
                                            }});
+                    }
+                    if (filesize > 0) {
                         options.push_back({"CRC32", [&]() {
                                                delay(200);
-                                               displaySuccess(crc32File(fs, filepath), true);
+                                               displaySuccess(crc32File(fs, filepath, true), true);
                                            }});
                         options.push_back({"MD5", [&]() {
                                                delay(200);
-                                               displaySuccess(md5File(fs, filepath), true);
+                                               displaySuccess(md5File(fs, filepath, true), true);
+                                           }});
+                        options.push_back({"SHA256", [&]() {
+                                               delay(200);
+                                               displaySuccess(sha256File(fs, filepath, true), true);
                                            }});
                     }
                     options.push_back({"Close Menu", [&]() { yield(); }});
@@ -842,7 +918,6 @@ String loopSD(FS &fs, bool filePicker, String allowed_ext, String rootPath) {
                     Folder = Folder.substring(0, Folder.lastIndexOf('/'));
                     if (Folder == "") Folder = "/";
                     Serial.println("Going to folder: " + Folder);
-                    index = 0;
                     redraw = true;
                 }
                 redraw = true;
@@ -851,22 +926,86 @@ String loopSD(FS &fs, bool filePicker, String allowed_ext, String rootPath) {
             delay(10);
         }
     }
-    fileList.clear();
+    rememberFolderPosition(fs, Folder, index);
+    return result;
+}
+
+/*********************************************************************
+**  Function: searchFiles
+**  Search the file index and pick one of the files found.
+**  Words starting with "." filter by extension, ex: "433 .sub"
+**********************************************************************/
+String searchFiles(FS *&fs, bool anyFs, String allowed_ext) {
+    String text = keyboard("", 76, "Name, tag or /path:");
+    if (text == "\x1B") return "";
+
+    String query = "";
+    String exts = "";
+    int start = 0;
+    while (start <= (int)text.length()) {
+        int end = text.indexOf(' ', start);
+        if (end < 0) end = text.length();
+        String word = text.substring(start, end);
+        if (word.startsWith(".") && word.length() > 1) {
+            if (exts.length()) exts += "|";
+            exts += word.substring(1);
+        } else if (word.length()) {
+            if (query.length()) query += " ";
+            query += word;
+        }
+        start = end + 1;
+    }
+    // A file picker only lists its own extensions
+    if (allowed_ext != "*" || exts == "") exts = allowed_ext;
+
+    std::vector<FileIndex *> indexes;
+    if (anyFs) {
+        if (sdcardMounted) indexes.push_back(fileIndexFor(SD));
+        indexes.push_back(fileIndexFor(LittleFS));
+    } else if (fs && fileIndexFor(*fs)) {
+        indexes.push_back(fileIndexFor(*fs));
+    }
+
+    displayTextLine("Searching...");
+    String result = "";
+    std::vector<Option> hits;
+    for (FileIndex *index : indexes) {
+        FS *hitFs = &index->fs();
+        for (auto &hit : index->find(query, exts)) {
+            String label = anyFs ? String(index->name()) + ":" + hit.path : hit.path;
+            if (hit.tags.length()) label += " [" + hit.tags + "]";
+            String path = hit.path;
+            hits.push_back({label, [=, &fs, &result]() {
+                                fs = hitFs;
+                                result = path;
+                            }});
+        }
+    }
+    if (hits.empty()) {
+        displayInfo("No files found", true);
+        return "";
+    }
+    loopOptions(hits);
     return result;
 }
 
+/*********************************************************************
+**  Function: browseToFile
+**  Open the file browser where filepath is, with it selected
+**********************************************************************/
+void browseToFile(FS &fs, String filepath) {
+    String folder = selectInFolder(fs, filepath, "*");
+    loopSD(fs, false, "*", folder);
+}
+
 /*********************************************************************
 **  Function: viewFile
 **  Display file content
 **********************************************************************/
 void viewFile(FS fs, String filepath) {
-    File file = fs.open(filepath, FILE_READ);
-    if (!file) return;
-
     ScrollableTextArea area = ScrollableTextArea("VIEW FILE");
-    area.fromFile(file);
-
-    file.close();
+    // Read from the file as it is scrolled, so any size can be viewed
+    if (!area.openFile(fs, filepath)) return;
 
     area.show();
 }
@@ -6,6 +6,11 @@
 #include <SD.h>
 #include <SPI.h>
 
+// Modules told by fileChanged()
+#ifndef FILE_CHANGE_LISTENERS
+#define FILE_CHANGE_LISTENERS 4
+#endif
+
 struct FileList {
     String filename;
     bool folder;
@@ -26,28 +31,60 @@ bool renameFile(FS fs, String path, String filename);
 
 bool copyFile(FS fs, String path);
 
-bool copyToFs(FS from, FS to, String path, bool draw = true);
+bool copyToFs(FS &from, FS &to, String path, bool draw = true);
 
 bool pasteFile(FS fs, String path);
 
 bool createFolder(FS fs, String path);
 
+// Called with each file or folder written or removed through Bruce, from the task that changed it
+typedef void (*FileChangeCb)(FS &fs, const String &path, bool removed);
+// Listeners stay for the whole run, false when the FILE_CHANGE_LISTENERS slots are taken
+bool addFileChangeListener(FileChangeCb cb);
+// Tells the listeners (file index, icon cache) that path was written, or removed
+void fileChanged(FS &fs, const String &path, bool removed = false);
+
+// Rename tmpPath over path. On failure tmpPath is removed, unless path is already gone
+bool replaceFile(FS &fs, const String &tmpPath, const String &path);
+// Rename path.tmp back to path when a replaceFile() was interrupted after path was removed
+bool recoverTmpFile(FS &fs, const String &path);
+// Write content to path.tmp, then rename it over path, so a reset never leaves a half written file
+bool writeFileAtomic(FS &fs, const String &path, const String &content);
+bool writeFileAtomic(FS &fs, const String &path, const uint8_t *data, size_t len);
+
 String readLineFromFile(File myFile);
 
 String readSmallFile(FS &fs, String filepath);
 
 char *readBigFile(FS &fs, String filepath, bool binary = false, size_t *fileSize = NULL);
 
-String md5File(FS &fs, String filepath);
+// Read size used when hashing, the buffer is allocated in internal RAM
+#ifndef HASH_FILE_CHUNK
+#define HASH_FILE_CHUNK 8192
+#endif
+
+enum FileHashType { HASH_MD5, HASH_CRC32, HASH_SHA256 };
 
-String crc32File(FS &fs, String filepath);
+String hashFile(
+    FS &fs, String filepath, FileHashType type, void (*progress)(size_t done, size_t total) = NULL
+);
 
-void readFs(FS fs, String folder, String allowed_ext = "*");
+String md5File(FS &fs, String filepath, bool draw = false);
 
-bool sortList(const FileList &a, const FileList &b);
+String crc32File(FS &fs, String filepath, bool draw = false);
+
+String sha256File(FS &fs, String filepath, bool draw = false);
+
+bool checkExt(String ext, String pattern);
 
 String loopSD(FS &fs, bool filePicker = false, String allowed_ext = "*", String rootPath = "/");
 
+// Pick a file from the file index, fs is set to its filesystem. anyFs searches both SD and LittleFS
+String searchFiles(FS *&fs, bool anyFs = false, String allowed_ext = "*");
+
+// Open the file browser in the folder of filepath, with the file selected
+void browseToFile(FS &fs, String filepath);
+
 void viewFile(FS fs, String filepath);
 
 bool checkLittleFsSize();
@@ -2,6 +2,7 @@
 #include "core/sd_functions.h"
 #include "helpers.h"
 #include "modules/bjs_interpreter/interpreter.h"
+#include "modules/bjs_interpreter/profiler_js.h"
 
 uint32_t jsFileCallback(cmd *c) {
     Command cmd(c);
@@ -46,21 +47,36 @@ uint32_t jsBufferCallback(cmd *c) {
 }*/
 
 uint32_t jsBufferCallback(cmd *c) {
-    if (!(_setupPsramFs())) return false;
-
+    // Run the buffer directly: going through a temp file would also leave its bytecode cache behind
     char *txt = _readFileFromSerial();
-    String tmpfilepath = "/tmpramfile"; // TODO: Change to use char *txt directly
-    File f = PSRamFS.open(tmpfilepath, FILE_WRITE);
-    if (!f) return false;
+    return run_bjs_script_headless(txt);
+    // *txt is freed by js interpreter
+}
 
-    f.write((const uint8_t *)txt, strlen(txt));
-    f.close();
-    free(txt);
+uint32_t jsProfileCallback(cmd *c) {
+    // per-native profiler control, the report is printed after each script run
+    // e.g. "js profile on", "js profile print"
 
-    bool r = run_bjs_script_headless(PSRamFS, tmpfilepath);
-    PSRamFS.remove(tmpfilepath);
+    Command cmd(c);
 
-    return r;
+    Argument arg = cmd.getArgument("action");
+    String action = arg.getValue();
+    action.trim();
+
+    if (action == "on") {
+        jsProfilerSetEnabled(true);
+        Serial.println("JS profiler on, starting with the next script");
+    } else if (action == "off") {
+        jsProfilerSetEnabled(false);
+    } else if (action == "reset") {
+        jsProfilerReset();
+    } else if (action == "print") {
+        jsProfilerPrint(Serial);
+    } else {
+        Serial.println("Usage: js profile on|off|reset|print");
+        return false;
+    }
+    return true;
 }
 
 void createInterpreterCommands(SimpleCLI *cli) {
@@ -71,4 +87,7 @@ void createInterpreterCommands(SimpleCLI *cli) {
 
     Command bufferCmd = jsCmd.addCommand("run_from_buffer", jsBufferCallback);
     bufferCmd.addPosArg("fileSize", "0");  // optional arg
+
+    Command profileCmd = jsCmd.addCommand("profile", jsProfileCallback);
+    profileCmd.addPosArg("action", "print");
 }
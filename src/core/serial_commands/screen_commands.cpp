@@ -1,4 +1,6 @@
 #include "screen_commands.h"
+#include "core/display.h"
+#include "core/sd_functions.h"
 #include "core/settings.h"
 #include "core/utils.h" // time
 #include <globals.h>
@@ -94,6 +96,100 @@ uint32_t clockCallback(cmd *c) {
     return true;
 }
 
+uint32_t jpegBenchCallback(cmd *c) {
+    // render every .jpg in a folder and report the time spent on each one
+    // e.g. "screen jpegbench /images"
+
+    Command cmd(c);
+
+    Argument arg = cmd.getArgument("folder");
+    String folder = arg.getValue();
+    folder.trim();
+    if (!folder.startsWith("/")) folder = "/" + folder;
+
+    FS *fs;
+    if (!getFsStorage(fs) || !(*fs).exists(folder)) return false;
+
+    File root = fs->open(folder);
+    if (!root || !root.isDirectory()) return false;
+
+    uint32_t totalMs = 0;
+    size_t totalBytes = 0;
+    int count = 0;
+    uint32_t minHeapBefore = ESP.getMinFreeHeap();
+
+    File file = root.openNextFile();
+    while (file) {
+        String name = file.name();
+        String lower = name;
+        lower.toLowerCase();
+        if (!file.isDirectory() && lower.endsWith(".jpg")) {
+            size_t size = file.size();
+            String path = folder.endsWith("/") ? folder + name : folder + "/" + name;
+            file.close();
+
+            uint32_t t = millis();
+            bool ok = showJpeg(*fs, path, 0, 0, true);
+            t = millis() - t;
+
+            Serial.printf("%-32s %8u bytes %6lu ms %s\n", name.c_str(), size, t, ok ? "" : "FAIL");
+            if (ok) {
+                totalMs += t;
+                totalBytes += size;
+                count++;
+            }
+        } else {
+            file.close();
+        }
+        file = root.openNextFile();
+    }
+    root.close();
+
+    if (count == 0) {
+        Serial.println("No .jpg files found in " + folder);
+        return false;
+    }
+    Serial.printf(
+        "%d images, %u bytes in %lu ms (avg %lu ms, %.1f KB/s)\n",
+        count,
+        totalBytes,
+        totalMs,
+        totalMs / count,
+        totalMs ? totalBytes / 1.024 / totalMs : 0.0
+    );
+    Serial.printf("Min free heap: %lu before, %lu after\n", minHeapBefore, ESP.getMinFreeHeap());
+    return true;
+}
+
+uint32_t profileCallback(cmd *c) {
+    // frame profiler control, counters are printed as CSV
+    // e.g. "screen profile on", "screen profile overlay", "screen profile print"
+
+    Command cmd(c);
+
+    Argument arg = cmd.getArgument("action");
+    String action = arg.getValue();
+    action.trim();
+
+    if (action == "on") {
+        tft.resetProfile();
+        tft.setProfiling(true);
+    } else if (action == "overlay") {
+        tft.resetProfile();
+        tft.setProfiling(true, true);
+    } else if (action == "off") {
+        tft.setProfiling(false);
+    } else if (action == "reset") {
+        tft.resetProfile();
+    } else if (action == "print") {
+        tft.printProfile(Serial);
+    } else {
+        Serial.println("Usage: screen profile on|overlay|off|reset|print");
+        return false;
+    }
+    return true;
+}
+
 void createScreenCommands(SimpleCLI *cli) {
     Command clockCmd = cli->addCommand("clock", clockCallback);
 
@@ -109,4 +205,10 @@ void createScreenCommands(SimpleCLI *cli) {
     rgbColorCmd.addPosArg("blue");
     Command hexColorCmd = colorCmd.addCommand("hex", hexColorCallback);
     hexColorCmd.addPosArg("value");
+
+    Command jpegBenchCmd = screenCmd.addCommand("jpegbench", jpegBenchCallback);
+    jpegBenchCmd.addPosArg("folder", "/");
+
+    Command profileCmd = screenCmd.addCommand("profile", profileCallback);
+    profileCmd.addPosArg("action", "print");
 }
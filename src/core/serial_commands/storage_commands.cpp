@@ -1,5 +1,8 @@
 #include "storage_commands.h"
+#include "core/copy_engine.h"
+#include "core/file_index.h"
 #include "core/sd_functions.h"
+#include "core/serial_transfer.h"
 #include "helpers.h"
 #include <globals.h>
 
@@ -91,6 +94,92 @@ uint32_t crc32Callback(cmd *c) {
     return true;
 }
 
+uint32_t sha256Callback(cmd *c) {
+    Command cmd(c);
+
+    Argument arg = cmd.getArgument("filepath");
+    String filepath = arg.getValue();
+    filepath.trim();
+
+    if (filepath.length() == 0) return false;
+
+    if (!filepath.startsWith("/")) filepath = "/" + filepath;
+
+    FS *fs;
+    if (!getFsStorage(fs) || !(*fs).exists(filepath)) return false;
+
+    Serial.println(sha256File(*fs, filepath));
+    return true;
+}
+
+// Write a test file of sizeKb for the benchmarks
+static bool writeBenchFile(FS &fs, const char *fsName, const char *path, uint32_t sizeKb) {
+    File file = fs.open(path, FILE_WRITE, true);
+    if (!file) {
+        Serial.printf("%s: could not create %s\n", fsName, path);
+        return false;
+    }
+    uint8_t block[1024];
+    for (size_t i = 0; i < sizeof(block); i++) block[i] = i * 31 + 7;
+    uint32_t written = 0;
+    while (written < sizeKb && file.write(block, sizeof(block)) == sizeof(block)) written++;
+    file.close();
+    if (written < sizeKb) {
+        Serial.printf("%s: only %lu of %lu KB written, not enough space?\n", fsName, written, sizeKb);
+        fs.remove(path);
+        return false;
+    }
+    return true;
+}
+
+// Write a test file of sizeKb on the fs and time each hash over it
+static bool hashBenchmark(FS &fs, const char *fsName, uint32_t sizeKb) {
+    const char *path = "/.hashbench.tmp";
+    if (!writeBenchFile(fs, fsName, path, sizeKb)) return false;
+
+    const struct {
+        const char *name;
+        FileHashType type;
+    } algos[] = {
+        {"crc32",  HASH_CRC32 },
+        {"md5",    HASH_MD5   },
+        {"sha256", HASH_SHA256},
+    };
+    for (auto &algo : algos) {
+        uint32_t start = micros();
+        String digest = hashFile(fs, path, algo.type);
+        uint32_t elapsed = max<uint32_t>(micros() - start, 1);
+        Serial.printf(
+            "%s %-6s %lu KB in %lu ms: %.2f MB/s  %s\n",
+            fsName,
+            algo.name,
+            sizeKb,
+            elapsed / 1000,
+            (sizeKb * 1024.0) / elapsed,
+            digest.c_str()
+        );
+    }
+    fs.remove(path);
+    return true;
+}
+
+uint32_t hashBenchCallback(cmd *c) {
+    Command cmd(c);
+
+    Argument arg = cmd.getArgument("size_kb");
+    int sizeKb = arg.getValue().toInt();
+    if (sizeKb <= 0) sizeKb = 1024;
+
+    bool ok = false;
+    if (setupSdCard()) ok |= hashBenchmark(SD, "SD", sizeKb);
+    if (checkLittleFsSizeNM()) {
+        // LittleFS is usually small, leave half of the free space
+        uint32_t freeKb = (LittleFS.totalBytes() - LittleFS.usedBytes()) / 2048;
+        ok |= hashBenchmark(LittleFS, "LittleFS", min<uint32_t>(sizeKb, freeKb));
+    }
+    return ok;
+}
+
 uint32_t removeCallback(cmd *c) {
     Command cmd(c);
 
@@ -110,6 +199,7 @@ uint32_t removeCallback(cmd *c) {
     }
 
     if ((*fs).remove(filepath)) {
+        fileChanged(*fs, filepath, true);
         Serial.println("File removed");
         return true;
     }
@@ -124,7 +214,7 @@ uint32_t writeCallback(cmd *c) {
     Argument arg = cmd.getArgument("filepath");
     Argument sizeArg = cmd.getArgument("size");
     String filepath = arg.getValue();
-    String sizeStr = arg.getValue();
+    String sizeStr = sizeArg.getValue();
     filepath.trim();
     int fileSize = sizeStr.toInt();
 
@@ -146,11 +236,51 @@ uint32_t writeCallback(cmd *c) {
     f.write((const uint8_t *)txt, strlen(txt));
     f.close();
     free(txt);
+    fileChanged(*fs, filepath);
 
     Serial.println("File written: " + filepath);
     return true;
 }
 
+uint32_t putCallback(cmd *c) {
+    Command cmd(c);
+
+    Argument arg = cmd.getArgument("filepath");
+    String filepath = arg.getValue();
+    filepath.trim();
+    long size = cmd.getArgument("size").getValue().toInt();
+    long baud = cmd.getArgument("baud").getValue().toInt();
+
+    if (filepath.length() == 0 || size < 0 || baud < 0) return false;
+
+    if (!filepath.startsWith("/")) filepath = "/" + filepath;
+
+    FS *fs;
+    if (!getFsStorage(fs)) return false;
+
+    if (!serialReceiveFile(*fs, filepath, size, baud)) return false;
+    fileChanged(*fs, filepath);
+    return true;
+}
+
+uint32_t getCallback(cmd *c) {
+    Command cmd(c);
+
+    Argument arg = cmd.getArgument("filepath");
+    String filepath = arg.getValue();
+    filepath.trim();
+    long baud = cmd.getArgument("baud").getValue().toInt();
+
+    if (filepath.length() == 0 || baud < 0) return false;
+
+    if (!filepath.startsWith("/")) filepath = "/" + filepath;
+
+    FS *fs;
+    if (!getFsStorage(fs)) return false;
+
+    return serialSendFile(*fs, filepath, baud);
+}
+
 uint32_t renameCallback(cmd *c) {
     Command cmd(c);
 
@@ -174,6 +304,8 @@ uint32_t renameCallback(cmd *c) {
     }
 
     if ((*fs).rename(filepath, newName)) {
+        fileChanged(*fs, filepath, true);
+        fileChanged(*fs, newName);
         Serial.println("File renamed to '" + newName + "'");
         return true;
     }
@@ -264,6 +396,7 @@ uint32_t rmdirCallback(cmd *c) {
     }
 
     if ((*fs).rmdir(filepath)) {
+        fileChanged(*fs, filepath, true);
         Serial.println("Directory removed");
         return true;
     }
@@ -339,6 +472,112 @@ uint32_t freeStorageCallback(cmd *c) {
     return true;
 }
 
+static bool copyBenchmark(FS &from, const char *fromName, FS &to, const char *toName, const char *dest) {
+    CopyStats stats;
+    bool ok = copyPath(from, "/.copybench.tmp", to, dest, NULL, &stats);
+    if (ok) {
+        Serial.printf(
+            "%s -> %s: %llu bytes in %lu ms: %.2f MB/s\n",
+            fromName,
+            toName,
+            stats.bytes,
+            stats.elapsedMs,
+            stats.mbPerSec()
+        );
+    } else {
+        Serial.printf("%s -> %s: copy failed\n", fromName, toName);
+    }
+    return ok;
+}
+
+uint32_t copyBenchCallback(cmd *c) {
+    Command cmd(c);
+
+    Argument arg = cmd.getArgument("size_kb");
+    int sizeKb = arg.getValue().toInt();
+    if (sizeKb <= 0) sizeKb = 1024;
+
+    if (!setupSdCard()) {
+        Serial.println("No SD card installed");
+        return false;
+    }
+    // The file has to fit on LittleFS too
+    uint32_t freeKb = (LittleFS.totalBytes() - LittleFS.usedBytes()) / 2048;
+    if ((uint32_t)sizeKb > freeKb) {
+        Serial.printf("Using %lu KB, LittleFS is too small for %d KB\n", freeKb, sizeKb);
+        sizeKb = freeKb;
+    }
+    if (!writeBenchFile(SD, "SD", "/.copybench.tmp", sizeKb)) return false;
+
+    bool ok = copyBenchmark(SD, "SD", LittleFS, "LittleFS", "/.copybench.tmp");
+    if (ok) {
+        ok &= copyBenchmark(LittleFS, "LittleFS", SD, "SD", "/.copybench2.tmp");
+        SD.remove("/.copybench2.tmp");
+    }
+    LittleFS.remove("/.copybench.tmp");
+    ok &= copyBenchmark(SD, "SD", SD, "SD", "/.copybench2.tmp");
+    SD.remove("/.copybench2.tmp");
+    SD.remove("/.copybench.tmp");
+    return ok;
+}
+
+uint32_t findCallback(cmd *c) {
+    Command cmd(c);
+
+    Argument queryArg = cmd.getArgument("query");
+    Argument extArg = cmd.getArgument("ext");
+    String query = queryArg.getValue();
+    String exts = extArg.getValue();
+    query.trim();
+    exts.trim();
+    if (exts.length() == 0) exts = "*";
+
+    std::vector<FileIndex *> indexes;
+    if (sdcardMounted) indexes.push_back(fileIndexFor(SD));
+    indexes.push_back(fileIndexFor(LittleFS));
+
+    size_t found = 0;
+    for (FileIndex *index : indexes) {
+        uint32_t start = millis();
+        std::vector<FileIndexHit> hits = index->find(query, exts);
+        for (auto &hit : hits) {
+            Serial.printf(
+                "%s:%s\t%lu\t%s\n", index->name(), hit.path.c_str(), hit.size, hit.tags.c_str()
+            );
+        }
+        Serial.printf(
+            "%s: %u match(es) in %lu ms, %u bytes of index in memory\n",
+            index->name(),
+            hits.size(),
+            millis() - start,
+            index->memoryUsed()
+        );
+        found += hits.size();
+    }
+    return found > 0;
+}
+
+uint32_t indexCallback(cmd *c) {
+    Command cmd(c);
+
+    Argument arg = cmd.getArgument("storage_type");
+    FileIndex *index;
+    if (arg.getValue() == "sd") {
+        if (!setupSdCard()) {
+            Serial.println("No SD card installed");
+            return false;
+        }
+        index = fileIndexFor(SD);
+    } else if (arg.getValue() == "littlefs") {
+        index = fileIndexFor(LittleFS);
+    } else {
+        Serial.printf("Invalid arg %s\n", arg.getValue().c_str());
+        return false;
+    }
+    // Synchronous, the timing is printed when it ends
+    return index->rebuild(false);
+}
+
 void createListCommand(SimpleCLI *cli) {
     Command cmd = cli->addCommand("ls,dir", listCallback);
     cmd.addPosArg("filepath", "");
@@ -360,6 +599,11 @@ void createCrc32Command(SimpleCLI *cli) {
     cmd.addPosArg("filepath");
 }
 
+void createSha256Command(SimpleCLI *cli) {
+    Command cmd = cli->addCommand("sha256", sha256Callback);
+    cmd.addPosArg("filepath");
+}
+
 void createRemoveCommand(SimpleCLI *cli) {
     Command cmd = cli->addCommand("rm,del", removeCallback);
     cmd.addPosArg("filepath");
@@ -391,6 +635,15 @@ void createStorageCommand(SimpleCLI *cli) {
     cmdWrite.addPosArg("filepath");
     cmdWrite.addPosArg("size", "0");
 
+    Command cmdPut = cmd.addCommand("put", putCallback);
+    cmdPut.addPosArg("filepath");
+    cmdPut.addPosArg("size");
+    cmdPut.addPosArg("baud", "0");
+
+    Command cmdGet = cmd.addCommand("get", getCallback);
+    cmdGet.addPosArg("filepath");
+    cmdGet.addPosArg("baud", "0");
+
     Command cmdRename = cmd.addCommand("rename", renameCallback);
     cmdRename.addPosArg("filepath");
     cmdRename.addPosArg("newName");
@@ -411,11 +664,27 @@ void createStorageCommand(SimpleCLI *cli) {
     Command cmdCrc32 = cmd.addCommand("crc32", crc32Callback);
     cmdCrc32.addPosArg("filepath");
 
+    Command cmdSha256 = cmd.addCommand("sha256", sha256Callback);
+    cmdSha256.addPosArg("filepath");
+
+    Command cmdHashBench = cmd.addCommand("hashbench", hashBenchCallback);
+    cmdHashBench.addPosArg("size_kb", "1024");
+
+    Command cmdCopyBench = cmd.addCommand("copybench", copyBenchCallback);
+    cmdCopyBench.addPosArg("size_kb", "1024");
+
     Command cmdStat = cmd.addCommand("stat", statCallback);
     cmdStat.addPosArg("filepath");
 
     Command cmdFree = cmd.addCommand("free", freeStorageCallback);
     cmdFree.addPosArg("storage_type");
+
+    Command cmdFind = cmd.addCommand("find", findCallback);
+    cmdFind.addPosArg("query", "");
+    cmdFind.addPosArg("ext", "*");
+
+    Command cmdIndex = cmd.addCommand("index", indexCallback);
+    cmdIndex.addPosArg("storage_type", "sd");
 }
 
 void createStorageCommands(SimpleCLI *cli) {
@@ -428,6 +697,7 @@ void createStorageCommands(SimpleCLI *cli) {
 
     createMd5Command(cli);
     createCrc32Command(cli);
+    createSha256Command(cli);
 
     createStorageCommand(cli);
 }
@@ -1,4 +1,5 @@
 #include "util_commands.h"
+#include "core/boot_profile.h"
 #include "core/main_menu.h"
 #include "core/sd_functions.h"
 #include "core/utils.h" // to return optionsJSON
@@ -21,6 +22,11 @@ uint32_t uptimeCallback(cmd *c) {
     return true;
 }
 
+uint32_t bootCallback(cmd *c) {
+    bootProfilePrint(Serial);
+    return true;
+}
+
 uint32_t dateCallback(cmd *c) {
     if (!clock_set) {
         Serial.println("Clock not set");
@@ -164,6 +170,9 @@ uint32_t helpCallback(cmd *c) {
     Serial.println("  led <r/g/b> <0-255>    - Change the UI main color.");
     Serial.println("  clock                 - Show the clock UI.");
 
+    Serial.println("\nSystem:");
+    Serial.println("  boot                    - Time taken by each phase of the last boot.");
+
     Serial.println("\nPower Management:");
     Serial.println("  power <off/reboot/sleep>  - General power management.");
 
@@ -178,6 +187,8 @@ uint32_t helpCallback(cmd *c) {
         "management commands."
     );
     Serial.println("  ls - Same as storage list");
+    Serial.println("  storage put <file path> <size> [baud]  - Binary upload, see tools/serial_transfer.");
+    Serial.println("  storage get <file path> [baud]  - Binary download, see tools/serial_transfer.");
 
     Serial.println("\nSettings:");
     Serial.println("  settings                - View all the current settings.");
@@ -383,6 +394,7 @@ uint32_t loaderCallback(cmd *c) {
 
 void createUtilCommands(SimpleCLI *cli) {
     cli->addCommand("uptime", uptimeCallback);
+    cli->addCommand("boot", bootCallback);
     cli->addCommand("date", dateCallback);
     cli->addCommand("i2c", i2cCallback);
     cli->addCommand("free", freeCallback);
@@ -0,0 +1,269 @@
+#include "serial_transfer.h"
+#include <esp32/rom/crc.h>
+#include <globals.h>
+
+#define XFER_MAGIC0 0xB5
+#define XFER_MAGIC1 0x5B
+
+#define XFER_DATA 'D'
+#define XFER_ACK 'A'
+#define XFER_NAK 'N'
+#define XFER_END 'E'
+#define XFER_ABORT 'X'
+
+struct XferFrame {
+    uint8_t type;
+    uint16_t seq;
+    uint16_t len;
+};
+
+enum XferRead { XFER_FRAME, XFER_TIMEOUT, XFER_BAD };
+
+static uint32_t consoleBaud = 0; // speed to go back to after the transfer
+
+static void sendFrame(uint8_t type, uint16_t seq, const uint8_t *payload = NULL, uint16_t len = 0) {
+    uint8_t head[7] = {
+        XFER_MAGIC0, XFER_MAGIC1, type, (uint8_t)seq, (uint8_t)(seq >> 8), (uint8_t)len, (uint8_t)(len >> 8)
+    };
+    uint32_t crc = crc32_le(0, head + 2, 5);
+    if (len) crc = crc32_le(crc, payload, len);
+    Serial.write(head, sizeof(head));
+    if (len) Serial.write(payload, len);
+    Serial.write((const uint8_t *)&crc, sizeof(crc)); // ESP32 is little endian
+}
+
+// Reads len bytes unless the deadline (in millis) passes first
+static bool readExact(uint8_t *buf, size_t len, uint32_t deadline) {
+    size_t got = 0;
+    while (got < len) {
+        int available = Serial.available();
+        if (available > 0) {
+            got += Serial.read(buf + got, min((size_t)available, len - got));
+            continue;
+        }
+        if ((int32_t)(millis() - deadline) >= 0) return false;
+        vTaskDelay(1);
+    }
+    return true;
+}
+
+/*********************************************************************
+**  Function: readFrame
+**  Next frame, anything before its magic (echo, log lines) is skipped
+**********************************************************************/
+static XferRead readFrame(XferFrame &frame, uint8_t *payload, uint16_t maxLen, uint32_t timeoutMs) {
+    uint32_t deadline = millis() + timeoutMs;
+    uint8_t prev = 0;
+    uint8_t byte = 0;
+    do {
+        prev = byte;
+        if (!readExact(&byte, 1, deadline)) return XFER_TIMEOUT;
+    } while (prev != XFER_MAGIC0 || byte != XFER_MAGIC1);
+
+    uint8_t head[5];
+    if (!readExact(head, sizeof(head), deadline)) return XFER_TIMEOUT;
+    frame.type = head[0];
+    frame.seq = head[1] | head[2] << 8;
+    frame.len = head[3] | head[4] << 8;
+    if (frame.len > maxLen) return XFER_BAD;
+
+    uint32_t crc;
+    if (!readExact(payload, frame.len, deadline) || !readExact((uint8_t *)&crc, sizeof(crc), deadline)) {
+        return XFER_TIMEOUT;
+    }
+    return crc == crc32_le(crc32_le(0, head, sizeof(head)), payload, frame.len) ? XFER_FRAME : XFER_BAD;
+}
+
+static void beginTransfer(uint32_t size, uint32_t &baud) {
+#if ARDUINO_USB_CDC_ON_BOOT
+    baud = 0; // USB console, the baud rate does nothing
+#endif
+    Serial.printf("XFER READY %lu %d %lu\n", size, XFER_CHUNK, baud);
+#if !ARDUINO_USB_CDC_ON_BOOT
+    if (baud) {
+        Serial.flush();
+        consoleBaud = Serial.baudRate();
+        Serial.updateBaudRate(baud);
+        delay(50); // the client switches once it has read the READY line, frames before that are garbled
+    }
+#endif
+}
+
+static void endTransfer(const char *error, uint32_t bytes, uint32_t start) {
+    uint32_t elapsed = millis() - start;
+#if !ARDUINO_USB_CDC_ON_BOOT
+    if (consoleBaud) {
+        Serial.flush();
+        Serial.updateBaudRate(consoleBaud);
+        consoleBaud = 0;
+    }
+#endif
+    delay(50); // the client goes back to the console speed too
+    if (error) Serial.printf("XFER FAIL %s\n", error);
+    else Serial.printf("XFER OK %lu %lu\n", bytes, elapsed);
+}
+
+static uint8_t *xferBuffer() {
+    return (uint8_t *)(psramFound() ? ps_malloc(XFER_CHUNK) : malloc(XFER_CHUNK));
+}
+
+/*********************************************************************
+**  Function: serialReceiveFile
+**  Write the data frames to path.part, renamed to path once complete
+**********************************************************************/
+bool serialReceiveFile(FS &fs, const String &path, uint32_t size, uint32_t baud) {
+    String partPath = path + ".part";
+    File file = fs.open(partPath, FILE_WRITE, true);
+    uint8_t *buf = xferBuffer();
+    if (!file || !buf) {
+        if (file) file.close();
+        free(buf);
+        Serial.println(file ? "XFER FAIL out of memory" : "XFER FAIL cannot create file");
+        return false;
+    }
+
+    beginTransfer(size, baud);
+    uint32_t start = millis();
+    uint32_t received = 0;
+    uint32_t fileCrc = 0;
+    uint16_t expected = 0;
+    int retries = 0;
+    const char *error = NULL;
+    bool done = false;
+
+    sendFrame(XFER_NAK, expected);
+    while (!done && !error) {
+        XferFrame frame;
+        XferRead read = readFrame(frame, buf, XFER_CHUNK, XFER_TIMEOUT_MS);
+        if (read != XFER_FRAME) {
+            if (++retries > XFER_RETRIES) error = read == XFER_TIMEOUT ? "timeout" : "too many bad frames";
+            else sendFrame(XFER_NAK, expected);
+            continue;
+        }
+        retries = 0;
+
+        if (frame.type == XFER_ABORT) {
+            error = "aborted by the client";
+        } else if (frame.type == XFER_DATA && frame.seq == expected) {
+            if (received + frame.len > size) {
+                error = "more data than announced";
+            } else if (file.write(buf, frame.len) != frame.len) {
+                error = "write failed, storage full?";
+            } else {
+                received += frame.len;
+                fileCrc = crc32_le(fileCrc, buf, frame.len);
+                sendFrame(XFER_ACK, expected++);
+            }
+        } else if (frame.type == XFER_DATA && frame.seq == (uint16_t)(expected - 1)) {
+            sendFrame(XFER_ACK, frame.seq); // already written, the ACK got lost
+        } else if (frame.type == XFER_END && frame.seq == expected && frame.len == 8) {
+            uint32_t endSize, endCrc;
+            memcpy(&endSize, buf, 4);
+            memcpy(&endCrc, buf + 4, 4);
+            if (endSize != received || received != size) {
+                error = "size mismatch";
+            } else if (endCrc != fileCrc) {
+                error = "CRC mismatch";
+            } else {
+                sendFrame(XFER_ACK, frame.seq);
+                done = true;
+            }
+        } else {
+            sendFrame(XFER_NAK, expected);
+        }
+    }
+    if (error) sendFrame(XFER_ABORT, expected);
+    file.close();
+    free(buf);
+
+    if (done) {
+        fs.remove(path);
+        if (!fs.rename(partPath, path)) error = "rename failed";
+    }
+    if (error) fs.remove(partPath);
+    endTransfer(error, received, start);
+    return error == NULL;
+}
+
+/*********************************************************************
+**  Function: serialSendFile
+**  Send the file frame by frame, each one when the client asks for it
+**********************************************************************/
+bool serialSendFile(FS &fs, const String &path, uint32_t baud) {
+    File file = fs.open(path, FILE_READ);
+    if (!file || file.isDirectory()) {
+        if (file) file.close();
+        Serial.println("XFER FAIL cannot open file");
+        return false;
+    }
+    uint8_t *buf = xferBuffer();
+    if (!buf) {
+        file.close();
+        Serial.println("XFER FAIL out of memory");
+        return false;
+    }
+
+    uint32_t size = file.size();
+    beginTransfer(size, baud);
+    uint32_t start = millis();
+    uint32_t sent = 0; // bytes acknowledged by the client
+    uint32_t fileCrc = 0;
+    uint16_t seq = 0;
+    uint16_t len = 0;
+    bool loaded = false; // buf holds frame seq
+    int retries = 0;
+    const char *error = NULL;
+    bool done = false;
+
+    while (!done && !error) {
+        XferFrame frame;
+        uint8_t reply[8];
+        XferRead read = readFrame(frame, reply, sizeof(reply), XFER_TIMEOUT_MS);
+        if (read != XFER_FRAME) {
+            // The client asks again for what it misses, nothing to resend from here
+            if (++retries > XFER_RETRIES) error = read == XFER_TIMEOUT ? "timeout" : "too many bad frames";
+            continue;
+        }
+        retries = 0;
+
+        bool isEnd = sent == size;
+        if (frame.type == XFER_ABORT) {
+            error = "aborted by the client";
+            continue;
+        } else if (loaded && ((frame.type == XFER_ACK && frame.seq == seq) ||
+                              (frame.type == XFER_NAK && frame.seq == (uint16_t)(seq + 1) && !isEnd))) {
+            // Asking for the next frame also acknowledges this one, in case its ACK got lost
+            if (isEnd) {
+                done = true;
+                continue;
+            }
+            sent += len;
+            seq++;
+            loaded = false;
+            isEnd = sent == size;
+        } else if (frame.type != XFER_NAK || frame.seq != seq) {
+            continue;
+        }
+
+        if (!loaded && !isEnd) {
+            len = file.read(buf, min((uint32_t)XFER_CHUNK, size - sent));
+            if (len == 0) {
+                error = "read failed";
+                continue;
+            }
+            fileCrc = crc32_le(fileCrc, buf, len);
+        }
+        loaded = true;
+        if (isEnd) {
+            uint32_t end[2] = {size, fileCrc};
+            sendFrame(XFER_END, seq, (const uint8_t *)end, sizeof(end));
+        } else {
+            sendFrame(XFER_DATA, seq, buf, len);
+        }
+    }
+    if (error) sendFrame(XFER_ABORT, seq);
+    file.close();
+    free(buf);
+    endTransfer(error, sent, start);
+    return error == NULL;
+}
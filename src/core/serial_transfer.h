@@ -0,0 +1,41 @@
+#ifndef __SERIAL_TRANSFER_H__
+#define __SERIAL_TRANSFER_H__
+
+#include <FS.h>
+
+// Largest payload of a data frame
+#ifndef XFER_CHUNK
+#define XFER_CHUNK 4096
+#endif
+// Time without a frame before the last one is asked again
+#ifndef XFER_TIMEOUT_MS
+#define XFER_TIMEOUT_MS 2000
+#endif
+// Bad or missing frames in a row before the transfer is given up
+#ifndef XFER_RETRIES
+#define XFER_RETRIES 8
+#endif
+
+/*
+ * Binary file transfer over the serial console, used by "storage put" and
+ * "storage get" (client in tools/serial_transfer).
+ *
+ * The device prints "XFER READY <size> <chunk> <baud>" and switches to baud
+ * when it isn't 0. Then every frame is
+ *   0xB5 0x5B, type, seq (u16), length (u16), payload, CRC32 of type..payload
+ * with numbers in little endian. The receiver drives the transfer: "N" asks
+ * for frame seq (the first one is N 0), "A" acknowledges it once it is
+ * written. "N seq + 1" acknowledges it too, so a lost ACK only costs a
+ * timeout, after which the last frame is sent again. The sender sends "D"
+ * frames of up to XFER_CHUNK bytes, then an "E" frame with the size and the
+ * CRC32 of the whole file. "X" aborts.
+ * Back at the console speed the device prints "XFER OK <bytes> <ms>" or
+ * "XFER FAIL <reason>".
+ */
+
+// Receives size bytes into path, the file is replaced only once the transfer is complete
+bool serialReceiveFile(FS &fs, const String &path, uint32_t size, uint32_t baud = 0);
+
+bool serialSendFile(FS &fs, const String &path, uint32_t baud = 0);
+
+#endif
@@ -2,21 +2,71 @@
 #include "utils.h"
 #include <globals.h>
 
-void handleSerialCommands() {
-    if (!Serial.available()) return;
+static TaskHandle_t serialCmdsTask = NULL;
+static String cmdLine;           // line being received
+static uint32_t cmdLineLastByte; // millis() of its last byte
+
+#if ARDUINO_USB_CDC_ON_BOOT
+static void onSerialRx(void *arg, esp_event_base_t base, int32_t id, void *data) {
+    if (serialCmdsTask) xTaskNotifyGive(serialCmdsTask);
+}
+#else
+static void onSerialRx() {
+    if (serialCmdsTask) xTaskNotifyGive(serialCmdsTask);
+}
+#endif
 
-    String cmd_str = Serial.readStringUntil('\n');
+static void runCommand() {
+    String cmd_str = cmdLine;
+    cmdLine = "";
     serialCli.parse(cmd_str);
     Serial.print("# "); // prompt
     backToMenu();       // forced menu redrawn
 }
 
+/*********************************************************************
+**  Function: readCommandLine
+**  Reads up to the end of one line, the bytes after it stay in the
+**  Serial buffer for the commands that read their data themselves
+**  (storage write/put)
+**********************************************************************/
+static bool readCommandLine() {
+    while (Serial.available()) {
+        int c = Serial.read();
+        if (c < 0) break;
+        cmdLineLastByte = millis();
+        if (c == '\n') return true;
+        cmdLine += (char)c;
+    }
+    return false;
+}
+
+void handleSerialCommands() {
+    while (readCommandLine()) runCommand();
+
+    // Like readStringUntil() did, a line without '\n' runs once nothing else came for the Serial timeout
+    if (cmdLine.length() && millis() - cmdLineLastByte >= Serial.getTimeout()) runCommand();
+}
+
 void _serialCmdsTaskLoop(void *pvParameters) {
     Serial.begin(115200);
+    cmdLine.reserve(64);
+    serialCmdsTask = xTaskGetCurrentTaskHandle();
+
+    // Woken up by the driver as soon as something is received, instead of polling
+#if ARDUINO_USB_CDC_ON_BOOT && ARDUINO_USB_MODE
+    Serial.onEvent(ARDUINO_HW_CDC_RX_EVENT, onSerialRx);
+#elif ARDUINO_USB_CDC_ON_BOOT
+    Serial.onEvent(ARDUINO_USB_CDC_RX_EVENT, onSerialRx);
+#else
+    Serial.onReceive(onSerialRx);
+#endif
 
     while (1) {
         handleSerialCommands();
-        vTaskDelay(500);
+        // The timeout only matters for an unfinished line, or if a Serial.begin() elsewhere lost the callback
+        uint32_t wait = cmdLine.length() ? Serial.getTimeout() : SERIAL_CMDS_IDLE_MS;
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait));
     }
 }
 
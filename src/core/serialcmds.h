@@ -3,6 +3,11 @@
 
 #include <Arduino.h>
 
+// Longest sleep of the serial commands task when no byte is received, it is woken up on RX
+#ifndef SERIAL_CMDS_IDLE_MS
+#define SERIAL_CMDS_IDLE_MS 100
+#endif
+
 void handleSerialCommands();
 
 void startSerialCommandsHandlerTask();
@@ -760,6 +760,7 @@ void runClockLoop() {
 #endif
             Serial.print("Current time: ");
             Serial.println(timeStr);
+            tft.beginFrame("clock");
             tft.setTextColor(bruceConfig.priColor, bruceConfig.bgColor);
             tft.drawRect(
                 BORDER_PAD_X,
@@ -793,6 +794,7 @@ void runClockLoop() {
 #else
             tft.drawCentreString(timeStr, tftWidth / 2, tftHeight / 2 - 13, 1);
 #endif
+            tft.endFrame();
             tmp = millis();
         }
 
@@ -153,7 +153,9 @@ void tft_logger::checkAndLog(tftFuncs f, std::initializer_list<int32_t> values)
 
 void tft_logger::fillScreen(int32_t color) {
     if (logging) clearLog();
+    profileIn((uint32_t)width() * height());
     BRUCE_TFT_DRIVER::fillScreen(color);
+    profileOut();
 }
 
 void tft_logger::imageToBin(uint8_t fs, String file, int x, int y, bool center, int Ms) {
@@ -210,13 +212,17 @@ void tft_logger::imageToBin(uint8_t fs, String file, int x, int y, bool center,
 
 void tft_logger::drawLine(int32_t x, int32_t y, int32_t x1, int32_t y1, int32_t color) {
     if (logging) checkAndLog(DRAWLINE, {x, y, x1, y1, color});
+    profileIn(max<int32_t>(abs(x1 - x), abs(y1 - y)) + 1, min<int32_t>(abs(x1 - x), abs(y1 - y)) + 1);
     BRUCE_TFT_DRIVER::drawLine(x, y, x1, y1, color);
+    profileOut();
     restoreLogger();
 }
 
 void tft_logger::drawRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t color) {
     if (logging) checkAndLog(DRAWRECT, {x, y, w, h, color});
+    profileIn(2 * (w + h), 4);
     BRUCE_TFT_DRIVER::drawRect(x, y, w, h, color);
+    profileOut();
     restoreLogger();
 }
 
@@ -225,13 +231,17 @@ void tft_logger::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t co
         if (w > 4 && h > 4) removeLogEntriesInsideRect(x, y, w, h);
         checkAndLog(FILLRECT, {x, y, w, h, color});
     }
+    profileIn(w * h);
     BRUCE_TFT_DRIVER::fillRect(x, y, w, h, color);
+    profileOut();
     restoreLogger();
 }
 
 void tft_logger::drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, int32_t color) {
     if (logging) checkAndLog(DRAWROUNDRECT, {x, y, w, h, r, color});
+    profileIn(2 * (w + h), 4 + 4 * r);
     BRUCE_TFT_DRIVER::drawRoundRect(x, y, w, h, r, color);
+    profileOut();
     restoreLogger();
 }
 
@@ -240,31 +250,41 @@ void tft_logger::fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32
         removeLogEntriesInsideRect(x, y, w, h);
         checkAndLog(FILLROUNDRECT, {x, y, w, h, r, color});
     }
+    profileIn(w * h, 1 + 2 * r);
     BRUCE_TFT_DRIVER::fillRoundRect(x, y, w, h, r, color);
+    profileOut();
     restoreLogger();
 }
 
 void tft_logger::drawCircle(int32_t x, int32_t y, int32_t r, int32_t color) {
     if (logging) checkAndLog(DRAWCIRCLE, {x, y, r, color});
+    profileIn(6.28f * r, 6.28f * r);
     BRUCE_TFT_DRIVER::drawCircle(x, y, r, color);
+    profileOut();
     restoreLogger();
 }
 
 void tft_logger::fillCircle(int32_t x, int32_t y, int32_t r, int32_t color) {
     if (logging) checkAndLog(FILLCIRCLE, {x, y, r, color});
+    profileIn(3.14f * r * r, 2 * r);
     BRUCE_TFT_DRIVER::fillCircle(x, y, r, color);
+    profileOut();
     restoreLogger();
 }
 
 void tft_logger::drawEllipse(int16_t x, int16_t y, int32_t rx, int32_t ry, uint16_t color) {
     if (logging) checkAndLog(DRAWELIPSE, {x, y, rx, ry, color});
+    profileIn(3.14f * (rx + ry), 3.14f * (rx + ry));
     BRUCE_TFT_DRIVER::drawEllipse(x, y, rx, ry, color);
+    profileOut();
     restoreLogger();
 }
 
 void tft_logger::fillEllipse(int16_t x, int16_t y, int32_t rx, int32_t ry, uint16_t color) {
     if (logging) checkAndLog(FILLELIPSE, {x, y, rx, ry, color});
+    profileIn(3.14f * rx * ry, 2 * ry);
     BRUCE_TFT_DRIVER::fillEllipse(x, y, rx, ry, color);
+    profileOut();
     restoreLogger();
 }
 
@@ -272,7 +292,9 @@ void tft_logger::drawTriangle(
     int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t x3, int32_t y3, int32_t color
 ) {
     if (logging) checkAndLog(DRAWTRIAGLE, {x1, y1, x2, y2, x3, y3, color});
+    profileIn(abs(x2 - x1) + abs(y2 - y1) + abs(x3 - x2) + abs(y3 - y2) + abs(x1 - x3) + abs(y1 - y3), 3);
     BRUCE_TFT_DRIVER::drawTriangle(x1, y1, x2, y2, x3, y3, color);
+    profileOut();
     restoreLogger();
 }
 
@@ -280,7 +302,12 @@ void tft_logger::fillTriangle(
     int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t x3, int32_t y3, int32_t color
 ) {
     if (logging) checkAndLog(FILLTRIANGLE, {x1, y1, x2, y2, x3, y3, color});
+    profileIn(
+        abs((x2 - x1) * (y3 - y1) - (x3 - x1) * (y2 - y1)) / 2,
+        max<int32_t>(y1, max<int32_t>(y2, y3)) - min<int32_t>(y1, min<int32_t>(y2, y3)) + 1
+    );
     BRUCE_TFT_DRIVER::fillTriangle(x1, y1, x2, y2, x3, y3, color);
+    profileOut();
     restoreLogger();
 }
 void tft_logger::drawArc(
@@ -292,7 +319,10 @@ void tft_logger::drawArc(
             DRAWARC,
             {x, y, r, ir, (int32_t)startAngle, (int32_t)endAngle, (int32_t)fg_color, (int32_t)bg_color}
         );
+    uint32_t arcAngle = endAngle > startAngle ? endAngle - startAngle : endAngle + 360 - startAngle;
+    profileIn((r - ir + 1) * 6.28f * r * arcAngle / 360, 6.28f * r);
     BRUCE_TFT_DRIVER::drawArc(x, y, r, ir, startAngle, endAngle, fg_color, bg_color, smoothArc);
+    profileOut();
     restoreLogger();
 }
 
@@ -301,19 +331,25 @@ void tft_logger::drawWideLine(float ax, float ay, float bx, float by, float wd,
         checkAndLog(
             DRAWWIDELINE, {(uint16_t)ax, (uint16_t)ay, (uint16_t)bx, (uint16_t)by, (uint16_t)wd, fg, bg}
         );
+    profileIn((fabsf(bx - ax) + fabsf(by - ay)) * wd, fabsf(bx - ax) + fabsf(by - ay));
     BRUCE_TFT_DRIVER::drawWideLine(ax, ay, bx, by, wd, fg, bg);
+    profileOut();
     restoreLogger();
 }
 
 void tft_logger::drawFastVLine(int32_t x, int32_t y, int32_t h, int32_t fg) {
     if (logging) checkAndLog(DRAWFASTVLINE, {x, y, h, fg});
+    profileIn(h);
     BRUCE_TFT_DRIVER::drawFastVLine(x, y, h, fg);
+    profileOut();
     restoreLogger();
 }
 
 void tft_logger::drawFastHLine(int32_t x, int32_t y, int32_t w, int32_t fg) {
     if (logging) checkAndLog(DRAWFASTHLINE, {x, y, w, fg});
+    profileIn(w);
     BRUCE_TFT_DRIVER::drawFastHLine(x, y, w, fg);
+    profileOut();
     restoreLogger();
 }
 
@@ -350,21 +386,28 @@ void tft_logger::log_drawString(String s, tftFuncs fn, int32_t x, int32_t y) {
 
 int16_t tft_logger::drawString(const String &string, int32_t x, int32_t y, uint8_t font) {
     log_drawString(string, DRAWSTRING, x, y);
+    // textWidth walks the glyphs, only pay for it while profiling
+    if (profiling) profileIn(textWidth(string.c_str()) * fontHeight(), string.length());
     int16_t r = BRUCE_TFT_DRIVER::drawString(string, x, y, font);
+    profileOut();
     restoreLogger();
     return r;
 }
 
 int16_t tft_logger::drawCentreString(const String &string, int32_t x, int32_t y, uint8_t font) {
     log_drawString(string, DRAWCENTRESTRING, x, y);
+    if (profiling) profileIn(textWidth(string.c_str()) * fontHeight(), string.length());
     int16_t r = BRUCE_TFT_DRIVER::drawCentreString(string, x, y, font);
+    profileOut();
     restoreLogger();
     return r;
 }
 
 int16_t tft_logger::drawRightString(const String &string, int32_t x, int32_t y, uint8_t font) {
     log_drawString(string, DRAWRIGHTSTRING, x, y);
+    if (profiling) profileIn(textWidth(string.c_str()) * fontHeight(), string.length());
     int16_t r = BRUCE_TFT_DRIVER::drawRightString(string, x, y, font);
+    profileOut();
     restoreLogger();
     return r;
 }
@@ -406,6 +449,8 @@ size_t tft_logger::print(const String &s) {
 
     const int maxChunkSize = MAX_LOG_SIZE - 13; // 13 bytes reserved to header + metadata
 
+    if (profiling) profileIn(textWidth(s.c_str()) * fontHeight(), s.length());
+
     while (remaining > 0) {
         int chunkSize = (remaining > maxChunkSize) ? maxChunkSize : remaining;
         String chunk = s.substring(offset, offset + chunkSize);
@@ -416,6 +461,7 @@ size_t tft_logger::print(const String &s) {
         offset += chunkSize;
         remaining -= chunkSize;
     }
+    profileOut();
 
     return totalPrinted;
 }
@@ -468,3 +514,132 @@ size_t tft_logger::printf(const char *format, ...) {
     va_end(args);
     return print(String(buf));
 }
+
+/* FRAME PROFILER */
+void tft_logger::setProfiling(bool enable, bool overlay) {
+    profiling = enable;
+    profileOverlay = enable && overlay;
+    profileDepth = 0;
+    frameDepth = 0;
+}
+
+void tft_logger::resetProfile() {
+    memset(profileStats, 0, sizeof(profileStats));
+    framePrimitives = framePixels = frameSpiBytes = 0;
+}
+
+void tft_logger::profileIn(uint32_t pixels, uint32_t windows) {
+    if (!profiling) return;
+    if (profileDepth++ > 0) return;
+    framePrimitives++;
+    framePixels += pixels;
+    // Each address window costs CASET + RASET + RAMWR (11 bytes), then 2 bytes per RGB565 pixel
+    frameSpiBytes += windows * 11 + pixels * 2;
+}
+
+void tft_logger::profileOut() {
+    if (profileDepth > 0) profileDepth--;
+}
+
+void tft_logger::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data) {
+    profileIn(w * h);
+    BRUCE_TFT_DRIVER::pushImage(x, y, w, h, data);
+    profileOut();
+}
+
+/*********************************************************************
+**  Function: beginFrame / endFrame
+**  Frames may be nested (ex: a menu hover lambda drawing a menu item),
+**  only the outermost pair is measured
+**********************************************************************/
+void tft_logger::beginFrame(const char *name) {
+    if (!profiling) return;
+    if (frameDepth++ > 0) return;
+    frameName = name;
+    framePrimitives = framePixels = frameSpiBytes = 0;
+    frameStart = micros();
+}
+
+void tft_logger::endFrame() {
+    if (!profiling || frameDepth == 0) return;
+    if (--frameDepth > 0) return;
+    uint32_t elapsed = micros() - frameStart;
+
+    tftFrameStats *st = nullptr;
+    for (int i = 0; i < MAX_PROFILE_SCREENS; i++) {
+        if (profileStats[i].name == nullptr || strcmp(profileStats[i].name, frameName) == 0) {
+            st = &profileStats[i];
+            break;
+        }
+    }
+    if (st == nullptr) st = &profileStats[MAX_PROFILE_SCREENS - 1]; // table full, reuse the last slot
+    if (st->name == nullptr || strcmp(st->name, frameName) != 0) {
+        memset(st, 0, sizeof(tftFrameStats));
+        st->name = frameName;
+    }
+
+    st->frames++;
+    st->lastUs = elapsed;
+    st->totalUs += elapsed;
+    if (elapsed > st->maxUs) st->maxUs = elapsed;
+    st->primitives = framePrimitives;
+    st->pixels = framePixels;
+    st->spiBytes = frameSpiBytes;
+
+    if (profileOverlay) drawProfileOverlay(*st);
+}
+
+void tft_logger::printProfile(Print &out) {
+    out.println("screen,frames,last_ms,avg_ms,max_ms,primitives,pixels,spi_bytes");
+    for (int i = 0; i < MAX_PROFILE_SCREENS; i++) {
+        const tftFrameStats &st = profileStats[i];
+        if (st.name == nullptr) continue;
+        out.printf(
+            "%s,%lu,%.2f,%.2f,%.2f,%lu,%lu,%lu\n",
+            st.name,
+            st.frames,
+            st.lastUs / 1000.0,
+            st.totalUs / 1000.0 / st.frames,
+            st.maxUs / 1000.0,
+            st.primitives,
+            st.pixels,
+            st.spiBytes
+        );
+    }
+}
+
+void tft_logger::drawProfileOverlay(const tftFrameStats &st) {
+#ifdef HAS_SCREEN
+    char line[64];
+    snprintf(
+        line,
+        sizeof(line),
+        "%s %.1fms %lup %lukpx %lukB",
+        st.name,
+        st.lastUs / 1000.0,
+        st.primitives,
+        st.pixels / 1000,
+        st.spiBytes / 1024
+    );
+
+    // The overlay is neither logged nor counted in the frame
+    bool oldLogging = logging, oldLogging_ = _logging;
+    logging = _logging = false;
+    profileDepth++;
+    uint32_t fg = textcolor, bg = textbgcolor;
+    uint8_t size = textsize, datum = getTextDatum();
+
+    setTextSize(1);
+    setTextColor(TFT_GREEN, TFT_BLACK);
+    setTextDatum(TL_DATUM);
+    BRUCE_TFT_DRIVER::fillRect(0, height() - 8, width(), 8, TFT_BLACK);
+    BRUCE_TFT_DRIVER::drawString(line, 0, height() - 8, 1);
+
+    setTextSize(size);
+    setTextColor(fg, bg);
+    setTextDatum(datum);
+    profileDepth--;
+    logging = oldLogging;
+    _logging = oldLogging_;
+#endif
+}
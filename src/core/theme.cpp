@@ -1,5 +1,7 @@
 #include "theme.h"
 #include "display.h"
+#include "icon_cache.h"
+#include <esp32/rom/crc.h>
 
 struct ThemeEntry {
     const char *key;
@@ -10,13 +12,15 @@ struct ThemeEntry {
 void BruceTheme::removeTheme(void) {
     themeInfo t;
     theme = t;
+    themeFileCrc = 0;
+    iconCache.clear();
 }
 FS *BruceTheme::themeFS(void) {
     if (theme.fs == 1) return &LittleFS;
     else if (theme.fs == 2) return &SD;
     return &LittleFS; // always get back to safety
 }
-bool BruceTheme::openThemeFile(FS *fs, String filepath) {
+bool BruceTheme::openThemeFile(FS *fs, String filepath, bool deferUi) {
 
     if (fs == nullptr) return true;
     if (!fs->exists(filepath)) return false;
@@ -28,10 +32,18 @@ bool BruceTheme::openThemeFile(FS *fs, String filepath) {
         return false;
     }
 
+    String content = file.readString();
+    file.close();
+    uint32_t crc = crc32_le(0, (const uint8_t *)content.c_str(), content.length());
+    iconCache.clear(); // drop icons decoded from the previous theme, or older copies of this one
+    // Same file as the one in the config snapshot: skip the parsing and the exists() of every image
+    if (crc == themeFileCrc && filepath == themePath && theme.fs != 0 && fs == themeFS()) return true;
+
     // Deserialize the JSON document
     JsonDocument jsonDoc;
-    if (deserializeJson(jsonDoc, file)) {
-        displayError("5", true);
+    if (deserializeJson(jsonDoc, content)) {
+        if (deferUi) _deferredError = "5";
+        else displayError("5", true);
         log_e("THEME: %s. Using default theme", "Failed reading theme file");
         removeTheme();
         return false;
@@ -82,16 +94,68 @@ bool BruceTheme::openThemeFile(FS *fs, String filepath) {
     if (!_th["border"].isNull()) { theme.border = _th["border"].as<int>(); }
     if (!_th["label"].isNull()) { theme.label = _th["label"].as<int>(); }
 
-    file.close();
-    _setUiColor(_priColor, &_secColor, &_bgColor);
+    if (deferUi) {
+        _deferredColors = true;
+        _deferredPri = _priColor;
+        _deferredSec = _secColor;
+        _deferredBg = _bgColor;
+    } else {
+        _setUiColor(_priColor, &_secColor, &_bgColor);
+    }
 
     if (fs == &LittleFS) theme.fs = 1;
     else if (fs == &SD) theme.fs = 2;
     else theme.fs = 0;
 
+    if (theme.fs != 0 && crc != themeFileCrc) {
+        themeFileCrc = crc;
+        // so the snapshot holds the new theme state
+        if (deferUi) _deferredSave = true;
+        else bruceConfig.saveFile();
+    }
+
     return true;
 }
 
+void BruceTheme::applyDeferredTheme(void) {
+    if (_deferredError) displayError(_deferredError, true);
+    if (_deferredColors) _setUiColor(_deferredPri, &_deferredSec, &_deferredBg);
+    if (_deferredSave) bruceConfig.saveFile();
+    _deferredError = nullptr;
+    _deferredColors = false;
+    _deferredSave = false;
+}
+
+void BruceTheme::preloadIcons(void) {
+    if (theme.fs == 0) return;
+    // In the order of the main menu
+    std::pair<bool, String &> icons[] = {
+        {theme.wifi,        theme.paths.wifi       },
+        {theme.ble,         theme.paths.ble        },
+        {theme.ethernet,    theme.paths.ethernet   },
+        {theme.rf,          theme.paths.rf         },
+        {theme.rfid,        theme.paths.rfid       },
+        {theme.fm,          theme.paths.fm         },
+        {theme.ir,          theme.paths.ir         },
+        {theme.files,       theme.paths.files      },
+        {theme.gps,         theme.paths.gps        },
+        {theme.nrf,         theme.paths.nrf        },
+        {theme.interpreter, theme.paths.interpreter},
+        {theme.others,      theme.paths.others     },
+        {theme.clock,       theme.paths.clock      },
+        {theme.connect,     theme.paths.connect    },
+        {theme.config,      theme.paths.config     }
+    };
+    uint32_t start = millis();
+    int count = 0;
+    for (auto &icon : icons) {
+        // Leave room for the icons drawn later
+        if (iconCache.getUsedBytes() >= iconCache.getBudget() / 2) break;
+        if (icon.first && iconCache.preload(*themeFS(), getThemeItemImg(icon.second))) count++;
+    }
+    log_i("THEME: %d icons preloaded in %lums", count, millis() - start);
+}
+
 bool BruceTheme::validateImgFile(FS *fs, String filepath) {
     // Think of a way to check if the images are at maximum height of tftHeight
     // this size is the maximun value to be shown on screen without overlapping the status bar.
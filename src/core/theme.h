@@ -58,6 +58,8 @@ class BruceTheme {
 public:
     themeInfo theme;
     String themePath = "";
+    // CRC32 of the theme file "theme" was read from, 0 when it must be read again
+    uint32_t themeFileCrc = 0;
 
     // Theme colors in RGB565 format
     uint16_t priColor = DEFAULT_PRICOLOR;
@@ -67,13 +69,27 @@ public:
     // UI Color
     void _setUiColor(uint16_t primary, uint16_t *secondary = nullptr, uint16_t *background = nullptr);
 
-    bool openThemeFile(FS *fs, String filepath);
+    // With deferUi nothing is drawn and the colours are not changed, so it can run in a boot task
+    // while the UI task sets up the screen. applyDeferredTheme() then does it from the UI task
+    bool openThemeFile(FS *fs, String filepath, bool deferUi = false);
+    void applyDeferredTheme(void);
+    bool themeBgPending(void) { return _deferredColors && _deferredBg != bgColor; }
     bool validateImgFile(FS *fs, String filepath);
     String getThemeItemImg(String item) {
         return themePath.substring(0, themePath.lastIndexOf('/')) + "/" + item;
     };
     void removeTheme(void);
+    // Decodes the menu icons into the icon cache, up to half of its budget
+    void preloadIcons(void);
     FS *themeFS(void);
+
+private:
+    const char *_deferredError = nullptr; // displayError code
+    bool _deferredColors = false;
+    uint16_t _deferredPri = 0;
+    uint16_t _deferredSec = 0;
+    uint16_t _deferredBg = 0;
+    bool _deferredSave = false;
 };
 
 #endif
@@ -1,4 +1,6 @@
 #include "webInterface.h"
+#include "core/boot_profile.h"
+#include "core/copy_engine.h"
 #include "core/display.h"    // using displayRedStripe as error msg
 #include "core/mykeyboard.h" // using keyboard when calling rename
 #include "core/passwords.h"
@@ -10,6 +12,25 @@
 #include "esp_task_wdt.h"
 #include "webFiles.h"
 #include <globals.h>
+#include <memory>
+#include <vector>
+
+// Size of the upload coalescing buffer, the filesystem is written in blocks of this size
+#ifndef UPLOAD_BUFFER_PSRAM
+#define UPLOAD_BUFFER_PSRAM 32768
+#endif
+#ifndef UPLOAD_BUFFER_HEAP
+#define UPLOAD_BUFFER_HEAP 8192
+#endif
+// Buffer used to shift the file tail when a patch changes its size
+#ifndef EDIT_COPY_BUFFER
+#define EDIT_COPY_BUFFER 4096
+#endif
+
+// Older generated webFiles.h do not carry the checksum, the firmware version is used instead
+#ifndef WEB_FILES_CHECKSUM
+#define WEB_FILES_CHECKSUM BRUCE_VERSION
+#endif
 
 File uploadFile;
 FS _webFS = LittleFS;
@@ -74,51 +95,415 @@ String humanReadableSize(uint64_t bytes) {
 
 /**********************************************************************
 **  Function: listFiles
-**  list all of the files, if ishtml=true, return html rather than simple text
+**  Stream the folder content as a chunked response, one line per entry:
+**  "pa:folder:0", then "Fo:name:0" for folders and "Fi:name:size" for files.
+**  The directory is iterated once and only the current line is kept in
+**  memory, the WebUI sorts the entries on its side.
 **********************************************************************/
-String listFiles(FS fs, String folder) {
-    // log_i("Listfiles Start");
-    String returnText = "pa:" + folder + ":0\n";
+struct ListFilesState {
+    File root;
+    String pending;        // line being sent, may be split between chunks
+    size_t pendingPos = 0; // bytes of "pending" already sent
+    bool done = false;
+};
+
+void listFiles(AsyncWebServerRequest *request, FS &fs, String folder) {
+    auto state = std::make_shared<ListFilesState>();
+    state->pending = "pa:" + folder + ":0\n";
     Serial.println("Listing files stored on SD");
 
     _webFS = fs;
-
-    File root = fs.open(folder);
-    File foundfile = root.openNextFile();
     if (folder == "//") folder = "/";
     uploadFolder = folder;
-    String PreFolder = folder;
-    PreFolder = PreFolder.substring(0, PreFolder.lastIndexOf("/"));
-    if (PreFolder == "") PreFolder = "/";
-
-    if (folder == "/") folder = "";
-    while (foundfile) {
-        if (esp_get_free_heap_size() > (String("Fo:" + String(foundfile.name()) + ":0\n").length()) + 1024) {
-            if (foundfile.isDirectory()) returnText += "Fo:" + String(foundfile.name()) + ":0\n";
-        } else break;
-        foundfile = root.openNextFile();
-        esp_task_wdt_reset();
+
+    state->root = fs.open(folder);
+    if (!state->root || !state->root.isDirectory()) state->done = true;
+
+    AsyncWebServerResponse *response = request->beginChunkedResponse(
+        "text/plain",
+        [state](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+            size_t len = 0;
+            while (len < maxLen) {
+                if (state->pendingPos >= state->pending.length()) {
+                    if (state->done) break;
+                    File entry = state->root.openNextFile();
+                    if (!entry) {
+                        state->done = true;
+                        state->root.close();
+                        break;
+                    }
+                    if (entry.isDirectory()) state->pending = "Fo:" + String(entry.name()) + ":0\n";
+                    else
+                        state->pending =
+                            "Fi:" + String(entry.name()) + ":" + humanReadableSize(entry.size()) + "\n";
+                    entry.close();
+                    state->pendingPos = 0;
+                    esp_task_wdt_reset();
+                }
+                size_t n = min(maxLen - len, state->pending.length() - state->pendingPos);
+                memcpy(buffer + len, state->pending.c_str() + state->pendingPos, n);
+                len += n;
+                state->pendingPos += n;
+            }
+            return len;
+        }
+    );
+    request->send(response);
+}
+
+/**********************************************************************
+**  Function: sendFileRange
+**  Send a file honoring a single "Range: bytes=a-b", "bytes=a-" or
+**  "bytes=-n" header with a 206 answer, so interrupted downloads can be
+**  resumed. Multiple or malformed ranges are ignored, the whole file is
+**  sent; a range starting past the end gets a 416.
+**********************************************************************/
+void sendFileRange(
+    AsyncWebServerRequest *request, FS &fs, const String &fileName, const String &contentType
+) {
+    auto file = std::make_shared<File>(fs.open(fileName, FILE_READ));
+    if (!*file || file->isDirectory()) {
+        request->send(500, "text/plain", "Failed to open file for reading");
+        return;
     }
-    root.close();
-    foundfile.close();
-
-    if (folder == "") folder = "/";
-    root = fs.open(folder);
-    foundfile = root.openNextFile();
-    while (foundfile) {
-        if (esp_get_free_heap_size() > (String("Fo:" + String(foundfile.name()) + ":0\n").length()) + 1024) {
-            if (!(foundfile.isDirectory()))
-                returnText +=
-                    "Fi:" + String(foundfile.name()) + ":" + humanReadableSize(foundfile.size()) + "\n";
-        } else break;
-        foundfile = root.openNextFile();
+    size_t fileSize = file->size();
+    size_t start = 0;
+    size_t end = fileSize ? fileSize - 1 : 0;
+    bool partial = false;
+
+    if (request->hasHeader("Range")) {
+        String range = request->header("Range");
+        range.trim();
+        int dash = range.indexOf('-');
+        if (range.startsWith("bytes=") && dash > 0 && range.indexOf(',') < 0) {
+            String first = range.substring(6, dash);
+            String last = range.substring(dash + 1);
+            first.trim();
+            last.trim();
+            bool valid = true;
+            if (first.length() == 0) {
+                // suffix range: last n bytes, "bytes=-0" selects nothing
+                size_t n = strtoull(last.c_str(), nullptr, 10);
+                if (last.length() == 0) valid = false;
+                else start = n == 0 ? fileSize : n >= fileSize ? 0 : fileSize - n;
+            } else {
+                start = strtoull(first.c_str(), nullptr, 10);
+                if (last.length() > 0) {
+                    size_t lastByte = strtoull(last.c_str(), nullptr, 10);
+                    if (lastByte < start) valid = false;
+                    else end = min(lastByte, end);
+                }
+            }
+            if (!valid) {
+                // malformed, like "bytes=-" or "bytes=9-5": ignored, the whole file is sent
+                start = 0;
+            } else if (start >= fileSize) {
+                AsyncWebServerResponse *response = request->beginResponse(416, "text/plain", "");
+                response->addHeader("Content-Range", "bytes */" + String(fileSize));
+                request->send(response);
+                return;
+            } else {
+                partial = true;
+            }
+        }
+    }
+
+    size_t length = fileSize ? end - start + 1 : 0;
+    if (start > 0) file->seek(start);
+    AsyncWebServerResponse *response = request->beginResponse(
+        contentType,
+        length,
+        [file, length](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+            if (index >= length) {
+                file->close();
+                return 0;
+            }
+            int n = file->read(buffer, min(maxLen, length - index));
+            return n > 0 ? n : 0;
+        }
+    );
+    response->addHeader("Accept-Ranges", "bytes");
+    if (partial) {
+        response->setCode(206);
+        response->addHeader(
+            "Content-Range", "bytes " + String(start) + "-" + String(end) + "/" + String(fileSize)
+        );
+    }
+    String name = fileName.substring(fileName.lastIndexOf('/') + 1);
+    response->addHeader("Content-Disposition", "attachment; filename=\"" + name + "\"");
+    request->send(response);
+}
+
+/**********************************************************************
+**  Function: sendFilePage
+**  Send "length" bytes of a file starting at "offset", so the editor can
+**  page through files larger than the free heap. The total size goes in
+**  X-File-Size and the actual page bounds in X-Page-Offset/-Length.
+**********************************************************************/
+void sendFilePage(
+    AsyncWebServerRequest *request, FS &fs, const String &fileName, size_t offset, size_t length
+) {
+    auto file = std::make_shared<File>(fs.open(fileName, FILE_READ));
+    if (!*file || file->isDirectory()) {
+        request->send(500, "text/plain", "Failed to open file for reading");
+        return;
+    }
+    size_t fileSize = file->size();
+    if (offset > fileSize) {
+        request->send(416, "text/plain", "Offset beyond end of file");
+        return;
+    }
+    length = min(length, fileSize - offset);
+    if (offset > 0) file->seek(offset);
+    AsyncWebServerResponse *response = request->beginResponse(
+        "application/octet-stream",
+        length,
+        [file, length](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+            if (index >= length) {
+                file->close();
+                return 0;
+            }
+            int n = file->read(buffer, min(maxLen, length - index));
+            return n > 0 ? n : 0;
+        }
+    );
+    response->addHeader("X-File-Size", String(fileSize));
+    response->addHeader("X-Page-Offset", String(offset));
+    response->addHeader("X-Page-Length", String(length));
+    response->addHeader("Access-Control-Expose-Headers", "X-File-Size, X-Page-Offset, X-Page-Length");
+    request->send(response);
+}
+
+/**********************************************************************
+**  Function: sendFileHash
+**  Hash a file in a worker task: hashing a multi-MB file inside the
+**  async_tcp callback would stall the server. The chunked response
+**  answers RESPONSE_TRY_AGAIN until the digest is ready. The 200 status
+**  is sent by then, so a read failure comes as a "FAIL hashing:" body.
+**********************************************************************/
+struct HashJob {
+    FS *fs;
+    String fileName;
+    FileHashType type;
+    String digest;
+    volatile bool done;
+};
+
+static void hashJobTask(void *arg) {
+    auto job = (std::shared_ptr<HashJob> *)arg;
+    (*job)->digest = hashFile(*(*job)->fs, (*job)->fileName, (*job)->type);
+    if ((*job)->digest.length() == 0) (*job)->digest = "FAIL hashing: " + (*job)->fileName;
+    (*job)->done = true;
+    delete job; // the response may be gone already, the last owner frees the job
+    vTaskDelete(NULL);
+}
+
+void sendFileHash(AsyncWebServerRequest *request, FS &fs, const String &fileName, FileHashType type) {
+    File file = fs.open(fileName, FILE_READ);
+    bool isFile = file && !file.isDirectory();
+    if (file) file.close();
+    if (!isFile) {
+        request->send(500, "text/plain", "FAIL hashing: " + fileName);
+        return;
+    }
+
+    auto job = std::make_shared<HashJob>();
+    job->fs = &fs;
+    job->fileName = fileName;
+    job->type = type;
+    job->done = false;
+    auto taskJob = new std::shared_ptr<HashJob>(job);
+    if (xTaskCreate(hashJobTask, "webHash", 6144, taskJob, 1, NULL) != pdPASS) {
+        delete taskJob;
+        request->send(500, "text/plain", "Not enough memory");
+        return;
+    }
+
+    AsyncWebServerResponse *response = request->beginChunkedResponse(
+        "text/plain",
+        [job](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+            if (!job->done) return RESPONSE_TRY_AGAIN;
+            if (index >= job->digest.length()) return 0;
+            size_t n = min(maxLen, job->digest.length() - index);
+            memcpy(buffer, job->digest.c_str() + index, n);
+            return n;
+        }
+    );
+    request->send(response);
+}
+
+/**********************************************************************
+**  Function: sendFolderTar
+**  Stream a folder and its subfolders as an uncompressed ustar archive,
+**  built on the fly. Each folder's names are listed when it is entered,
+**  so only the current file is open while sending: keeping every parent
+**  directory open would run out of SD file handles in deep trees.
+**********************************************************************/
+struct TarFolder {
+    String path;
+    std::vector<String> names;
+    size_t next = 0;
+};
+
+struct TarState {
+    FS *fs;
+    std::vector<TarFolder> folders; // folders being sent, deepest last
+    size_t stripLen;                // length of the path prefix removed from the entry names
+    File current;
+    size_t remaining = 0; // file bytes still to send
+    size_t padding = 0;   // zeros completing the last 512 byte block of the file
+    uint8_t block[512];
+    size_t blockLen = 0;
+    size_t blockPos = 0;
+    int trailer = 2;     // two empty blocks close the archive
+    bool failed = false; // an entry could not be opened, the archive is incomplete
+};
+
+static bool tarHeader(TarState *st, String name, size_t size, time_t mtime, char type) {
+    memset(st->block, 0, sizeof(st->block));
+    char *h = (char *)st->block;
+
+    // Names longer than 100 chars are split in prefix (155) + name (100) at a '/'
+    String prefix = "";
+    if (name.length() > 100) {
+        int cut = name.lastIndexOf('/', name.length() - 2);
+        while (cut > 0 && (cut > 155 || name.length() - cut - 1 > 100)) cut = name.lastIndexOf('/', cut - 1);
+        if (cut <= 0 || cut > 155 || name.length() - cut - 1 > 100) {
+            log_w("TAR: path too long, skipping %s", name.c_str());
+            return false;
+        }
+        prefix = name.substring(0, cut);
+        name = name.substring(cut + 1);
+    }
+    memcpy(h, name.c_str(), name.length());
+    snprintf(h + 100, 8, "%07o", type == '5' ? 0755 : 0644);
+    snprintf(h + 108, 8, "%07o", 0);
+    snprintf(h + 116, 8, "%07o", 0);
+    snprintf(h + 124, 12, "%011llo", (unsigned long long)size);
+    snprintf(h + 136, 12, "%011llo", (unsigned long long)(mtime > 0 ? mtime : 0));
+    h[156] = type;
+    memcpy(h + 257, "ustar", 6);
+    memcpy(h + 263, "00", 2);
+    memcpy(h + 345, prefix.c_str(), prefix.length());
+
+    // checksum is computed with its own field filled with spaces
+    memset(h + 148, ' ', 8);
+    unsigned int sum = 0;
+    for (int i = 0; i < 512; i++) sum += st->block[i];
+    snprintf(h + 148, 8, "%06o", sum);
+    h[155] = ' ';
+
+    st->blockLen = 512;
+    st->blockPos = 0;
+    return true;
+}
+
+static size_t tarFill(TarState *st, uint8_t *buffer, size_t maxLen) {
+    size_t len = 0;
+    while (len < maxLen) {
+        if (st->blockPos < st->blockLen) {
+            size_t n = min(maxLen - len, st->blockLen - st->blockPos);
+            memcpy(buffer + len, st->block + st->blockPos, n);
+            st->blockPos += n;
+            len += n;
+            continue;
+        }
+        if (st->remaining) {
+            size_t n = min(maxLen - len, st->remaining);
+            int r = st->current.read(buffer + len, n);
+            if (r <= 0) {
+                // file shrank while being sent, keep the archive consistent
+                memset(buffer + len, 0, n);
+                r = n;
+            }
+            st->remaining -= r;
+            len += r;
+            continue;
+        }
+        if (st->current) st->current.close();
+        if (st->padding) {
+            memset(st->block, 0, st->padding);
+            st->blockLen = st->padding;
+            st->blockPos = 0;
+            st->padding = 0;
+            continue;
+        }
+        if (st->folders.empty()) {
+            if (st->trailer == 0) break;
+            st->trailer--;
+            memset(st->block, 0, sizeof(st->block));
+            st->blockLen = 512;
+            st->blockPos = 0;
+            continue;
+        }
+
+        TarFolder &folder = st->folders.back();
+        if (folder.next == folder.names.size()) {
+            st->folders.pop_back();
+            continue;
+        }
+        String path = folder.path + (folder.path.endsWith("/") ? "" : "/") + folder.names[folder.next++];
+        File entry = st->fs->open(path);
+        if (!entry) {
+            log_e("TAR: could not open %s", path.c_str());
+            st->failed = true;
+            break;
+        }
+        String name = path.substring(st->stripLen);
+        if (entry.isDirectory()) {
+            if (tarHeader(st, name + "/", 0, entry.getLastWrite(), '5')) {
+                TarFolder sub;
+                sub.path = path;
+                sub.names = listFolder(entry);
+                st->folders.push_back(sub);
+            }
+            entry.close();
+        } else if (tarHeader(st, name, entry.size(), entry.getLastWrite(), '0')) {
+            st->remaining = entry.size();
+            st->padding = (512 - st->remaining % 512) % 512;
+            st->current = entry;
+        }
         esp_task_wdt_reset();
     }
-    root.close();
-    foundfile.close();
+    return len;
+}
+
+void sendFolderTar(AsyncWebServerRequest *request, FS &fs, String folder) {
+    if (folder.length() > 1 && folder.endsWith("/")) folder.remove(folder.length() - 1);
+    File root = fs.open(folder);
+    if (!root || !root.isDirectory()) {
+        request->send(400, "text/plain", "ERROR: not a folder");
+        return;
+    }
 
-    // log_i("ListFiles End");
-    return returnText;
+    auto state = std::make_shared<TarState>();
+    state->fs = &fs;
+    String name = folder.substring(folder.lastIndexOf('/') + 1);
+    if (name == "") name = "root";
+    // Entries are named relative to the parent folder, so the archive extracts into "name/"
+    state->stripLen = folder.lastIndexOf('/') + 1;
+    if (folder != "/") tarHeader(state.get(), name + "/", 0, root.getLastWrite(), '5');
+    TarFolder top;
+    top.path = folder;
+    top.names = listFolder(root);
+    root.close();
+    state->folders.push_back(top);
+
+    AsyncClient *client = request->client();
+    AsyncWebServerResponse *response = request->beginChunkedResponse(
+        "application/x-tar",
+        [state, client](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+            size_t len = tarFill(state.get(), buffer, maxLen);
+            if (state->failed) {
+                // Ending the chunks would look like a complete archive, drop the connection instead
+                client->abort();
+                return 0;
+            }
+            return len;
+        }
+    );
+    response->addHeader("Content-Disposition", "attachment; filename=\"" + name + ".tar\"");
+    request->send(response);
 }
 
 /**********************************************************************
@@ -161,6 +546,216 @@ void createDirRecursive(String path, FS fs) {
         startIndex = endIndex + 1;
     }
 }
+/**********************************************************************
+**  Upload pipeline
+**  TCP chunks are coalesced into a block sized buffer so the filesystem
+**  only sees full, block aligned writes. Encrypted uploads go through a
+**  streaming XOR stage before the buffer, so any file size is accepted.
+**  The state lives in request->_tempObject, which the request frees.
+**********************************************************************/
+struct UploadState {
+    uint32_t startMs;
+    size_t received;   // bytes received from the client
+    size_t written;    // bytes written to the filesystem
+    size_t cipherPos;  // position in the plaintext, selects the key byte
+    bool encrypt;
+    bool failed;
+    uint8_t key[16];
+    size_t bufSize;
+    size_t fill;
+    uint8_t buf[];
+};
+
+static void uploadFlush(AsyncWebServerRequest *request, UploadState *st) {
+    if (st->fill == 0) return;
+    if (!request->_tempFile || request->_tempFile.write(st->buf, st->fill) != st->fill) st->failed = true;
+    st->written += st->fill;
+    st->fill = 0;
+}
+
+static void uploadAppend(AsyncWebServerRequest *request, UploadState *st, const uint8_t *data, size_t len) {
+    while (len) {
+        // Whole blocks skip the copy when the buffer is empty
+        if (st->fill == 0 && len >= st->bufSize) {
+            size_t n = len - (len % st->bufSize);
+            if (!request->_tempFile || request->_tempFile.write(data, n) != n) st->failed = true;
+            st->written += n;
+            data += n;
+            len -= n;
+            continue;
+        }
+        size_t n = min(len, st->bufSize - st->fill);
+        memcpy(st->buf + st->fill, data, n);
+        st->fill += n;
+        data += n;
+        len -= n;
+        if (st->fill == st->bufSize) uploadFlush(request, st);
+    }
+}
+
+static void uploadEncrypt(AsyncWebServerRequest *request, UploadState *st, const uint8_t *data, size_t len) {
+    static const char digits[] = "0123456789ABCDEF";
+    uint8_t hex[32 * 3];
+    while (len) {
+        size_t n = min(len, (size_t)32);
+        size_t pos = 0;
+        for (size_t i = 0; i < n; i++) {
+            uint8_t c = data[i] ^ st->key[st->cipherPos++ % 16];
+            hex[pos++] = digits[c >> 4];
+            hex[pos++] = digits[c & 0x0F];
+            hex[pos++] = ' ';
+        }
+        uploadAppend(request, st, hex, pos);
+        data += n;
+        len -= n;
+    }
+}
+
+static UploadState *uploadBegin(AsyncWebServerRequest *request) {
+    const size_t sizes[] = {psramFound() ? UPLOAD_BUFFER_PSRAM : UPLOAD_BUFFER_HEAP, 4096, 512};
+    UploadState *st = nullptr;
+    for (size_t size : sizes) {
+        size_t total = sizeof(UploadState) + size;
+        st = (UploadState *)(psramFound() ? ps_malloc(total) : malloc(total));
+        if (st) {
+            memset(st, 0, sizeof(UploadState));
+            st->bufSize = size;
+            break;
+        }
+    }
+    if (!st) return nullptr;
+
+    st->startMs = millis();
+    if (request->hasArg("password")) {
+        st->encrypt = true;
+        xorKeyMD5(request->arg("password"), st->key);
+        String header = encryptedFileHeader();
+        uploadAppend(request, st, (const uint8_t *)header.c_str(), header.length());
+    }
+    return st;
+}
+
+/**********************************************************************
+**  Edit patch pipeline
+**  POST /editpatch?fs=&name=&offset=&remove= replaces "remove" bytes at
+**  "offset" with the raw request body. Same sized patches are written in
+**  place; otherwise the file is rebuilt into a temp file (head, body,
+**  tail) through a fixed buffer and renamed over the original, so the
+**  memory used does not depend on the file or the patch size.
+**********************************************************************/
+struct EditPatchState {
+    bool started;
+    bool inPlace;
+    bool failed;
+    bool tmpKept; // the original is gone and the rename failed, the new content is in name.tmp
+    size_t offset;
+    size_t remove;
+    size_t received;
+};
+
+// name, fs and a numeric offset are required, checked before anything is written
+static bool editPatchArgsValid(AsyncWebServerRequest *request) {
+    if (!request->hasArg("name") || !request->hasArg("fs") || !request->hasArg("offset")) return false;
+    const String &offset = request->arg("offset");
+    if (offset.length() == 0) return false;
+    for (size_t i = 0; i < offset.length(); i++) {
+        if (!isDigit(offset[i])) return false;
+    }
+    return request->arg("name").length() > 0;
+}
+
+static FS *editPatchFs(AsyncWebServerRequest *request) {
+    if (request->arg("fs") == "SD") return setupSdCard() ? (FS *)&SD : nullptr;
+    return LittleFS.begin() ? (FS *)&LittleFS : nullptr;
+}
+
+// Copy "len" bytes from the current position of "from" to "to"
+static bool copyFileRange(File &from, File &to, size_t len) {
+    uint8_t stackBuf[256];
+    size_t bufSize = EDIT_COPY_BUFFER;
+    uint8_t *buf = (uint8_t *)malloc(bufSize);
+    if (!buf) {
+        buf = stackBuf;
+        bufSize = sizeof(stackBuf);
+    }
+    bool ok = true;
+    while (len && ok) {
+        int n = from.read(buf, min(len, bufSize));
+        ok = n > 0 && to.write(buf, n) == (size_t)n;
+        len -= n > 0 ? n : 0;
+    }
+    if (buf != stackBuf) free(buf);
+    return ok;
+}
+
+static void editPatchBegin(AsyncWebServerRequest *request, EditPatchState *st, size_t bodySize) {
+    st->started = true;
+    FS *fs = editPatchFs(request);
+    String fileName = request->arg("name");
+    File file = fs ? fs->open(fileName, FILE_READ) : File();
+    if (!file || file.isDirectory()) {
+        st->failed = true;
+        return;
+    }
+    size_t fileSize = file.size();
+    st->offset = min((size_t)strtoull(request->arg("offset").c_str(), nullptr, 10), fileSize);
+    st->remove = request->hasArg("remove") ? strtoull(request->arg("remove").c_str(), nullptr, 10) : bodySize;
+    st->remove = min(st->remove, fileSize - st->offset);
+    st->inPlace = st->remove == bodySize;
+
+    if (st->inPlace) {
+        file.close();
+        request->_tempFile = fs->open(fileName, "r+");
+        if (!request->_tempFile || !request->_tempFile.seek(st->offset)) st->failed = true;
+        return;
+    }
+    request->_tempFile = fs->open(fileName + ".tmp", FILE_WRITE);
+    if (!request->_tempFile || !copyFileRange(file, request->_tempFile, st->offset)) st->failed = true;
+    file.close();
+}
+
+static void editPatchFinish(AsyncWebServerRequest *request, EditPatchState *st) {
+    if (st->failed || st->inPlace) {
+        if (request->_tempFile) request->_tempFile.close();
+        return;
+    }
+    FS *fs = editPatchFs(request);
+    String fileName = request->arg("name");
+    String tmpName = fileName + ".tmp";
+    File file = fs->open(fileName, FILE_READ);
+    if (!file || !file.seek(st->offset + st->remove) ||
+        !copyFileRange(file, request->_tempFile, file.size() - st->offset - st->remove)) {
+        st->failed = true;
+    }
+    if (file) file.close();
+    request->_tempFile.close();
+
+    if (st->failed) {
+        fs->remove(tmpName); // the original is untouched
+    } else if (!replaceFile(*fs, tmpName, fileName)) {
+        st->failed = true;
+        st->tmpKept = fs->exists(tmpName);
+    }
+}
+
+void handleEditPatch(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+    if (!checkUserWebAuth(request) || !editPatchArgsValid(request)) return;
+    if (index == 0) {
+        if (request->_tempObject) free(request->_tempObject);
+        request->_tempObject = calloc(1, sizeof(EditPatchState));
+        if (!request->_tempObject) return;
+        editPatchBegin(request, (EditPatchState *)request->_tempObject, total);
+    }
+    EditPatchState *st = (EditPatchState *)request->_tempObject;
+    if (st == nullptr) return;
+    if (!st->failed && request->_tempFile.write(data, len) != len) st->failed = true;
+    st->received += len;
+    if (index + len >= total) {
+        editPatchFinish(request, st);
+        if (!st->failed) fileChanged(*editPatchFs(request), request->arg("name"));
+    }
+}
+
 /**********************************************************************
 **  Function: handleUpload
 ** handles uploads to the filserver
@@ -187,30 +782,43 @@ void handleUpload(
                 vTaskDelay(pdMS_TO_TICKS(5));
                 goto RETRY;
             }
+            if (request->_tempObject) free(request->_tempObject); // previous file of the same request
+            request->_tempObject = uploadBegin(request);
         }
 
+        UploadState *st = (UploadState *)request->_tempObject;
         if (len) {
-            if (request->hasArg("password")) {
-                // encryption requested
-                static int chunck_no = 0;
-                if (chunck_no != 0) {
-                    // TODO: handle multiple chunks
-                    request->send(404, "text/html", "file is too big");
+            if (st == nullptr) {
+                // No memory for the pipeline, plain uploads are still written as they come
+                if (request->hasArg("password")) {
+                    request->send(500, "text/plain", "Not enough memory to encrypt");
                     return;
-                } else chunck_no += 1;
-                String enc_password = request->arg("password");
-                String plaintext = String((char *)data).substring(0, len);
-                String cyphertxt = encryptString(plaintext, enc_password);
-                if (cyphertxt == "") { return; }
-                if (request->_tempFile)
-                    request->_tempFile.write((const uint8_t *)cyphertxt.c_str(), cyphertxt.length());
-            } else {
+                }
                 if (request->_tempFile) request->_tempFile.write(data, len);
+            } else {
+                st->received += len;
+                if (st->encrypt) uploadEncrypt(request, st, data, len);
+                else uploadAppend(request, st, data, len);
             }
         }
         if (final) {
+            if (st) {
+                if (st->encrypt) uploadAppend(request, st, (const uint8_t *)"\n", 1);
+                uploadFlush(request, st);
+                uint32_t elapsed = max<uint32_t>(1, millis() - st->startMs);
+                Serial.printf(
+                    "Upload: %u bytes received, %u written in %lu ms (%.2f MB/s, %u byte blocks)%s\n",
+                    st->received,
+                    st->written,
+                    elapsed,
+                    st->received / 1048.576 / elapsed,
+                    st->bufSize,
+                    st->failed ? " WRITE ERROR" : ""
+                );
+            }
             // close the file handle as the upload is now done
             if (request->_tempFile) request->_tempFile.close();
+            fileChanged(_webFS, uploadFolder + "/" + filename);
         }
     }
 }
@@ -277,6 +885,64 @@ String color565ToWebHex(uint16_t color565) {
     return String(hex);
 }
 
+/**********************************************************************
+**  Function: sendNotModified
+**  Answer 304 if the browser already holds the resource tagged "etag",
+**  otherwise returns false so the caller sends the full content
+**********************************************************************/
+bool sendNotModified(AsyncWebServerRequest *request, const String &etag) {
+    if (!request->hasHeader("If-None-Match") || request->header("If-None-Match") != etag) return false;
+    AsyncWebServerResponse *response = request->beginResponse(304);
+    response->addHeader("ETag", etag);
+    response->addHeader("Cache-Control", "private, no-cache");
+    request->send(response);
+    return true;
+}
+
+/**********************************************************************
+**  Function: sendEmbeddedGzip
+**  Send one of the gzipped files of webFiles.h with a strong ETag derived
+**  from the web_interface checksum, revalidated on every page load
+**********************************************************************/
+void sendEmbeddedGzip(
+    AsyncWebServerRequest *request, const char *contentType, const uint8_t *data, size_t size,
+    const char *name
+) {
+    String etag = "\"" + String(WEB_FILES_CHECKSUM).substring(0, 16) + "-" + name + "\"";
+    if (sendNotModified(request, etag)) return;
+
+    AsyncWebServerResponse *response = request->beginResponse(200, contentType, data, size);
+    response->addHeader("Content-Encoding", "gzip");
+    response->addHeader("ETag", etag);
+    response->addHeader("Cache-Control", "private, no-cache");
+    request->send(response);
+}
+
+/**********************************************************************
+**  Function: themeCss
+**  theme.css is rebuilt only when the UI colors change
+**********************************************************************/
+const char *themeCss() {
+    static char css[96] = "";
+    static uint16_t colors[3] = {0, 0, 0};
+
+    if (css[0] == 0 || colors[0] != bruceConfig.priColor || colors[1] != bruceConfig.secColor ||
+        colors[2] != bruceConfig.bgColor) {
+        colors[0] = bruceConfig.priColor;
+        colors[1] = bruceConfig.secColor;
+        colors[2] = bruceConfig.bgColor;
+        snprintf(
+            css,
+            sizeof(css),
+            ":root{--color:%s;--sec-color:%s;--background:%s;}",
+            color565ToWebHex(colors[0]).c_str(),
+            color565ToWebHex(colors[1]).c_str(),
+            color565ToWebHex(colors[2]).c_str()
+        );
+    }
+    return css;
+}
+
 /**********************************************************************
 **  Function: configureWebServer
 **  configure web server
@@ -291,7 +957,17 @@ void configureWebServer() {
     server->on(
         "/upload",
         HTTP_POST,
-        [](AsyncWebServerRequest *request) { request->send(200, "text/plain", "File upload completed"); },
+        [](AsyncWebServerRequest *request) {
+            UploadState *st = (UploadState *)request->_tempObject;
+            if (st && st->failed) return request->send(500, "text/plain", "Failed writing the file");
+            if (st == nullptr) return request->send(200, "text/plain", "File upload completed");
+            uint32_t elapsed = max<uint32_t>(1, millis() - st->startMs);
+            request->send(
+                200,
+                "text/plain",
+                "File upload completed (" + String(st->received / 1048.576 / elapsed, 2) + " MB/s)"
+            );
+        },
         handleUpload
     );
 
@@ -338,30 +1014,35 @@ void configureWebServer() {
     });
     server->on("/theme.css", HTTP_GET, [](AsyncWebServerRequest *request) {
         if (checkUserWebAuth(request)) {
-            String css = ":root{--color:" + color565ToWebHex(bruceConfig.priColor) +
-                         ";--sec-color:" + color565ToWebHex(bruceConfig.secColor) +
-                         ";--background:" + color565ToWebHex(bruceConfig.bgColor) + ";}";
-            request->send(200, "text/css", css);
+            char etag[24];
+            snprintf(
+                etag,
+                sizeof(etag),
+                "\"%04X%04X%04X\"",
+                bruceConfig.priColor,
+                bruceConfig.secColor,
+                bruceConfig.bgColor
+            );
+            if (sendNotModified(request, etag)) return;
+
+            AsyncWebServerResponse *response = request->beginResponse(200, "text/css", themeCss());
+            response->addHeader("ETag", etag);
+            response->addHeader("Cache-Control", "private, no-cache");
+            request->send(response);
         } else {
             request->requestAuthentication();
         }
     });
     server->on("/index.css", HTTP_GET, [](AsyncWebServerRequest *request) {
         if (checkUserWebAuth(request)) {
-            AsyncWebServerResponse *response =
-                request->beginResponse(200, "text/css", index_css, index_css_size);
-            response->addHeader("Content-Encoding", "gzip");
-            request->send(response);
+            sendEmbeddedGzip(request, "text/css", index_css, index_css_size, "css");
         } else {
             return request->requestAuthentication();
         }
     });
     server->on("/index.js", HTTP_GET, [](AsyncWebServerRequest *request) {
         if (checkUserWebAuth(request)) {
-            AsyncWebServerResponse *response =
-                request->beginResponse(200, "application/javascript", index_js, index_js_size);
-            response->addHeader("Content-Encoding", "gzip");
-            request->send(response);
+            sendEmbeddedGzip(request, "application/javascript", index_js, index_js_size, "js");
         } else {
             return request->requestAuthentication();
         }
@@ -394,6 +1075,14 @@ void configureWebServer() {
         request->send(200, "application/json", response_body);
     });
 
+    server->on("/bootprofile", HTTP_GET, [](AsyncWebServerRequest *request) {
+        if (checkUserWebAuth(request)) {
+            request->send(200, "application/json", bootProfileJson());
+        } else {
+            request->requestAuthentication();
+        }
+    });
+
     server->on("/getscreen", HTTP_GET, [](AsyncWebServerRequest *request) {
         uint8_t binData[MAX_LOG_ENTRIES * MAX_LOG_SIZE];
         size_t binSize = 0;
@@ -431,15 +1120,12 @@ void configureWebServer() {
             String filePath = request->arg("filePath").c_str();
             String filePath2 = filePath.substring(0, filePath.lastIndexOf('/') + 1) + fileName;
             // Rename the file of folder
-            if (fs == "SD") {
-                if (SD.rename(filePath, filePath2))
-                    request->send(200, "text/plain", filePath + " renamed to " + filePath2);
-                else request->send(200, "text/plain", "Fail renaming file.");
-            } else {
-                if (LittleFS.rename(filePath, filePath2))
-                    request->send(200, "text/plain", filePath + " renamed to " + filePath2);
-                else request->send(200, "text/plain", "Fail renaming file.");
-            }
+            FS &renameFs = fs == "SD" ? (FS &)SD : (FS &)LittleFS;
+            if (renameFs.rename(filePath, filePath2)) {
+                fileChanged(renameFs, filePath, true);
+                fileChanged(renameFs, filePath2);
+                request->send(200, "text/plain", filePath + " renamed to " + filePath2);
+            } else request->send(200, "text/plain", "Fail renaming file.");
         }
     });
 
@@ -480,11 +1166,10 @@ void configureWebServer() {
         if (checkUserWebAuth(request)) {
             String folder = "/";
             if (request->hasArg("folder")) { folder = request->arg("folder"); }
-            bool useSD = false;
             if (strcmp(request->arg("fs").c_str(), "SD") == 0) {
-                request->send(200, "text/plain", listFiles(SD, folder));
+                listFiles(request, SD, folder);
             } else {
-                request->send(200, "text/plain", listFiles(LittleFS, folder));
+                listFiles(request, LittleFS, folder);
             }
 
         } else {
@@ -520,6 +1205,7 @@ void configureWebServer() {
                         File newFile = (*fs).open(fileName, FILE_WRITE, true);
                         if (newFile) {
                             newFile.close();
+                            fileChanged(*fs, fileName);
                             request->send(200, "text/plain", "Created new file: " + String(fileName));
                         } else {
                             request->send(200, "text/plain", "FAIL creating file: " + String(fileName));
@@ -528,7 +1214,9 @@ void configureWebServer() {
 
                 } else {
                     if (strcmp(fileAction.c_str(), "download") == 0) {
-                        request->send(*fs, fileName, "application/octet-stream", true);
+                        sendFileRange(request, *fs, fileName, "application/octet-stream");
+                    } else if (strcmp(fileAction.c_str(), "downloadfolder") == 0) {
+                        sendFolderTar(request, *fs, fileName);
                     } else if (strcmp(fileAction.c_str(), "image") == 0) {
                         String extension = fileName.substring(fileName.lastIndexOf('.') + 1);
                         // https://www.iana.org/assignments/media-types/media-types.xhtml#image
@@ -555,6 +1243,22 @@ void configureWebServer() {
                             request->send(200, "text/plain", "FAIL creating file: " + String(fileName));
                         }
 
+                    } else if (strcmp(fileAction.c_str(), "read") == 0) {
+                        size_t offset = strtoull(request->arg("offset").c_str(), nullptr, 10);
+                        size_t length = request->hasArg("length")
+                                            ? strtoull(request->arg("length").c_str(), nullptr, 10)
+                                            : SIZE_MAX;
+                        sendFilePage(request, *fs, fileName, offset, length);
+                    } else if (strcmp(fileAction.c_str(), "hash") == 0) {
+                        String algo = request->hasArg("algo") ? request->arg("algo") : "sha256";
+                        FileHashType type = HASH_SHA256;
+                        if (algo == "md5") type = HASH_MD5;
+                        else if (algo == "crc32") type = HASH_CRC32;
+                        else if (algo != "sha256") {
+                            request->send(400, "text/plain", "ERROR: algo must be md5, crc32 or sha256");
+                            return;
+                        }
+                        sendFileHash(request, *fs, fileName, type);
                     } else if (strcmp(fileAction.c_str(), "edit") == 0) {
                         File editFile = (*fs).open(fileName, FILE_READ);
                         if (editFile) {
@@ -602,6 +1306,7 @@ void configureWebServer() {
                         request->send(500, "text/plain", "Failed to write to file: " + fileName);
                     }
                     editFile.close();
+                    fileChanged(*fs, fileName);
                 } else {
                     request->send(500, "text/plain", "Failed to open file for writing: " + fileName);
                 }
@@ -613,6 +1318,45 @@ void configureWebServer() {
         }
     });
 
+    server->on(
+        "/editpatch",
+        HTTP_POST,
+        [](AsyncWebServerRequest *request) {
+            if (!checkUserWebAuth(request)) return request->requestAuthentication();
+            if (!editPatchArgsValid(request)) {
+                return request->send(400, "text/plain", "ERROR: name, fs and offset parameters required");
+            }
+            String fileName = request->arg("name");
+            EditPatchState *st = (EditPatchState *)request->_tempObject;
+            if (st == nullptr && request->contentLength() > 0) {
+                return request->send(500, "text/plain", "Not enough memory");
+            }
+            if (st == nullptr) {
+                // Empty body, the patch only removes bytes
+                st = (EditPatchState *)calloc(1, sizeof(EditPatchState));
+                if (st == nullptr) return request->send(500, "text/plain", "Not enough memory");
+                request->_tempObject = st;
+                editPatchBegin(request, st, 0);
+                editPatchFinish(request, st);
+            }
+            if (st->tmpKept) {
+                String msg = "Failed to replace " + fileName + ", the edited file is " + fileName + ".tmp";
+                return request->send(500, "text/plain", msg);
+            }
+            if (st->failed) return request->send(500, "text/plain", "Failed to patch file: " + fileName);
+            File file = editPatchFs(request)->open(fileName, FILE_READ);
+            size_t fileSize = file ? file.size() : 0;
+            if (file) file.close();
+            AsyncWebServerResponse *response =
+                request->beginResponse(200, "text/plain", "File edited: " + fileName);
+            response->addHeader("X-File-Size", String(fileSize));
+            response->addHeader("Access-Control-Expose-Headers", "X-File-Size");
+            request->send(response);
+        },
+        nullptr,
+        handleEditPatch
+    );
+
     // Wi-Fi configuration on web page
     server->on("/wifi", HTTP_GET, [](AsyncWebServerRequest *request) {
         if (checkUserWebAuth(request)) {
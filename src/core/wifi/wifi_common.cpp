@@ -1,4 +1,5 @@
 #include "core/wifi/wifi_common.h"
+#include "core/boot_profile.h"
 #include "core/display.h"    // using displayRedStripe  and loop options
 #include "core/mykeyboard.h" // usinf keyboard when calling rename
 #include "core/powerSave.h"
@@ -186,6 +187,8 @@ void wifiConnectTask(void *pvParameters) {
                 wifiConnected = true;
                 wifiIP = WiFi.localIP().toString();
                 updateClockTimezone();
+                // Started by setup(), don't draw over the splash screen
+                bootWaitFor(BOOT_MENU);
                 drawStatusBar();
                 break;
             }
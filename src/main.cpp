@@ -1,6 +1,7 @@
 #include "core/main_menu.h"
 #include <globals.h>
 
+#include "core/boot_profile.h"
 #include "core/powerSave.h"
 #include "core/serial_commands/cli.h"
 #include "core/utils.h"
@@ -148,7 +149,9 @@ volatile int tftHeight = VECTOR_DISPLAY_DEFAULT_WIDTH;
  *********************************************************************/
 void begin_storage() {
     if (!LittleFS.begin(true)) { LittleFS.format(), LittleFS.begin(); }
+    bootMark("sd mount");
     bool checkFS = setupSdCard();
+    bootMark("config");
     bruceConfig.fromFile(checkFS);
     bruceConfigPins.fromFile(checkFS);
 }
@@ -341,6 +344,30 @@ void init_led() {
 #endif
 }
 
+/*********************************************************************
+ **  Function: load_theme
+ **  Theme state and menu icons, ready before the splash screen. Errors
+ **  and colours are applied by setup() once the TFT is configured
+ *********************************************************************/
+void load_theme() {
+    bruceConfig.openThemeFile(bruceConfig.themeFS(), bruceConfig.themePath, true);
+    // PNG icons are blended with the background colour, if it changes they are decoded on first use
+    if (!bruceConfig.themeBgPending()) bruceConfig.preloadIcons();
+}
+
+/*********************************************************************
+ **  Function: theme_bus_free
+ **  The theme task can't read the SD while the TFT is drawn on the same bus
+ *********************************************************************/
+bool theme_bus_free() {
+    if (bruceConfig.themeFS() != &SD) return true;
+#if defined(USE_TFT_eSPI_TOUCH)
+    return false; // SD on the default SPI bus
+#else
+    return bruceConfigPins.SDCARD_bus.mosi != (gpio_num_t)TFT_MOSI;
+#endif
+}
+
 /*********************************************************************
  **  Function: startup_sound
  **  Play sound or tone depending on device hardware
@@ -392,7 +419,9 @@ void setup() {
     BLEConnected = false;
     bruceConfig.bright = 100; // theres is no value yet
     bruceConfig.rotation = ROTATION;
+    bootMark("gpio");
     setup_gpio();
+    bootMark("tft init");
 #if defined(HAS_SCREEN)
     tft.init();
     tft.setRotation(bruceConfig.rotation);
@@ -403,12 +432,34 @@ void setup() {
 #else
     tft.begin();
 #endif
+    // Phases that don't depend on each other run in tasks, see boot_profile.h
+    bootTask("clock", init_clock, 0, BOOT_CLOCK, 3072);
+    bootMark("littlefs");
     begin_storage();
+    bootMark(NULL);
+    bootStageDone(BOOT_CONFIG);
+    bootTask("led", init_led, BOOT_CONFIG, BOOT_LED);
+    bootTask("theme", load_theme, BOOT_CONFIG, BOOT_THEME, 8192, theme_bus_free());
+
+    // The RTC shares the I2C bus with the screen backlight of some boards
+    bootWaitFor(BOOT_CLOCK, "wait clock");
+    if (bruceConfig.wifiAtStartup) {
+        // Started early so the scan runs during the splash screen, it waits for BOOT_MENU to draw
+        xTaskCreate(
+            wifiConnectTask,   // Task function
+            "wifiConnectTask", // Task Name
+            4096,              // Stack size
+            NULL,              // Task parameters
+            2,                 // Task priority (0 to 3), loopTask has priority 2.
+            NULL               // Task handle (not used)
+        );
+    }
+    bootMark("tft config");
     begin_tft();
-    init_clock();
-    init_led();
 
     // Some GPIO Settings (such as CYD's brightness control must be set after tft and sdcard)
+    bootWaitFor(BOOT_LED, "wait led");
+    bootMark("post gpio");
     _post_setup_gpio();
     // end of post gpio begin
 
@@ -423,27 +474,22 @@ void setup() {
         &xHandle          // Task handle (not used)
     );
     // #endif
-    bruceConfig.openThemeFile(bruceConfig.themeFS(), bruceConfig.themePath);
+    bootMark(NULL);
+    bootWaitFor(BOOT_THEME, "wait theme");
+    bruceConfig.applyDeferredTheme();
     if (!bruceConfig.instantBoot) {
+        bootMark("splash");
         boot_screen_anim();
         startup_sound();
     }
 
-    if (bruceConfig.wifiAtStartup) {
-        xTaskCreate(
-            wifiConnectTask,   // Task function
-            "wifiConnectTask", // Task Name
-            4096,              // Stack size
-            NULL,              // Task parameters
-            2,                 // Task priority (0 to 3), loopTask has priority 2.
-            NULL               // Task handle (not used)
-        );
-    }
-
     //  start a task to handle serial commands while the webui is running
+    bootMark("serial cli");
     startSerialCommandsHandlerTask();
 
+    bootMark("wake screen");
     wakeUpScreen();
+    bootProfileFinish();
 
     if (bruceConfig.startupApp != "" && !startupApp.startApp(bruceConfig.startupApp)) {
         bruceConfig.setStartupApp("");
@@ -460,17 +506,7 @@ void loop() {
     // called by 'stack canary watchpoint triggered (loopTask)'
 #if !defined(LITE_VERSION)
     if (interpreter_start) {
-        TaskHandle_t interpreterTaskHandler = NULL;
-        xTaskCreate(
-            interpreterHandler,     // Task function
-            "interpreterHandler",   // Task Name
-            16384,                  // Stack size
-            NULL,                   // Task parameters
-            2,                      // Task priority (0 to 3), loopTask has priority 2.
-            &interpreterTaskHandler // Task handle
-        );
-
-        while (interpreter_start == true) { vTaskDelay(pdMS_TO_TICKS(500)); }
+        runInterpreterService();
         interpreter_start = false;
         previousMillis = millis(); // ensure that will not dim screen when get back to menu
     }
@@ -49,6 +49,7 @@ String scanChannels(SPIClass *SSPI, bool web) {
 
     digitalWrite(NRF24_CE_PIN, HIGH);
 
+    tft.beginFrame("nrfSpectrum");
     for (int i = 0; i < CHANNELS; i++) {
         int level = rpdValues[i];
         int x = i * _BW;
@@ -70,6 +71,7 @@ String scanChannels(SPIClass *SSPI, bool web) {
             result += String(level);
         }
     }
+    tft.endFrame();
 
     if (web) result += "}";
     return result; // return a string in this format "{1,32,45,32,84,32 .... 12,54,65}" with 80 values to be
@@ -0,0 +1,116 @@
+#include "bytecode_cache.h"
+#include <esp32/rom/crc.h>
+#include <globals.h>
+
+#if defined(DUK_USE_BYTECODE_DUMP_SUPPORT)
+// Bytecode is only valid for the Duktape build that dumped it, so the
+// build date is part of the key: dev builds share the same BRUCE_VERSION
+#define BYTECODE_CACHE_BUILD BRUCE_VERSION " " __DATE__ " " __TIME__
+
+struct BytecodeCacheHeader {
+    char magic[4]; // "BJSC"
+    uint32_t duktapeVersion;
+    char build[32];
+    uint32_t compileFlags;
+    uint32_t sourceCrc;
+    uint32_t sourceLen;
+    uint32_t bytecodeCrc;
+    uint32_t bytecodeLen;
+};
+
+static void fillHeader(BytecodeCacheHeader &header, duk_uint_t flags, uint32_t crc, duk_size_t len) {
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "BJSC", 4);
+    header.duktapeVersion = DUK_VERSION;
+    strncpy(header.build, BYTECODE_CACHE_BUILD, sizeof(header.build) - 1);
+    header.compileFlags = flags;
+    header.sourceCrc = crc;
+    header.sourceLen = len;
+}
+
+static duk_ret_t safeLoadFunction(duk_context *ctx, void *udata) {
+    duk_load_function(ctx);
+    return 1;
+}
+
+/*********************************************************************
+**  Function: loadBytecode
+**  Push the cached function if the cache file matches "expected"
+**********************************************************************/
+static bool loadBytecode(duk_context *ctx, FS &fs, const String &cachePath, BytecodeCacheHeader &expected) {
+    if (!fs.exists(cachePath)) return false;
+    File file = fs.open(cachePath, FILE_READ);
+    if (!file) return false;
+
+    BytecodeCacheHeader header;
+    bool ok = file.read((uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+              memcmp(&header, &expected, offsetof(BytecodeCacheHeader, bytecodeCrc)) == 0 &&
+              header.bytecodeLen == file.size() - sizeof(header);
+    if (ok) {
+        void *buf = duk_push_fixed_buffer(ctx, header.bytecodeLen);
+        ok = file.read((uint8_t *)buf, header.bytecodeLen) == header.bytecodeLen &&
+             crc32_le(0, (const uint8_t *)buf, header.bytecodeLen) == header.bytecodeCrc;
+        // Duktape trusts loaded bytecode, so it is only loaded after the CRC check
+        if (ok) ok = duk_safe_call(ctx, safeLoadFunction, NULL, 1, 1) == DUK_EXEC_SUCCESS;
+        if (!ok) duk_pop(ctx);
+    }
+    file.close();
+    return ok;
+}
+
+// Dump the function on top of the stack to the cache file, the stack is left untouched
+static void saveBytecode(duk_context *ctx, FS &fs, const String &cachePath, BytecodeCacheHeader &header) {
+    duk_dup_top(ctx);
+    duk_dump_function(ctx);
+    duk_size_t len;
+    const uint8_t *buf = (const uint8_t *)duk_get_buffer(ctx, -1, &len);
+    header.bytecodeLen = len;
+    header.bytecodeCrc = crc32_le(0, buf, len);
+
+    File file = fs.open(cachePath, FILE_WRITE);
+    bool ok = file && file.write((const uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+              file.write(buf, len) == len;
+    if (file) file.close();
+    if (!ok) {
+        log_w("Could not write bytecode cache %s", cachePath.c_str());
+        fs.remove(cachePath);
+    }
+    duk_pop(ctx);
+}
+#endif
+
+static duk_int_t compile(
+    duk_context *ctx, const char *source, duk_size_t len, duk_uint_t flags, const char *filename
+) {
+    if (filename == NULL) return duk_pcompile_lstring(ctx, flags, source, len);
+    duk_push_string(ctx, filename);
+    return duk_pcompile_lstring_filename(ctx, flags, source, len);
+}
+
+duk_int_t bduk_compile_cached(
+    duk_context *ctx, FS *fs, const String &path, const char *source, duk_size_t len, duk_uint_t flags,
+    const char *filename
+) {
+#if defined(DUK_USE_BYTECODE_DUMP_SUPPORT)
+    if (fs == NULL || path.length() == 0) return compile(ctx, source, len, flags, filename);
+
+    uint32_t t = millis();
+    String cachePath = path + BJS_BYTECODE_CACHE_EXT;
+    BytecodeCacheHeader header;
+    fillHeader(header, flags, crc32_le(0, (const uint8_t *)source, len), len);
+
+    if (loadBytecode(ctx, *fs, cachePath, header)) {
+        log_i("Loaded %s from bytecode cache in %lums", path.c_str(), millis() - t);
+        return DUK_EXEC_SUCCESS;
+    }
+
+    duk_int_t rc = compile(ctx, source, len, flags, filename);
+    if (rc == DUK_EXEC_SUCCESS) {
+        log_i("Compiled %s in %lums", path.c_str(), millis() - t);
+        saveBytecode(ctx, *fs, cachePath, header);
+    }
+    return rc;
+#else
+    return compile(ctx, source, len, flags, filename);
+#endif
+}
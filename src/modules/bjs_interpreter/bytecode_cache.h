@@ -0,0 +1,26 @@
+#ifndef __BYTECODE_CACHE_JS_H__
+#define __BYTECODE_CACHE_JS_H__
+#include <FS.h>
+#include <duktape.h>
+
+// Extension appended to the script path for its cached bytecode
+#ifndef BJS_BYTECODE_CACHE_EXT
+#define BJS_BYTECODE_CACHE_EXT ".bjsc"
+#endif
+
+/*
+ * Compiles "source" like duk_pcompile_lstring, but first tries to load the
+ * bytecode cached next to "path" and, on a miss, writes the freshly compiled
+ * function there. The cache is only used when it matches the CRC and length
+ * of the source and the firmware/Duktape build that produced it.
+ * Leaves the function, or the error, on the stack and returns the duk_pcompile
+ * result. Without a filesystem or path, or when Duktape was built without
+ * DUK_USE_BYTECODE_DUMP_SUPPORT, it just compiles.
+ * "filename" is used for error messages, NULL keeps Duktape's default.
+ */
+duk_int_t bduk_compile_cached(
+    duk_context *ctx, FS *fs, const String &path, const char *source, duk_size_t len, duk_uint_t flags,
+    const char *filename = NULL
+);
+
+#endif
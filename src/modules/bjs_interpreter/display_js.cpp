@@ -369,6 +369,158 @@ duk_ret_t native_height(duk_context *ctx) {
     return 1;
 }
 
+// drawBatch opcodes and their int16 arguments
+enum DrawBatchOp : uint8_t {
+    BATCH_FILL,            // color
+    BATCH_RECT,            // x, y, w, h, color
+    BATCH_FILL_RECT,       // x, y, w, h, color
+    BATCH_ROUND_RECT,      // x, y, w, h, r, color
+    BATCH_FILL_ROUND_RECT, // x, y, w, h, r, color
+    BATCH_CIRCLE,          // x, y, r, color
+    BATCH_FILL_CIRCLE,     // x, y, r, color
+    BATCH_LINE,            // x, y, x2, y2, color
+    BATCH_PIXEL,           // x, y, color
+    BATCH_HLINE,           // x, y, w, color
+    BATCH_VLINE,           // x, y, h, color
+    BATCH_TEXT,            // stringIndex, x, y
+    BATCH_TEXT_COLOR,      // color
+    BATCH_TEXT_SIZE,       // size
+    BATCH_SPRITE,          // spritePointer, x, y
+    BATCH_SPRITE_TRANSP,   // spritePointer, x, y, transparent color
+    BATCH_OP_COUNT
+};
+// Number of arguments of each command, indexed by opcode
+static const uint8_t batchArgCount[BATCH_OP_COUNT] = {1, 5, 5, 6, 6, 4, 4, 5, 3, 4, 4, 3, 1, 1, 3, 4};
+static std::vector<const char *> batchStrings;
+
+#if defined(HAS_SCREEN)
+static inline TFT_eSprite *get_batch_sprite(duk_int_t spritePointer, duk_int_t magic) {
+    // A sprite can't be pushed to itself
+    if (spritePointer <= 0 || spritePointer > (duk_int_t)sprites.size() || spritePointer == magic) {
+        return NULL;
+    }
+    return sprites.at(spritePointer - 1);
+}
+#endif
+
+duk_ret_t native_drawBatch(duk_context *ctx) {
+    // usage: drawBatch(commands: Int16Array | Uint16Array, strings?: string[]): number
+    // Runs a list of packed draw commands in one call, each command is an
+    // opcode (see DrawBatchOp) followed by its arguments. Colors are RGB565,
+    // text commands take an index in "strings" and sprite commands the
+    // spritePointer of another sprite to composite. On the screen the whole
+    // batch is sent in a single SPI transaction.
+    // Returns the number of commands drawn.
+    duk_size_t size = 0;
+    const int16_t *words = NULL;
+    if (duk_is_buffer_data(ctx, 0)) words = (const int16_t *)duk_get_buffer_data(ctx, 0, &size);
+    if (words == NULL) {
+        return duk_error(ctx, DUK_ERR_TYPE_ERROR, "%s: Expected an Int16Array of commands", "drawBatch");
+    }
+    size_t count = size / sizeof(int16_t);
+    if (((uintptr_t)words & 1) != 0) {
+        // A view at an odd byteOffset, read it from an aligned copy (freed by the GC)
+        int16_t *aligned = (int16_t *)duk_push_fixed_buffer(ctx, count * sizeof(int16_t));
+        memcpy(aligned, words, count * sizeof(int16_t));
+        words = aligned;
+    }
+    duk_int_t magic = duk_get_current_magic(ctx);
+
+    batchStrings.clear();
+    if (duk_is_array(ctx, 1)) {
+        duk_size_t stringCount = duk_get_length(ctx, 1);
+        for (duk_size_t i = 0; i < stringCount; i++) {
+            duk_get_prop_index(ctx, 1, i);
+            // Kept alive by the array, so the pointers stay valid during the call
+            const char *str = duk_get_string(ctx, -1);
+            duk_pop(ctx);
+            if (str == NULL) {
+                return duk_error(
+                    ctx, DUK_ERR_TYPE_ERROR, "%s: strings[%d] is not a string", "drawBatch", (int)i
+                );
+            }
+            batchStrings.push_back(str);
+        }
+    }
+
+    // Validate everything first: an error thrown while drawing would leave the SPI transaction open
+    size_t commands = 0;
+    for (size_t i = 0; i < count; commands++) {
+        uint16_t op = words[i];
+        if (op >= BATCH_OP_COUNT || i + batchArgCount[op] >= count) {
+            return duk_error(ctx, DUK_ERR_RANGE_ERROR, "%s: Invalid command at %d", "drawBatch", (int)i);
+        }
+        const int16_t *a = &words[i + 1];
+        if (op == BATCH_TEXT && (a[0] < 0 || a[0] >= (int16_t)batchStrings.size())) {
+            return duk_error(ctx, DUK_ERR_RANGE_ERROR, "%s: Invalid string index at %d", "drawBatch", (int)i);
+        }
+        if (op == BATCH_SPRITE || op == BATCH_SPRITE_TRANSP) {
+#if defined(HAS_SCREEN)
+            if (get_batch_sprite(a[0], magic) == NULL) {
+                return duk_error(ctx, DUK_ERR_RANGE_ERROR, "%s: Invalid sprite at %d", "drawBatch", (int)i);
+            }
+#else
+            return duk_error(ctx, DUK_ERR_ERROR, "%s: Sprites not supported on this device!", "drawBatch");
+#endif
+        }
+        i += 1 + batchArgCount[op];
+    }
+
+    auto display = get_display(magic);
+    if (magic == 0) tft.beginFrame("jsBatch");
+#if defined(HAS_SCREEN)
+    if (magic == 0) tft.startWrite();
+#endif
+    for (size_t i = 0; i < count; i += 1 + batchArgCount[words[i]]) {
+        const int16_t *a = &words[i + 1];
+        switch (words[i]) {
+            case BATCH_FILL:
+                if (magic == 0) tft.fillScreen((uint16_t)a[0]);
+#if defined(HAS_SCREEN)
+                else ((TFT_eSprite *)display)->fillSprite((uint16_t)a[0]);
+#endif
+                break;
+            case BATCH_RECT: display->drawRect(a[0], a[1], a[2], a[3], (uint16_t)a[4]); break;
+            case BATCH_FILL_RECT: display->fillRect(a[0], a[1], a[2], a[3], (uint16_t)a[4]); break;
+            case BATCH_ROUND_RECT:
+                display->drawRoundRect(a[0], a[1], a[2], a[3], a[4], (uint16_t)a[5]);
+                break;
+            case BATCH_FILL_ROUND_RECT:
+                display->fillRoundRect(a[0], a[1], a[2], a[3], a[4], (uint16_t)a[5]);
+                break;
+            case BATCH_CIRCLE: display->drawCircle(a[0], a[1], a[2], (uint16_t)a[3]); break;
+            case BATCH_FILL_CIRCLE: display->fillCircle(a[0], a[1], a[2], (uint16_t)a[3]); break;
+            case BATCH_LINE: display->drawLine(a[0], a[1], a[2], a[3], (uint16_t)a[4]); break;
+            case BATCH_PIXEL: display->drawPixel(a[0], a[1], (uint16_t)a[2]); break;
+            case BATCH_HLINE: display->drawFastHLine(a[0], a[1], a[2], (uint16_t)a[3]); break;
+            case BATCH_VLINE: display->drawFastVLine(a[0], a[1], a[2], (uint16_t)a[3]); break;
+            case BATCH_TEXT: display->drawString(batchStrings[a[0]], a[1], a[2]); break;
+            case BATCH_TEXT_COLOR: display->setTextColor((uint16_t)a[0]); break;
+            case BATCH_TEXT_SIZE: display->setTextSize(a[0]); break;
+#if defined(HAS_SCREEN)
+            case BATCH_SPRITE:
+            case BATCH_SPRITE_TRANSP: {
+                TFT_eSprite *sprite = get_batch_sprite(a[0], magic);
+                TFT_eSprite *target = (TFT_eSprite *)display;
+                bool transparent = words[i] == BATCH_SPRITE_TRANSP;
+                if (magic == 0 && transparent) sprite->pushSprite(a[1], a[2], (uint16_t)a[3]);
+                else if (magic == 0) sprite->pushSprite(a[1], a[2]);
+                else if (transparent) sprite->pushToSprite(target, a[1], a[2], (uint16_t)a[3]);
+                else sprite->pushToSprite(target, a[1], a[2]);
+                break;
+            }
+#endif
+        }
+    }
+#if defined(HAS_SCREEN)
+    if (magic == 0) tft.endWrite();
+#endif
+    if (magic == 0) tft.endFrame();
+
+    duk_push_uint(ctx, commands);
+    return 1;
+}
+
 duk_ret_t native_drawImage(duk_context *ctx) {
     FileParamsJS file = js_get_path_from_params(ctx, true, true);
 
@@ -433,7 +585,7 @@ duk_ret_t native_gifPlayFrame(duk_context *ctx) {
     if (duk_get_prop_string(ctx, -1, "gifPointer")) { gifIndex = duk_to_int(ctx, -1) - 1; }
 
     uint8_t result = 0;
-    if (gifIndex >= 0) {
+    if (gifIndex >= 0 && (size_t)gifIndex < gifs.size()) {
         Gif *gif = gifs.at(gifIndex);
         if (gif != NULL) { result = gif->playFrame(x, y, bSync); }
     }
@@ -472,7 +624,7 @@ duk_ret_t native_gifReset(duk_context *ctx) {
     if (duk_get_prop_string(ctx, -1, "gifPointer")) { gifIndex = duk_to_int(ctx, -1) - 1; }
 
     uint8_t result = 0;
-    if (gifIndex >= 0) {
+    if (gifIndex >= 0 && (size_t)gifIndex < gifs.size()) {
         Gif *gif = gifs.at(gifIndex);
         if (gif != NULL) {
             gifs.at(gifIndex)->reset();
@@ -495,7 +647,8 @@ duk_ret_t native_gifClose(duk_context *ctx) {
     if (duk_get_prop_string(ctx, -1, "gifPointer")) { gifIndex = duk_to_int(ctx, -1) - 1; }
 
     uint8_t result = 0;
-    if (gifIndex >= 0) {
+    // Also the finalizer, which can run after clearDisplayModuleData emptied the vector
+    if (gifIndex >= 0 && (size_t)gifIndex < gifs.size()) {
         Gif *gif = gifs.at(gifIndex);
         if (gif != NULL) {
             delete gif;
@@ -565,6 +718,7 @@ duk_ret_t putPropDisplayFunctions(duk_context *ctx, duk_idx_t obj_idx, uint8_t m
 #endif
     bduk_put_prop_c_lightfunc(ctx, obj_idx, "width", native_width, 0, magic);
     bduk_put_prop_c_lightfunc(ctx, obj_idx, "height", native_height, 0, magic);
+    bduk_put_prop_c_lightfunc(ctx, obj_idx, "drawBatch", native_drawBatch, 2, magic);
     return 0;
 }
 
@@ -578,7 +732,8 @@ duk_ret_t native_deleteSprite(duk_context *ctx) {
 
     uint8_t result = 0;
 #if defined(HAS_SCREEN)
-    if (spriteIndex >= 0) {
+    // Also the finalizer, which can run after clearDisplayModuleData emptied the vector
+    if (spriteIndex >= 0 && (size_t)spriteIndex < sprites.size()) {
         TFT_eSprite *sprite = sprites.at(spriteIndex);
         if (sprite != NULL) {
             sprite->~TFT_eSprite();
@@ -1,5 +1,6 @@
 #include "helpers_js.h"
 #include "core/sd_functions.h"
+#include "profiler_js.h"
 #include <globals.h>
 
 // Commented because it is not used for now
@@ -11,7 +12,8 @@
 void bduk_register_c_lightfunc(
     duk_context *ctx, const char *name, duk_c_function func, duk_idx_t nargs, duk_idx_t magic
 ) {
-    duk_push_c_lightfunc(ctx, func, nargs, nargs == DUK_VARARGS ? 15 : nargs, magic);
+    if (jsProfilerEnabled()) jsProfilerPushFunction(ctx, name, func, nargs, magic);
+    else duk_push_c_lightfunc(ctx, func, nargs, nargs == DUK_VARARGS ? 15 : nargs, magic);
 
     duk_put_global_string(ctx, name);
 }
@@ -30,7 +32,8 @@ void bduk_put_prop_c_lightfunc(
     duk_context *ctx, duk_idx_t obj_idx, const char *name, duk_c_function func, duk_idx_t nargs,
     duk_idx_t magic
 ) {
-    duk_push_c_lightfunc(ctx, func, nargs, nargs == DUK_VARARGS ? 15 : nargs, magic);
+    if (jsProfilerEnabled()) jsProfilerPushFunction(ctx, name, func, nargs, magic);
+    else duk_push_c_lightfunc(ctx, func, nargs, nargs == DUK_VARARGS ? 15 : nargs, magic);
 
     duk_put_prop_string(ctx, obj_idx, name);
 }
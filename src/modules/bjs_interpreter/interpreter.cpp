@@ -8,9 +8,13 @@
 
 #include <duktape.h>
 
+#include "bytecode_cache.h"
 #include "display_js.h"
 #include "gui_js.h"
 #include "helpers_js.h"
+#include "profiler_js.h"
+#include "storage_js.h"
+#include "timers_js.h"
 #include "wifi_js.h"
 
 // #define DUK_USE_DEBUG
@@ -23,6 +27,7 @@
 static char *script = NULL;
 static char *scriptDirpath = NULL;
 static char *scriptName = NULL;
+static FS *scriptFs = NULL; // where the script was read from, its bytecode is cached there too
 
 static duk_ret_t native_noop(duk_context *ctx) { return 0; }
 
@@ -33,6 +38,7 @@ static duk_ret_t native_load(duk_context *ctx) {
     script = strdup(duk_to_string(ctx, 0));
     scriptDirpath = NULL;
     scriptName = NULL;
+    scriptFs = NULL;
     return 0;
 }
 
@@ -773,7 +779,23 @@ static duk_ret_t native_storageRead(duk_context *ctx) {
     }
     if (!fileParams.path.startsWith("/")) fileParams.path = "/" + fileParams.path; // add "/" if missing
 
-    // TODO: Change to use duk_push_fixed_buffer
+    if (binary) {
+        // Read straight into the Duktape buffer, without an intermediate copy
+        File file = (fileParams.fs)->open(fileParams.path, FILE_READ);
+        if (!file) {
+            return duk_error(
+                ctx, DUK_ERR_ERROR, "%s: Could not read file: %s", "storageRead", fileParams.path.c_str()
+            );
+        }
+        fileSize = file.size();
+        void *buf = duk_push_fixed_buffer(ctx, fileSize);
+        if (fileSize) fileSize = file.read((uint8_t *)buf, fileSize);
+        file.close();
+        // Convert buffer to Uint8Array
+        duk_push_buffer_object(ctx, -1, 0, fileSize, DUK_BUFOBJ_UINT8ARRAY);
+        return 1;
+    }
+
     fileContent = readBigFile(*fileParams.fs, fileParams.path, binary, &fileSize);
 
     if (fileContent == NULL) {
@@ -782,14 +804,7 @@ static duk_ret_t native_storageRead(duk_context *ctx) {
         );
     }
 
-    if (binary && fileSize != 0) {
-        void *buf = duk_push_fixed_buffer(ctx, fileSize);
-        memcpy(buf, fileContent, fileSize);
-        // Convert buffer to Uint8Array
-        duk_push_buffer_object(ctx, -1, 0, fileSize, DUK_BUFOBJ_UINT8ARRAY);
-    } else {
-        duk_push_string(ctx, fileContent);
-    }
+    duk_push_string(ctx, fileContent);
     free(fileContent);
     return 1;
 }
@@ -851,6 +866,7 @@ static duk_ret_t native_storageWrite(duk_context *ctx) {
     // Write data
     file.write((const uint8_t *)data, dataSize);
     file.close();
+    fileChanged(*fileParams.fs, fileParams.path);
 
     duk_push_boolean(ctx, true);
 
@@ -872,6 +888,10 @@ static duk_ret_t native_storageRename(duk_context *ctx) {
     if (!newPath.startsWith("/")) newPath = "/" + newPath;
 
     bool success = (oldFileParams.fs)->rename(oldFileParams.path, newPath);
+    if (success) {
+        fileChanged(*oldFileParams.fs, oldFileParams.path, true);
+        fileChanged(*oldFileParams.fs, newPath);
+    }
     duk_push_boolean(ctx, success);
     return 1;
 }
@@ -888,10 +908,33 @@ static duk_ret_t native_storageRemove(duk_context *ctx) {
     if (!fileParams.path.startsWith("/")) { fileParams.path = "/" + fileParams.path; }
 
     bool success = (fileParams.fs)->remove(fileParams.path);
+    if (success) fileChanged(*fileParams.fs, fileParams.path, true);
     duk_push_boolean(ctx, success);
     return 1;
 }
 
+static duk_ret_t native_storageHash(duk_context *ctx) {
+    // usage: storageHash(path: string | Path, algorithm?: "md5" | "crc32" | "sha256"): string
+    // returns: the digest in hex, the file is read in chunks so it can be of any size.
+    const char *algorithm = duk_get_string_default(ctx, 1, "sha256");
+    FileHashType type;
+    if (strcmp(algorithm, "md5") == 0) type = HASH_MD5;
+    else if (strcmp(algorithm, "crc32") == 0) type = HASH_CRC32;
+    else if (strcmp(algorithm, "sha256") == 0) type = HASH_SHA256;
+    else return duk_error(ctx, DUK_ERR_TYPE_ERROR, "%s: Invalid algorithm: %s", "storageHash", algorithm);
+
+    FileParamsJS fileParams = js_get_path_from_params(ctx, true);
+    if (!fileParams.exist) {
+        return duk_error(
+            ctx, DUK_ERR_ERROR, "%s: File: %s does not exist", "storageHash", fileParams.path.c_str()
+        );
+    }
+    if (!fileParams.path.startsWith("/")) fileParams.path = "/" + fileParams.path;
+
+    duk_push_string(ctx, hashFile(*fileParams.fs, fileParams.path, type).c_str());
+    return 1;
+}
+
 static duk_ret_t native_storageMkdir(duk_context *ctx) {
     // usage: storageMkdir(path: string | Path): boolean
     FileParamsJS fileParams = js_get_path_from_params(ctx, true);
@@ -938,7 +981,25 @@ static duk_ret_t native_storageRmdir(duk_context *ctx) {
     return 1;
 }
 
+// Push the stash object holding the built-in modules, creating it on first use
+static void pushModuleCache(duk_context *ctx) {
+    duk_push_global_stash(ctx);
+    if (!duk_get_prop_string(ctx, -1, "modules")) {
+        duk_pop(ctx);
+        duk_push_bare_object(ctx); // no prototype, so names like "toString" are not found
+        duk_dup_top(ctx);
+        duk_put_prop_string(ctx, -3, "modules");
+    }
+    duk_remove(ctx, -2);
+}
+
 static duk_ret_t native_require(duk_context *ctx) {
+    if (duk_is_string(ctx, 0)) {
+        pushModuleCache(ctx);
+        if (duk_get_prop_string(ctx, -1, duk_get_string(ctx, 0))) return 1;
+        duk_pop_2(ctx);
+    }
+
     duk_idx_t obj_idx = duk_push_object(ctx);
 
     if (!duk_is_string(ctx, 0)) { return 1; }
@@ -1029,6 +1090,7 @@ static duk_ret_t native_require(duk_context *ctx) {
         bduk_put_prop_c_lightfunc(ctx, obj_idx, "getEscPress", native_getEscPress, 1, 0);
         bduk_put_prop_c_lightfunc(ctx, obj_idx, "getNextPress", native_getNextPress, 1, 0);
         bduk_put_prop_c_lightfunc(ctx, obj_idx, "getAnyPress", native_getAnyPress, 1, 0);
+        bduk_put_prop_c_lightfunc(ctx, obj_idx, "onPress", native_inputOnPress, 2, 0);
 
     } else if (filepath == "math") {
         duk_pop(ctx);
@@ -1055,11 +1117,13 @@ static duk_ret_t native_require(duk_context *ctx) {
     } else if (filepath == "storage") {
         bduk_put_prop_c_lightfunc(ctx, obj_idx, "read", native_storageRead, 2, 0);
         bduk_put_prop_c_lightfunc(ctx, obj_idx, "write", native_storageWrite, 4, 0);
+        bduk_put_prop_c_lightfunc(ctx, obj_idx, "open", native_storageOpen, 3, 0);
         bduk_put_prop_c_lightfunc(ctx, obj_idx, "rename", native_storageRename, 2);
         bduk_put_prop_c_lightfunc(ctx, obj_idx, "remove", native_storageRemove, 1);
         bduk_put_prop_c_lightfunc(ctx, obj_idx, "readdir", native_storageReaddir, 1);
         bduk_put_prop_c_lightfunc(ctx, obj_idx, "mkdir", native_storageMkdir, 1);
         bduk_put_prop_c_lightfunc(ctx, obj_idx, "rmdir", native_storageRmdir, 1);
+        bduk_put_prop_c_lightfunc(ctx, obj_idx, "hash", native_storageHash, 2, 0);
 
     } else if (filepath == "subghz") {
         bduk_put_prop_c_lightfunc(ctx, obj_idx, "setFrequency", native_subghzSetFrequency, 1, 0);
@@ -1085,24 +1149,36 @@ static duk_ret_t native_require(duk_context *ctx) {
         else if (LittleFS.exists(filepath)) fs = &LittleFS;
         if (fs == NULL) { return 1; }
 
-        const char *requiredScript = readBigFile(*fs, filepath);
+        char *requiredScript = readBigFile(*fs, filepath);
         if (requiredScript == NULL) { return 1; }
 
-        duk_push_string(ctx, "(function(){exports={};module={exports:exports};\n");
+        duk_push_string(ctx, "(function(){var exports={};var module={exports:exports};\n");
         duk_push_string(ctx, requiredScript);
-        duk_push_string(ctx, "\n})");
+        duk_push_string(ctx, "\nreturn module.exports;})");
         duk_concat(ctx, 3);
+        free(requiredScript);
 
-        duk_int_t pcall_rc = duk_pcompile(ctx, DUK_COMPILE_EVAL);
+        duk_size_t len;
+        const char *source = duk_get_lstring(ctx, -1, &len);
+        duk_int_t pcall_rc =
+            bduk_compile_cached(ctx, fs, filepath, source, len, DUK_COMPILE_EVAL, filepath.c_str());
+        duk_remove(ctx, -2); // wrapped source
         if (pcall_rc != DUK_EXEC_SUCCESS) { return 1; }
 
-        pcall_rc = duk_pcall(ctx, 1);
-        if (pcall_rc == DUK_EXEC_SUCCESS) {
-            duk_get_prop_string(ctx, -1, "exports");
-            duk_compact(ctx, -1);
-        }
+        // Evaluating the module gives the wrapper function, calling it gives module.exports
+        duk_push_global_object(ctx);
+        pcall_rc = duk_pcall_method(ctx, 0);
+        if (pcall_rc == DUK_EXEC_SUCCESS) pcall_rc = duk_pcall(ctx, 0);
+        if (pcall_rc == DUK_EXEC_SUCCESS) duk_compact(ctx, -1);
+        return 1;
     }
 
+    // Built-in modules only hold natives, so one object is shared by every require and run.
+    // What a script adds to it is removed after the run, see resetBuiltinsSource
+    pushModuleCache(ctx);
+    duk_dup(ctx, obj_idx);
+    duk_put_prop_string(ctx, -2, filepath.c_str());
+    duk_pop(ctx);
     return 1;
 }
 
@@ -1166,41 +1242,84 @@ static void js_fatal_error_handler(void *udata, const char *msg) {
     abort();
 }
 
-// Code interpreter, must be called in the loop() function to work
-void interpreterHandler(void *pvParameters) {
-    log_d(
-        "init interpreter:\nPSRAM: [Free: %d, max alloc: %d],\nRAM: [Free: %d, "
-        "max alloc: %d]\n",
-        ESP.getFreePsram(),
-        ESP.getMaxAllocPsram(),
-        ESP.getFreeHeap(),
-        ESP.getMaxAllocHeap()
-    );
-    if (script == NULL) { return; }
-    tft.fillScreen(TFT_BLACK);
-    tft.setRotation(bruceConfig.rotation);
-    tft.setTextSize(FM);
-    tft.setTextColor(TFT_WHITE);
-    // Create context.
-    Serial.println("Create context");
-    auto alloc_function = &ps_alloc_function;
-    auto realloc_function = &ps_realloc_function;
-    auto free_function = &ps_free_function;
-    if (!psramFound()) {
-        alloc_function = NULL;
-        realloc_function = NULL;
-        free_function = NULL;
-    }
-
-    /// TODO: Add DUK_USE_NATIVE_STACK_CHECK check with
-    /// uxTaskGetStackHighWaterMark
-    duk_context *ctx =
-        duk_create_heap(alloc_function, realloc_function, free_function, NULL, js_fatal_error_handler);
+// Copy of the global object taken once the natives are registered, and the
+// function that brings the global object back to it after each script.
+// Non-strict code, so var declarations that can't be deleted are just cleared.
+static const char *snapshotGlobalsSource =
+    "function(g){var s=Object.create(null),k=Object.getOwnPropertyNames(g),i;"
+    "for(i=0;i<k.length;i++)s[k[i]]=g[k[i]];return s;}";
+static const char *resetGlobalsSource =
+    "function(g,s){var k=Object.getOwnPropertyNames(g),i;"
+    "for(i=0;i<k.length;i++)if(!(k[i] in s)&&!delete g[k[i]])g[k[i]]=undefined;"
+    "k=Object.getOwnPropertyNames(s);"
+    "for(i=0;i<k.length;i++)if(g[k[i]]!==s[k[i]])g[k[i]]=s[k[i]];}";
+
+// Same for the built-in objects, their prototypes and the built-in modules, using property
+// descriptors. A change that can't be undone (ex: a frozen prototype) throws, and the heap is rebuilt.
+static const char *snapshotBuiltinsSource =
+    "function(g,m){var n=['Object','Function','Array','String','Boolean','Number','Date','RegExp',"
+    "'Error','EvalError','RangeError','ReferenceError','SyntaxError','TypeError','URIError','Math',"
+    "'JSON','Duktape','Reflect','ArrayBuffer','DataView','Int8Array','Uint8Array','Uint8ClampedArray',"
+    "'Int16Array','Uint16Array','Int32Array','Uint32Array','Float32Array','Float64Array'],"
+    "l=[],r=[],i,j,k,d;"
+    "for(i=0;i<n.length;i++)if(g[n[i]]){l.push(g[n[i]]);if(g[n[i]].prototype)l.push(g[n[i]].prototype);}"
+    "for(k in m)l.push(m[k]);"
+    "for(i=0;i<l.length;i++){d=Object.create(null);k=Object.getOwnPropertyNames(l[i]);"
+    "for(j=0;j<k.length;j++)d[k[j]]=Object.getOwnPropertyDescriptor(l[i],k[j]);r.push([l[i],d]);}"
+    "return r;}";
+static const char *resetBuiltinsSource =
+    "function(r){var i,j,o,s,k,c,d;for(i=0;i<r.length;i++){o=r[i][0];s=r[i][1];"
+    "if(!Object.isExtensible(o))throw new Error('built-in sealed');"
+    "k=Object.getOwnPropertyNames(o);"
+    "for(j=0;j<k.length;j++)if(!(k[j] in s)&&!delete o[k[j]])throw new Error('built-in changed');"
+    "k=Object.getOwnPropertyNames(s);"
+    "for(j=0;j<k.length;j++){c=Object.getOwnPropertyDescriptor(o,k[j]);d=s[k[j]];"
+    "if(!c||c.value!==d.value||c.get!==d.get||c.set!==d.set||c.writable!==d.writable||"
+    "c.enumerable!==d.enumerable||c.configurable!==d.configurable)Object.defineProperty(o,k[j],d);}}}";
+
+// Built-in modules created with the heap, so require() only has to look them up
+static const char *preloadedModules[] = {
+    "audio", "badusb", "blebeacon", "dialog", "gui",          "display", "device",  "flipper", "gpio", "http",
+    "ir",    "input",  "keyboard",  "math",   "notification", "serial",  "storage", "subghz",  "wifi",
+};
+
+static void stashFunction(duk_context *ctx, const char *name, const char *source) {
+    duk_push_global_stash(ctx);
+    duk_compile_string(ctx, DUK_COMPILE_FUNCTION, source);
+    duk_put_prop_string(ctx, -2, name);
+    duk_pop(ctx);
+}
 
-    // Init containers
-    clearDisplayModuleData();
+/*********************************************************************
+**  Function: resetInterpreterHeap
+**  Remove what the last script added to the global object, the built-in
+**  objects and modules, and restore what it overwrote. Returns false if
+**  the heap can't be reused.
+**********************************************************************/
+static bool resetInterpreterHeap(duk_context *ctx) {
+    duk_set_top(ctx, 0);
+    duk_push_global_stash(ctx);
+    duk_get_prop_string(ctx, -1, "resetGlobals");
+    duk_push_global_object(ctx);
+    duk_get_prop_string(ctx, -3, "globals");
+    bool ok = duk_pcall(ctx, 2) == DUK_EXEC_SUCCESS;
+    duk_pop(ctx);
+    duk_get_prop_string(ctx, -1, "resetBuiltins");
+    duk_get_prop_string(ctx, -2, "builtins");
+    if (ok && duk_pcall(ctx, 1) != DUK_EXEC_SUCCESS) {
+        log_w("Interpreter heap not reusable: %s", duk_safe_to_string(ctx, -1));
+        ok = false;
+    }
+    duk_set_top(ctx, 0);
+    duk_gc(ctx, 0);
+    return ok;
+}
 
-    // Add native functions to context.
+/*********************************************************************
+**  Function: registerInterpreterNatives
+**  Register the natives and the built-in modules on the global object
+**********************************************************************/
+void registerInterpreterNatives(duk_context *ctx) {
     bduk_register_c_lightfunc(ctx, "now", native_now, 0);
     bduk_register_c_lightfunc(ctx, "delay", native_delay, 1);
     bduk_register_c_lightfunc(ctx, "parse_int", native_parse_int, 1);
@@ -1211,26 +1330,14 @@ void interpreterHandler(void *pvParameters) {
     bduk_register_c_lightfunc(ctx, "random", native_random, 2);
     bduk_register_c_lightfunc(ctx, "require", native_require, 1);
     bduk_register_c_lightfunc(ctx, "assert", native_assert, 2);
-    if (scriptDirpath == NULL || scriptName == NULL) {
-        bduk_register_string(ctx, "__filepath", "");
-        bduk_register_string(ctx, "__dirpath", "");
-    } else {
-        bduk_register_string(ctx, "__filepath", (String(scriptDirpath) + String(scriptName)).c_str());
-        bduk_register_string(ctx, "__dirpath", scriptDirpath);
-    }
+    bduk_register_c_lightfunc(ctx, "setTimeout", native_setTimeout, DUK_VARARGS, 0);
+    bduk_register_c_lightfunc(ctx, "setInterval", native_setTimeout, DUK_VARARGS, 1);
+    bduk_register_c_lightfunc(ctx, "clearTimeout", native_clearTimeout, 1);
+    bduk_register_c_lightfunc(ctx, "clearInterval", native_clearTimeout, 1);
     bduk_register_string(ctx, "BRUCE_VERSION", BRUCE_VERSION);
-    bduk_register_int(ctx, "BRUCE_PRICOLOR", bruceConfig.priColor);
-    bduk_register_int(ctx, "BRUCE_SECCOLOR", bruceConfig.secColor);
-    bduk_register_int(ctx, "BRUCE_BGCOLOR", bruceConfig.bgColor);
 
     registerConsole(ctx);
 
-    // Typescript emits: Object.defineProperty(exports, "__esModule", { value:
-    // true }); In every file, this is polyfill so typescript project can run on
-    // Bruce
-    duk_push_object(ctx);
-    duk_put_global_string(ctx, "exports");
-
     // Arduino compatible
     bduk_register_c_lightfunc(ctx, "pinMode", native_pinMode, 2);
     bduk_register_c_lightfunc(ctx, "digitalWrite", native_digitalWrite, 2);
@@ -1352,6 +1459,53 @@ void interpreterHandler(void *pvParameters) {
     bduk_register_c_lightfunc(ctx, "storageWrite", native_storageWrite, 4);
     bduk_register_c_lightfunc(ctx, "storageRename", native_storageRename, 2);
     bduk_register_c_lightfunc(ctx, "storageRemove", native_storageRemove, 1);
+    bduk_register_c_lightfunc(ctx, "storageOpen", native_storageOpen, 3);
+
+    for (const char *name : preloadedModules) {
+        duk_push_c_lightfunc(ctx, native_require, 1, 1, 0);
+        duk_push_string(ctx, name);
+        duk_call(ctx, 1);
+        duk_pop(ctx);
+    }
+}
+
+/*********************************************************************
+**  Function: createInterpreterHeap
+**  Create a heap with the natives and the built-in modules registered
+**********************************************************************/
+static duk_context *createInterpreterHeap() {
+    // Create context.
+    Serial.println("Create context");
+    auto alloc_function = &ps_alloc_function;
+    auto realloc_function = &ps_realloc_function;
+    auto free_function = &ps_free_function;
+    if (!psramFound()) {
+        alloc_function = NULL;
+        realloc_function = NULL;
+        free_function = NULL;
+    }
+
+    /// TODO: Add DUK_USE_NATIVE_STACK_CHECK check with
+    /// uxTaskGetStackHighWaterMark
+    duk_context *ctx =
+        duk_create_heap(alloc_function, realloc_function, free_function, NULL, js_fatal_error_handler);
+
+    registerInterpreterNatives(ctx);
+
+    stashFunction(ctx, "resetGlobals", resetGlobalsSource);
+    stashFunction(ctx, "snapshotGlobals", snapshotGlobalsSource);
+    duk_push_global_stash(ctx);
+    duk_get_prop_string(ctx, -1, "snapshotGlobals");
+    duk_push_global_object(ctx);
+    duk_call(ctx, 1);
+    duk_put_prop_string(ctx, -2, "globals");
+    stashFunction(ctx, "resetBuiltins", resetBuiltinsSource);
+    duk_compile_string(ctx, DUK_COMPILE_FUNCTION, snapshotBuiltinsSource);
+    duk_push_global_object(ctx);
+    pushModuleCache(ctx);
+    duk_call(ctx, 2);
+    duk_put_prop_string(ctx, -2, "builtins");
+    duk_pop(ctx);
 
     log_d(
         "global populated:\nPSRAM: [Free: %d, max alloc: %d],\nRAM: [Free: %d, "
@@ -1362,14 +1516,76 @@ void interpreterHandler(void *pvParameters) {
         ESP.getMaxAllocHeap()
     );
 
+    return ctx;
+}
+
+// Globals that depend on the script or on the settings, set before every run
+void registerScriptGlobals(duk_context *ctx, const char *dirpath, const char *name) {
+    if (dirpath == NULL || name == NULL) {
+        bduk_register_string(ctx, "__filepath", "");
+        bduk_register_string(ctx, "__dirpath", "");
+    } else {
+        bduk_register_string(ctx, "__filepath", (String(dirpath) + String(name)).c_str());
+        bduk_register_string(ctx, "__dirpath", dirpath);
+    }
+    bduk_register_int(ctx, "BRUCE_PRICOLOR", bruceConfig.priColor);
+    bduk_register_int(ctx, "BRUCE_SECCOLOR", bruceConfig.secColor);
+    bduk_register_int(ctx, "BRUCE_BGCOLOR", bruceConfig.bgColor);
+
+    // Typescript emits: Object.defineProperty(exports, "__esModule", { value:
+    // true }); In every file, this is polyfill so typescript project can run on
+    // Bruce
+    duk_push_object(ctx);
+    duk_put_global_string(ctx, "exports");
+}
+
+static void freeScript() {
+    free((char *)script);
+    script = NULL;
+    free((char *)scriptDirpath);
+    scriptDirpath = NULL;
+    free((char *)scriptName);
+    scriptName = NULL;
+    scriptFs = NULL;
+}
+
+static void runScript(duk_context *ctx) {
+    tft.fillScreen(TFT_BLACK);
+    tft.setRotation(bruceConfig.rotation);
+    tft.setTextSize(FM);
+    tft.setTextColor(TFT_WHITE);
+
+    // Init containers
+    clearDisplayModuleData();
+    clearStorageModuleData();
+    clearTimersModuleData(ctx);
+    registerScriptGlobals(ctx, scriptDirpath, scriptName);
+
     // TODO: match flipper syntax
     // https://github.com/jamisonderek/flipper-zero-tutorials/wiki/JavaScript
     // MEMO: API https://duktape.org/api.html
     // https://github.com/joeqread/arduino-duktape/blob/main/src/duktape.h
 
     Serial.printf("Script length: %d\n", strlen(script));
+    jsProfilerBegin();
+
+    String scriptPath = "";
+    if (scriptFs != NULL && scriptDirpath != NULL && scriptName != NULL) {
+        scriptPath = String(scriptDirpath) + String(scriptName);
+    }
+    duk_int_t rc = bduk_compile_cached(ctx, scriptFs, scriptPath, script, strlen(script), DUK_COMPILE_EVAL);
+    if (rc == DUK_EXEC_SUCCESS) {
+        // Same as duk_peval_string: eval code runs with the global object as "this"
+        duk_push_global_object(ctx);
+        rc = duk_pcall_method(ctx, 0);
+    }
+    if (rc == DUK_EXEC_SUCCESS && jsEventLoopPending()) {
+        // The script body returned, now run its timers and input handlers
+        duk_pop(ctx);
+        rc = runEventLoop(ctx);
+    }
 
-    if (duk_peval_string(ctx, script) != DUK_EXEC_SUCCESS) {
+    if (rc != DUK_EXEC_SUCCESS) {
         tft.fillScreen(bruceConfig.bgColor);
         tft.setTextSize(FM);
         tft.setTextColor(TFT_RED, bruceConfig.bgColor);
@@ -1423,23 +1639,90 @@ void interpreterHandler(void *pvParameters) {
             printf("Script ran succesfully");
         }
     }
-    free((char *)script);
-    script = NULL;
-    free((char *)scriptDirpath);
-    scriptDirpath = NULL;
-    free((char *)scriptName);
-    scriptName = NULL;
+    freeScript();
     duk_pop(ctx);
-
-    // Clean up.
-    duk_destroy_heap(ctx);
+    jsProfilerEnd();
 
     clearDisplayModuleData();
+    clearStorageModuleData();
+    clearTimersModuleData(ctx);
+}
 
-    // delay(1000);
-    interpreter_start = false;
-    vTaskDelete(NULL);
-    return;
+static TaskHandle_t interpreterTaskHandle = NULL;
+static TaskHandle_t interpreterCaller = NULL;
+
+/*********************************************************************
+**  Function: interpreterHandler
+**  Resident interpreter task: waits for a script, runs it and resets
+**  the heap for the next one. With PSRAM the heap, natives and modules
+**  stay warm between runs; without it everything is freed after a run.
+**********************************************************************/
+void interpreterHandler(void *pvParameters) {
+    duk_context *ctx = NULL;
+    bool ctxProfiled = false;
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        log_d(
+            "init interpreter:\nPSRAM: [Free: %d, max alloc: %d],\nRAM: [Free: %d, "
+            "max alloc: %d]\n",
+            ESP.getFreePsram(),
+            ESP.getMaxAllocPsram(),
+            ESP.getFreeHeap(),
+            ESP.getMaxAllocHeap()
+        );
+        if (script != NULL) {
+            uint32_t t = millis();
+            // Natives are pushed as lightfuncs or profiled functions, toggling the profiler needs a new heap
+            if (ctx != NULL && ctxProfiled != jsProfilerEnabled()) {
+                duk_destroy_heap(ctx);
+                ctx = NULL;
+            }
+            bool warm = ctx != NULL;
+            ctxProfiled = jsProfilerEnabled();
+            if (ctx == NULL) ctx = createInterpreterHeap();
+            Serial.printf("Interpreter ready in %lums (%s heap)\n", millis() - t, warm ? "warm" : "new");
+            runScript(ctx);
+        }
+
+        bool keepWarm = psramFound();
+        if (ctx != NULL && (!keepWarm || !resetInterpreterHeap(ctx))) {
+            // Clean up.
+            duk_destroy_heap(ctx);
+            ctx = NULL;
+        }
+
+        if (!keepWarm) interpreterTaskHandle = NULL;
+        interpreter_start = false;
+        if (interpreterCaller != NULL) xTaskNotifyGive(interpreterCaller);
+        if (!keepWarm) vTaskDelete(NULL);
+    }
+}
+
+// Hand the script to the interpreter task, starting it if needed, and wait until it is done.
+// Must be called in the loop() function to work
+void runInterpreterService() {
+    interpreterCaller = xTaskGetCurrentTaskHandle();
+    if (interpreterTaskHandle == NULL) {
+        BaseType_t created = xTaskCreate(
+            interpreterHandler,     // Task function
+            "interpreterHandler",   // Task Name
+            16384,                  // Stack size
+            NULL,                   // Task parameters
+            2,                      // Task priority (0 to 3), loopTask has priority 2.
+            &interpreterTaskHandle  // Task handle
+        );
+        if (created != pdPASS) {
+            interpreterTaskHandle = NULL;
+            interpreterCaller = NULL;
+            freeScript();
+            interpreter_start = false;
+            displayError("Not enough memory to run the script", true);
+            return;
+        }
+    }
+    xTaskNotifyGive(interpreterTaskHandle);
+    while (interpreter_start == true) { ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(500)); }
+    interpreterCaller = NULL;
 }
 
 // function to start the JS Interpreterm choosinng the file, processing and
@@ -1458,6 +1741,9 @@ void run_bjs_script() {
     filename = loopSD(*fs, true, "BJS|JS");
     script = readBigFile(*fs, filename);
     if (script == NULL) { return; }
+    scriptDirpath = strdup(filename.substring(0, filename.lastIndexOf('/') + 1).c_str());
+    scriptName = strdup(filename.substring(filename.lastIndexOf('/') + 1).c_str());
+    scriptFs = fs;
 
     returnToMenu = true;
     interpreter_start = true;
@@ -1470,18 +1756,18 @@ bool run_bjs_script_headless(char *code) {
     if (script == NULL) { return false; }
     scriptDirpath = NULL;
     scriptName = NULL;
+    scriptFs = NULL;
     returnToMenu = true;
     interpreter_start = true;
     return true;
 }
 
-bool run_bjs_script_headless(FS fs, String filename) {
+bool run_bjs_script_headless(FS &fs, String filename) {
     script = readBigFile(fs, filename);
     if (script == NULL) { return false; }
-    const char *sName = filename.substring(0, filename.lastIndexOf('/')).c_str();
-    const char *sDirpath = filename.substring(filename.lastIndexOf('/') + 1).c_str();
-    scriptDirpath = strdup(sDirpath);
-    scriptName = strdup(sName);
+    scriptDirpath = strdup(filename.substring(0, filename.lastIndexOf('/') + 1).c_str());
+    scriptName = strdup(filename.substring(filename.lastIndexOf('/') + 1).c_str());
+    scriptFs = &fs;
     returnToMenu = true;
     interpreter_start = true;
     return true;
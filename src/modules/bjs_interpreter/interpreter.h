@@ -6,6 +6,7 @@
 #include <SD.h>
 #include <SPI.h>
 #include <chrono>
+#include <duktape.h>
 #include <string.h>
 
 // Credits to https://github.com/justinknight93/Doolittle
@@ -15,8 +16,13 @@
 void run_bjs_script();
 
 void interpreterHandler(void *pvParameters);
+void runInterpreterService();
 
 bool run_bjs_script_headless(char *code);
-bool run_bjs_script_headless(FS fs, String filename);
+bool run_bjs_script_headless(FS &fs, String filename);
+
+// Also used by the host runner in tools/bjs_host
+void registerInterpreterNatives(duk_context *ctx);
+void registerScriptGlobals(duk_context *ctx, const char *dirpath, const char *name);
 
 #endif
@@ -0,0 +1,159 @@
+#include "profiler_js.h"
+#include <algorithm>
+#include <map>
+#include <vector>
+
+struct JsProfileEntry {
+    String name;
+    duk_c_function func;
+    uint32_t calls;
+    uint64_t totalUs;
+    uint32_t maxUs;
+};
+
+static bool profilerEnabled = false;
+static std::vector<JsProfileEntry> entries;
+static std::map<String, uint32_t> lineSamples;
+static uint32_t depth = 0;
+static uint64_t nativeUs = 0; // time in the outermost natives only
+static uint32_t scriptStart = 0;
+static uint32_t scriptUs = 0;
+static uint32_t lastSample = 0;
+static uint32_t samples = 0;
+
+void jsProfilerSetEnabled(bool enabled) { profilerEnabled = enabled; }
+
+bool jsProfilerEnabled() { return profilerEnabled; }
+
+void jsProfilerReset() {
+    for (auto &e : entries) {
+        e.calls = 0;
+        e.totalUs = 0;
+        e.maxUs = 0;
+    }
+    lineSamples.clear();
+    depth = 0;
+    nativeUs = 0;
+    scriptUs = 0;
+    samples = 0;
+}
+
+void jsProfilerBegin() {
+    if (!profilerEnabled) return;
+    jsProfilerReset();
+    scriptStart = micros();
+    lastSample = scriptStart;
+}
+
+void jsProfilerEnd() {
+    if (!profilerEnabled) return;
+    scriptUs = micros() - scriptStart;
+    jsProfilerPrint(Serial);
+}
+
+// Count the script line that called the current native
+static void sampleLine(duk_context *ctx) {
+    duk_inspect_callstack_entry(ctx, -2);
+    if (!duk_is_object(ctx, -1)) {
+        duk_pop(ctx);
+        return;
+    }
+    duk_get_prop_string(ctx, -1, "lineNumber");
+    uint32_t line = duk_get_uint_default(ctx, -1, 0);
+    duk_get_prop_string(ctx, -2, "function");
+    duk_get_prop_string(ctx, -1, "fileName");
+    String key = String(duk_get_string_default(ctx, -1, "?")) + ":" + String(line);
+    duk_pop_n(ctx, 4);
+    lineSamples[key]++;
+    samples++;
+}
+
+static duk_ret_t callNative(duk_context *ctx, void *udata) { return ((duk_c_function)udata)(ctx); }
+
+static duk_ret_t profiledCall(duk_context *ctx) {
+    duk_push_current_function(ctx);
+    duk_get_prop_string(ctx, -1, DUK_HIDDEN_SYMBOL("profIdx"));
+    size_t index = duk_get_uint(ctx, -1);
+    duk_pop_2(ctx);
+
+    uint32_t start = micros();
+    if (start - lastSample >= JS_PROFILER_SAMPLE_US) {
+        lastSample = start;
+        sampleLine(ctx);
+    }
+
+    // Safe call, so the time of natives that throw is counted before the error goes on.
+    // It runs in this activation: the native sees the same arguments, this and magic
+    depth++;
+    duk_int_t rc = duk_safe_call(ctx, callNative, (void *)entries[index].func, duk_get_top(ctx), 1);
+    depth--;
+
+    uint32_t elapsed = micros() - start;
+    JsProfileEntry &entry = entries[index]; // natives like require() can register new entries
+    entry.calls++;
+    entry.totalUs += elapsed;
+    entry.maxUs = max(entry.maxUs, elapsed);
+    if (depth == 0) nativeUs += elapsed;
+
+    if (rc != DUK_EXEC_SUCCESS) return duk_throw(ctx);
+    return 1;
+}
+
+void jsProfilerPushFunction(
+    duk_context *ctx, const char *name, duk_c_function func, duk_idx_t nargs, duk_idx_t magic
+) {
+    size_t index = 0;
+    while (index < entries.size() && !(entries[index].func == func && entries[index].name == name)) index++;
+    if (index == entries.size()) entries.push_back({name, func, 0, 0, 0});
+
+    duk_push_c_function(ctx, profiledCall, nargs);
+    duk_set_magic(ctx, -1, magic);
+    duk_push_uint(ctx, index);
+    duk_put_prop_string(ctx, -2, DUK_HIDDEN_SYMBOL("profIdx"));
+}
+
+/*********************************************************************
+**  Function: jsProfilerPrint
+**  Natives sorted by total time, then the most sampled script lines
+**********************************************************************/
+void jsProfilerPrint(Print &out) {
+    std::vector<const JsProfileEntry *> used;
+    for (auto &e : entries) {
+        if (e.calls) used.push_back(&e);
+    }
+    std::sort(used.begin(), used.end(), [](const JsProfileEntry *a, const JsProfileEntry *b) {
+        return a->totalUs > b->totalUs;
+    });
+
+    uint32_t totalMs = scriptUs / 1000;
+    uint32_t nativeMs = nativeUs / 1000;
+    out.printf(
+        "JS profile: %lu ms total, %lu ms in natives, %lu ms in bytecode/GC\n",
+        totalMs,
+        nativeMs,
+        totalMs > nativeMs ? totalMs - nativeMs : 0
+    );
+    out.println("     calls   total ms     avg us     max us  native");
+    for (auto e : used) {
+        out.printf(
+            "%10lu %10lu %10lu %10lu  %s\n",
+            e->calls,
+            (uint32_t)(e->totalUs / 1000),
+            (uint32_t)(e->totalUs / e->calls),
+            e->maxUs,
+            e->name.c_str()
+        );
+    }
+
+    typedef std::pair<String, uint32_t> LineCount;
+    std::vector<LineCount> lines(lineSamples.begin(), lineSamples.end());
+    std::sort(lines.begin(), lines.end(), [](const LineCount &a, const LineCount &b) {
+        return a.second > b.second;
+    });
+    out.printf(
+        "Sampled lines (%lu samples, every %d ms at native calls):\n", samples, JS_PROFILER_SAMPLE_US / 1000
+    );
+    for (size_t i = 0; i < lines.size() && i < JS_PROFILER_TOP_LINES; i++) {
+        out.printf("%10lu  %s\n", lines[i].second, lines[i].first.c_str());
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef __PROFILER_JS_H__
+#define __PROFILER_JS_H__
+#include <Arduino.h>
+#include <duktape.h>
+
+// Minimum time between two script line samples
+#ifndef JS_PROFILER_SAMPLE_US
+#define JS_PROFILER_SAMPLE_US 10000
+#endif
+// Lines shown in the report
+#ifndef JS_PROFILER_TOP_LINES
+#define JS_PROFILER_TOP_LINES 15
+#endif
+
+/*
+ * Opt-in profiler for the interpreter. When enabled, the natives registered
+ * through bduk_register_c_lightfunc/bduk_put_prop_c_lightfunc are pushed as
+ * C functions going through a timing trampoline instead of lightfuncs, which
+ * counts calls and wall time per native. While in a native, the calling
+ * script line is sampled at most every JS_PROFILER_SAMPLE_US, so pure
+ * bytecode loops that never call a native are not sampled.
+ * The interpreter heap must be recreated when this is turned on or off.
+ */
+void jsProfilerSetEnabled(bool enabled);
+bool jsProfilerEnabled();
+
+// Called by the interpreter around each script run
+void jsProfilerBegin();
+void jsProfilerEnd();
+
+void jsProfilerReset();
+void jsProfilerPrint(Print &out);
+
+// Push the profiled replacement of a native, with the same nargs and magic as the lightfunc
+void jsProfilerPushFunction(
+    duk_context *ctx, const char *name, duk_c_function func, duk_idx_t nargs, duk_idx_t magic
+);
+
+#endif
@@ -0,0 +1,187 @@
+#include "storage_js.h"
+
+#include "helpers_js.h"
+#include <globals.h>
+#include <map>
+
+// Files opened by the scripts, closed when the script ends. Ids are never
+// reused, so a handle left over from a previous run can't reach a new file
+static std::map<uint32_t, File *> openFiles;
+static uint32_t nextFileId = 1;
+
+void clearStorageModuleData() {
+    for (auto &entry : openFiles) {
+        entry.second->close();
+        delete entry.second;
+    }
+    openFiles.clear();
+}
+
+static uint32_t getFileId(duk_context *ctx, duk_idx_t obj_idx) {
+    uint32_t fileId = 0;
+    if (duk_get_prop_string(ctx, obj_idx, "filePointer")) fileId = duk_to_uint32(ctx, -1);
+    duk_pop(ctx);
+    return fileId;
+}
+
+// Get the File behind "this", NULL if it was closed
+static File *getThisFile(duk_context *ctx) {
+    duk_push_this(ctx);
+    auto it = openFiles.find(getFileId(ctx, -1));
+    duk_pop(ctx);
+    return it == openFiles.end() ? NULL : it->second;
+}
+
+duk_ret_t native_fileRead(duk_context *ctx) {
+    // usage: file.read(length: number, asString?: boolean): Uint8Array | string
+    // Reads up to length bytes from the current position straight into a
+    // Duktape buffer. Returns an empty result at the end of the file.
+    File *file = getThisFile(ctx);
+    if (file == NULL) return duk_error(ctx, DUK_ERR_ERROR, "%s: File is closed", "file.read");
+
+    size_t length = duk_get_uint_default(ctx, 0, 512);
+    // seek() may have gone past the end
+    size_t size = file->size();
+    size_t position = file->position();
+    size_t available = position >= size ? 0 : size - position;
+    if (length > available) length = available;
+
+    void *buf = duk_push_fixed_buffer(ctx, length);
+    int bytesRead = length ? file->read((uint8_t *)buf, length) : 0;
+    if (bytesRead < 0) bytesRead = 0;
+
+    if (duk_get_boolean_default(ctx, 1, false)) {
+        duk_push_lstring(ctx, (const char *)buf, bytesRead);
+    } else {
+        // View over the data actually read, the buffer is not copied
+        duk_push_buffer_object(ctx, -1, 0, bytesRead, DUK_BUFOBJ_UINT8ARRAY);
+    }
+    return 1;
+}
+
+duk_ret_t native_fileReadLine(duk_context *ctx) {
+    // usage: file.readLine(): string | null
+    // Reads until the next '\n' (not included), null at the end of the file.
+    File *file = getThisFile(ctx);
+    if (file == NULL) return duk_error(ctx, DUK_ERR_ERROR, "%s: File is closed", "file.readLine");
+    if (file->available() <= 0) { // negative after a seek() past the end
+        duk_push_null(ctx);
+        return 1;
+    }
+
+    String line = file->readStringUntil('\n');
+    if (line.endsWith("\r")) line.remove(line.length() - 1);
+    duk_push_lstring(ctx, line.c_str(), line.length());
+    return 1;
+}
+
+duk_ret_t native_fileWrite(duk_context *ctx) {
+    // usage: file.write(data: string | Uint8Array | ArrayBuffer): number
+    // Writes at the current position and returns the number of bytes written.
+    File *file = getThisFile(ctx);
+    if (file == NULL) return duk_error(ctx, DUK_ERR_ERROR, "%s: File is closed", "file.write");
+
+    duk_size_t dataSize = 0;
+    const void *data = NULL;
+    if (duk_is_buffer_data(ctx, 0)) {
+        data = duk_get_buffer_data(ctx, 0, &dataSize);
+    } else {
+        data = duk_to_lstring(ctx, 0, &dataSize);
+    }
+
+    size_t written = dataSize ? file->write((const uint8_t *)data, dataSize) : 0;
+    duk_push_uint(ctx, written);
+    return 1;
+}
+
+duk_ret_t native_fileSeek(duk_context *ctx) {
+    // usage: file.seek(position: number, whence?: "set" | "cur" | "end"): boolean
+    File *file = getThisFile(ctx);
+    if (file == NULL) return duk_error(ctx, DUK_ERR_ERROR, "%s: File is closed", "file.seek");
+
+    SeekMode mode = SeekSet;
+    const char *whence = duk_get_string_default(ctx, 1, "set");
+    if (strcmp(whence, "cur") == 0) mode = SeekCur;
+    else if (strcmp(whence, "end") == 0) mode = SeekEnd;
+
+    duk_push_boolean(ctx, file->seek(duk_get_int_default(ctx, 0, 0), mode));
+    return 1;
+}
+
+duk_ret_t native_filePosition(duk_context *ctx) {
+    // usage: file.position(): number
+    File *file = getThisFile(ctx);
+    duk_push_uint(ctx, file ? file->position() : 0);
+    return 1;
+}
+
+duk_ret_t native_fileSize(duk_context *ctx) {
+    // usage: file.size(): number
+    File *file = getThisFile(ctx);
+    duk_push_uint(ctx, file ? file->size() : 0);
+    return 1;
+}
+
+duk_ret_t native_fileClose(duk_context *ctx) {
+    // usage: file.close(): boolean
+    // Also used as finalizer, so it can be called with the handle as argument
+    if (duk_is_object(ctx, 0)) {
+        duk_to_object(ctx, 0);
+    } else {
+        duk_push_this(ctx);
+    }
+
+    duk_idx_t obj_idx = duk_get_top_index(ctx);
+    bool result = false;
+    auto it = openFiles.find(getFileId(ctx, obj_idx));
+    if (it != openFiles.end()) {
+        it->second->close();
+        delete it->second;
+        openFiles.erase(it);
+        result = true;
+        bduk_put_prop(ctx, obj_idx, "filePointer", duk_push_uint, 0);
+    }
+    duk_push_boolean(ctx, result);
+    return 1;
+}
+
+duk_ret_t native_storageOpen(duk_context *ctx) {
+    // usage: storageOpen(path: string | Path, mode?: "r" | "w" | "a" | "r+" | "w+" | "a+"):
+    // FileHandle | null
+    // Returns a handle over the native File, so files larger than RAM can be
+    // processed in chunks with read/readLine/write/seek. Default mode is "r".
+    FileParamsJS fileParams = js_get_path_from_params(ctx, true);
+    if (!fileParams.path.startsWith("/")) fileParams.path = "/" + fileParams.path; // add "/" if missing
+
+    String mode = duk_get_string_default(ctx, 1 + fileParams.paramOffset, FILE_READ);
+    if (mode != "r" && mode != "w" && mode != "a" && mode != "r+" && mode != "w+" && mode != "a+") {
+        return duk_error(ctx, DUK_ERR_TYPE_ERROR, "%s: Invalid mode: %s", "storageOpen", mode.c_str());
+    }
+
+    File file = (fileParams.fs)->open(fileParams.path, mode.c_str(), mode != "r");
+    if (!file || file.isDirectory()) {
+        if (file) file.close();
+        duk_push_null(ctx);
+        return 1;
+    }
+
+    uint32_t fileId = nextFileId++;
+    openFiles[fileId] = new File(file);
+
+    duk_idx_t obj_idx = duk_push_object(ctx);
+    bduk_put_prop(ctx, obj_idx, "filePointer", duk_push_uint, fileId); // MEMO: 0 means closed
+    bduk_put_prop(ctx, obj_idx, "path", duk_push_string, fileParams.path.c_str());
+
+    bduk_put_prop_c_lightfunc(ctx, obj_idx, "read", native_fileRead, 2, 0);
+    bduk_put_prop_c_lightfunc(ctx, obj_idx, "readLine", native_fileReadLine, 0, 0);
+    bduk_put_prop_c_lightfunc(ctx, obj_idx, "write", native_fileWrite, 1, 0);
+    bduk_put_prop_c_lightfunc(ctx, obj_idx, "seek", native_fileSeek, 2, 0);
+    bduk_put_prop_c_lightfunc(ctx, obj_idx, "position", native_filePosition, 0, 0);
+    bduk_put_prop_c_lightfunc(ctx, obj_idx, "size", native_fileSize, 0, 0);
+    bduk_put_prop_c_lightfunc(ctx, obj_idx, "close", native_fileClose, 0, 0);
+
+    duk_push_c_lightfunc(ctx, native_fileClose, 1, 1, 0);
+    duk_set_finalizer(ctx, obj_idx);
+
+    return 1;
+}
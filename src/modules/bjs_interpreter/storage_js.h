@@ -0,0 +1,16 @@
+#ifndef __STORAGE_JS_H__
+#define __STORAGE_JS_H__
+#include <duktape.h>
+
+void clearStorageModuleData();
+
+duk_ret_t native_storageOpen(duk_context *ctx);
+duk_ret_t native_fileRead(duk_context *ctx);
+duk_ret_t native_fileReadLine(duk_context *ctx);
+duk_ret_t native_fileWrite(duk_context *ctx);
+duk_ret_t native_fileSeek(duk_context *ctx);
+duk_ret_t native_filePosition(duk_context *ctx);
+duk_ret_t native_fileSize(duk_context *ctx);
+duk_ret_t native_fileClose(duk_context *ctx);
+
+#endif
@@ -0,0 +1,202 @@
+#include "timers_js.h"
+
+#include "helpers_js.h"
+#include <globals.h>
+#include <vector>
+
+struct JsTimer {
+    uint32_t id;
+    uint32_t due;
+    uint32_t interval; // 0 for setTimeout
+};
+
+struct JsInputEvent {
+    const char *name;
+    volatile bool *flag;
+};
+
+// "any" goes last: checking a button also clears AnyKeyPress
+static const JsInputEvent inputEvents[] = {
+    {"esc",  &EscPress   },
+    {"sel",  &SelPress   },
+    {"prev", &PrevPress  },
+    {"next", &NextPress  },
+    {"up",   &UpPress    },
+    {"down", &DownPress  },
+    {"any",  &AnyKeyPress},
+};
+#define INPUT_EVENT_COUNT (sizeof(inputEvents) / sizeof(inputEvents[0]))
+
+// Callbacks are kept in the global stash so they are not garbage collected:
+// stash.timers[id] = [callback, ...args] and stash.inputHandlers[name] = callback
+static std::vector<JsTimer> timers;
+static uint32_t nextTimerId = 1;
+static uint8_t inputHandlerMask = 0;
+
+static void pushStashObject(duk_context *ctx, const char *name) {
+    duk_push_global_stash(ctx);
+    if (!duk_get_prop_string(ctx, -1, name)) {
+        duk_pop(ctx);
+        duk_push_bare_object(ctx);
+        duk_dup_top(ctx);
+        duk_put_prop_string(ctx, -3, name);
+    }
+    duk_remove(ctx, -2);
+}
+
+void clearTimersModuleData(duk_context *ctx) {
+    timers.clear();
+    inputHandlerMask = 0;
+    duk_push_global_stash(ctx);
+    duk_push_bare_object(ctx);
+    duk_put_prop_string(ctx, -2, "timers");
+    duk_push_bare_object(ctx);
+    duk_put_prop_string(ctx, -2, "inputHandlers");
+    duk_pop(ctx);
+}
+
+bool jsEventLoopPending() { return !timers.empty() || inputHandlerMask != 0; }
+
+static void removeTimer(duk_context *ctx, uint32_t id) {
+    for (auto it = timers.begin(); it != timers.end(); it++) {
+        if (it->id == id) {
+            timers.erase(it);
+            break;
+        }
+    }
+    pushStashObject(ctx, "timers");
+    duk_del_prop_index(ctx, -1, id);
+    duk_pop(ctx);
+}
+
+duk_ret_t native_setTimeout(duk_context *ctx) {
+    // usage: setTimeout(callback: function, delay?: number, ...args): number
+    // usage: setInterval(callback: function, delay?: number, ...args): number
+    // The callbacks run once the script body returns, see runEventLoop.
+    duk_require_callable(ctx, 0);
+    int32_t delayMs = max<int32_t>(duk_get_int_default(ctx, 1, 0), 0);
+    bool repeat = duk_get_current_magic(ctx) == 1;
+
+    // Arguments without the delay: [callback, ...args]
+    duk_idx_t nargs = duk_get_top(ctx);
+    duk_push_array(ctx);
+    for (duk_idx_t i = 0, n = 0; i < nargs; i++) {
+        if (i == 1) continue;
+        duk_dup(ctx, i);
+        duk_put_prop_index(ctx, -2, n++);
+    }
+
+    uint32_t id = nextTimerId++;
+    pushStashObject(ctx, "timers");
+    duk_dup(ctx, -2);
+    duk_put_prop_index(ctx, -2, id);
+
+    // Intervals of 0 would never let the loop sleep
+    timers.push_back({id, millis() + delayMs, repeat ? max<uint32_t>(delayMs, 1) : 0});
+    duk_push_uint(ctx, id);
+    return 1;
+}
+
+duk_ret_t native_clearTimeout(duk_context *ctx) {
+    // usage: clearTimeout(id: number)
+    // usage: clearInterval(id: number)
+    if (duk_is_number(ctx, 0)) removeTimer(ctx, duk_get_uint(ctx, 0));
+    return 0;
+}
+
+duk_ret_t native_inputOnPress(duk_context *ctx) {
+    // usage: onPress(button: "esc" | "sel" | "prev" | "next" | "up" | "down" | "any",
+    // callback: function | null)
+    // The callback gets the button name, null removes the handler.
+    // Without an "esc" handler, Esc ends the event loop.
+    const char *button = duk_require_string(ctx, 0);
+    size_t index = 0;
+    while (index < INPUT_EVENT_COUNT && strcmp(inputEvents[index].name, button) != 0) index++;
+    if (index == INPUT_EVENT_COUNT) {
+        return duk_error(ctx, DUK_ERR_TYPE_ERROR, "%s: Invalid button: %s", "onPress", button);
+    }
+
+    pushStashObject(ctx, "inputHandlers");
+    if (duk_is_callable(ctx, 1)) {
+        duk_dup(ctx, 1);
+        duk_put_prop_string(ctx, -2, button);
+        inputHandlerMask |= 1 << index;
+    } else {
+        duk_del_prop_string(ctx, -1, button);
+        inputHandlerMask &= ~(1 << index);
+    }
+    return 0;
+}
+
+// Push stash.timers[id] as the callback followed by its arguments, returns the number of arguments
+static duk_idx_t pushTimerCall(duk_context *ctx, uint32_t id) {
+    pushStashObject(ctx, "timers");
+    duk_get_prop_index(ctx, -1, id);
+    duk_remove(ctx, -2);
+    duk_idx_t arr_idx = duk_get_top_index(ctx);
+    duk_size_t length = duk_get_length(ctx, arr_idx);
+    for (duk_size_t i = 0; i < length; i++) duk_get_prop_index(ctx, arr_idx, i);
+    duk_remove(ctx, arr_idx);
+    return length - 1;
+}
+
+static duk_int_t callInputHandler(duk_context *ctx, const char *button) {
+    pushStashObject(ctx, "inputHandlers");
+    duk_get_prop_string(ctx, -1, button);
+    duk_remove(ctx, -2);
+    duk_push_string(ctx, button);
+    return duk_pcall(ctx, 1);
+}
+
+/*********************************************************************
+**  Function: runEventLoop
+**  Service the timers and input handlers left by the script
+**********************************************************************/
+duk_int_t runEventLoop(duk_context *ctx) {
+    duk_int_t rc = DUK_EXEC_SUCCESS;
+    while (jsEventLoopPending()) {
+        for (size_t i = 0; i < INPUT_EVENT_COUNT && rc == DUK_EXEC_SUCCESS; i++) {
+            if (!(inputHandlerMask & (1 << i)) || !check(*inputEvents[i].flag)) continue;
+            rc = callInputHandler(ctx, inputEvents[i].name);
+            if (rc == DUK_EXEC_SUCCESS) duk_pop(ctx);
+        }
+        if (rc != DUK_EXEC_SUCCESS) break;
+        if (!(inputHandlerMask & 1) && check(EscPress)) break;
+
+        // Only the timers due now: callbacks can add or clear timers
+        uint32_t now = millis();
+        while (rc == DUK_EXEC_SUCCESS) {
+            JsTimer *next = NULL;
+            for (auto &timer : timers) {
+                if ((int32_t)(timer.due - now) > 0) continue;
+                if (next == NULL || (int32_t)(timer.due - next->due) < 0) next = &timer;
+            }
+            if (next == NULL) break;
+
+            uint32_t id = next->id;
+            duk_idx_t nargs = pushTimerCall(ctx, id);
+            if (next->interval == 0) {
+                removeTimer(ctx, id); // the callback stays alive on the stack
+            } else {
+                // A late interval is rescheduled from now instead of firing repeatedly to catch up
+                next->due += next->interval;
+                if ((int32_t)(next->due - now) <= 0) next->due = now + next->interval;
+            }
+            rc = duk_pcall(ctx, nargs);
+            if (rc == DUK_EXEC_SUCCESS) duk_pop(ctx);
+        }
+        if (rc != DUK_EXEC_SUCCESS) break;
+
+        // Sleep until the next deadline, at most JS_EVENT_POLL_MS to check the buttons
+        uint32_t wait = JS_EVENT_POLL_MS;
+        now = millis();
+        for (auto &timer : timers) {
+            int32_t left = timer.due - now;
+            if (left < (int32_t)wait) wait = max<int32_t>(left, 1);
+        }
+        vTaskDelay(max<uint32_t>(pdMS_TO_TICKS(wait), 1));
+    }
+
+    if (rc == DUK_EXEC_SUCCESS) duk_push_undefined(ctx);
+    return rc;
+}
@@ -0,0 +1,27 @@
+#ifndef __TIMERS_JS_H__
+#define __TIMERS_JS_H__
+#include <duktape.h>
+
+// Longest sleep of the event loop while waiting, buttons are checked at this rate
+#ifndef JS_EVENT_POLL_MS
+#define JS_EVENT_POLL_MS 20
+#endif
+
+void clearTimersModuleData(duk_context *ctx);
+
+duk_ret_t native_setTimeout(duk_context *ctx);
+duk_ret_t native_clearTimeout(duk_context *ctx);
+duk_ret_t native_inputOnPress(duk_context *ctx);
+
+// True if the script left timers or input handlers behind
+bool jsEventLoopPending();
+
+/*
+ * Run the timers and input handlers until none is left or Esc is pressed
+ * (when there is no "esc" handler). The task sleeps until the next deadline,
+ * waking every JS_EVENT_POLL_MS to check the buttons. Pushes undefined, or
+ * the error thrown by a callback, which also ends the loop.
+ */
+duk_int_t runEventLoop(duk_context *ctx);
+
+#endif
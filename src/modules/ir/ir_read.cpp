@@ -182,6 +182,7 @@ void IrRead::read_signal() {
     // Always switches to RAW data, regardless of the decoding result
     raw = true;
 
+    tft.beginFrame("irRead");
     display_banner();
 
     // Dump of signal details
@@ -192,6 +193,7 @@ void IrRead::read_signal() {
     ); // Shows the RAW signal on the display
 
     display_btn_options();
+    tft.endFrame();
     delay(500);
 }
 
@@ -454,6 +456,7 @@ bool IrRead::write_file(String filename, FS *fs) {
     file.print(strDeviceContent);
 
     file.close();
+    fileChanged(*fs, "/BruceIR/" + filename + ".ir");
     delay(100);
     return true;
 }
@@ -53,6 +53,7 @@ void rf_spectrum() {
         rmt_item32_t *item = (rmt_item32_t *)xRingbufferReceive(rb, &rx_size, 500);
         if (item != nullptr) {
             if (rx_size != 0) {
+                tft.beginFrame("rfSpectrum");
                 // Clear the display area
                 tft.fillRect(0, 20, tftWidth, tftHeight, bruceConfig.bgColor);
                 // Draw waveform based on signal strength
@@ -66,6 +67,7 @@ void rf_spectrum() {
                     int endY = constrain(20 + tftHeight / 2 + lineHeight / 2, 20, 20 + tftHeight);
                     tft.drawLine(lineX, startY, lineX, endY, bruceConfig.priColor);
                 }
+                tft.endFrame();
             }
             vRingbufferReturnItem(rb, (void *)item);
         }
@@ -185,6 +185,7 @@ void rf_waterfall_run() {
                 delay(100);
             }
         }
+        tft.beginFrame("rfWaterfall");
         tft.drawPixel(0, 0, 0); // Cardputer Case, need to call something to the tft.
         tft.pushImage(0, current_line, screen_width, 1, frameBuffer);
         tft.drawFastHLine(0, current_line + 1, screen_width, TFT_DARKGREY);
@@ -212,6 +213,7 @@ void rf_waterfall_run() {
             tft.setTextColor(TFT_WHITE);
             tft.print("EXIT");
         }
+        tft.endFrame();
 
         if (check(EscPress)) break;
 
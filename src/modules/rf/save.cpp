@@ -1,4 +1,5 @@
 #include "save.h"
+#include "core/sd_functions.h"
 
 bool rf_raw_save(RawRecording recorded) {
     FS *fs = nullptr;
@@ -71,6 +72,7 @@ bool rf_raw_save(RawRecording recorded) {
     }
 
     file.close();
+    fileChanged(*fs, filename);
     displaySuccess(filename, true);
     return true;
 }
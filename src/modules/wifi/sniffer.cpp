@@ -64,6 +64,7 @@ File _pcap_file;
 std::set<BeaconList> registeredBeacons;
 std::set<String> SavedHS; // Saves the MAC of beacon HS detected in the session
 String filename = "/BrucePCAP/" + (String)FILENAME + ".pcap";
+static std::vector<String> sessionCaptures; // files opened by openFile since the sniffer started
 
 //===== FUNCTIONS =====//
 
@@ -107,6 +108,19 @@ typedef struct pcaprec_hdr_s {
     uint32_t orig_len; /* longueur réelle du paquet */
 } pcaprec_hdr_t;
 
+static void handshakeFileName(const uint8_t *apAddr, char *out) {
+    sprintf(
+        out,
+        "/BrucePCAP/handshakes/HS_%02X%02X%02X%02X%02X%02X.pcap",
+        apAddr[0],
+        apAddr[1],
+        apAddr[2],
+        apAddr[3],
+        apAddr[4],
+        apAddr[5]
+    );
+}
+
 void saveHandshake(const wifi_promiscuous_pkt_t *packet, bool beacon, FS &Fs) {
     // Construire le nom du fichier en utilisant les adresses MAC de l'AP et du client
     const uint8_t *addr1 = packet->payload + 4;  // Adresse du destinataire (Adresse 1)
@@ -121,16 +135,7 @@ void saveHandshake(const wifi_promiscuous_pkt_t *packet, bool beacon, FS &Fs) {
     }
 
     char nomFichier[50];
-    sprintf(
-        nomFichier,
-        "/BrucePCAP/handshakes/HS_%02X%02X%02X%02X%02X%02X.pcap",
-        apAddr[0],
-        apAddr[1],
-        apAddr[2],
-        apAddr[3],
-        apAddr[4],
-        apAddr[5]
-    );
+    handshakeFileName(apAddr, nomFichier);
 
     // Vérifier si le fichier existe déjà
     bool fichierExiste = false;
@@ -332,6 +337,7 @@ void openFile(FS &Fs) {
     }
     if (!Fs.exists("/BrucePCAP/handshakes")) Fs.mkdir("/BrucePCAP/handshakes");
     _pcap_file = Fs.open(filename, FILE_WRITE);
+    sessionCaptures.push_back(filename);
     if (_pcap_file) {
         fileOpen = writeHeader(_pcap_file);
         // Serial.println("opened: " + filename);
@@ -358,6 +364,7 @@ void sniffer_setup() {
         isLittleFS = false;
     } else Fs = &LittleFS; // if not, use the internal memory.
 
+    sessionCaptures.clear();
     openFile(*Fs);
     displayTextLine("Sniffing Started");
     tft.setTextSize(FP);
@@ -517,6 +524,7 @@ void sniffer_setup() {
 	  uint32_t runtime = (millis() - start_time)/1000;
 	    
 	  if (returnToMenu) goto Exit;
+	  tft.beginFrame("sniffer");
 	  tft.drawPixel(0, 0, 0);
 	  drawMainBorderWithTitle("pcap sniffer"); // Clear Screen and redraw border
 	  tft.setTextSize(FP);
@@ -542,6 +550,7 @@ void sniffer_setup() {
 			      );
 	  tft.drawString(" EAPOL: " + String(num_EAPOL) + " HS: " + String(num_HS) + " ", 10, tftHeight - 18);
 	  tft.drawCentreString("Packets " + String(packet_counter), tftWidth / 2, tftHeight - 26, 1);
+	  tft.endFrame();
 
 	}
 
@@ -591,6 +600,15 @@ Exit:
     esp_wifi_deinit();
     wifiDisconnect();
     vTaskDelay(1 / portTICK_RATE_MS);
+    if (_pcap_file) _pcap_file.close();
+    // Only the captures and handshakes of this session, the folder may hold hundreds of older ones
+    for (const String &capture : sessionCaptures) fileChanged(*Fs, capture);
+    sessionCaptures.clear();
+    char handshake[50];
+    for (const String &mac : SavedHS) {
+        handshakeFileName((const uint8_t *)mac.c_str(), handshake);
+        fileChanged(*Fs, handshake);
+    }
 }
 
 void setHandshakeSniffer() {
@@ -0,0 +1,220 @@
+/*
+ * Host runner for BJS scripts: runs a script on a workstation with the
+ * natives of src/modules/bjs_interpreter, built against the stand-in HAL of
+ * hal/, and reports the run time and the Duktape heap high-water mark.
+ * Exits with 1 when the script throws, so it can be used in CI.
+ *
+ * usage: bjs_host [options] script.js
+ */
+#include "modules/bjs_interpreter/bytecode_cache.h"
+#include "modules/bjs_interpreter/display_js.h"
+#include "modules/bjs_interpreter/interpreter.h"
+#include "modules/bjs_interpreter/profiler_js.h"
+#include "modules/bjs_interpreter/storage_js.h"
+#include "modules/bjs_interpreter/timers_js.h"
+
+#include <chrono>
+#include <filesystem>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+size_t hostHeapUsed = 0;
+size_t hostHeapPeak = 0;
+size_t hostHeapLimit = 0; // 0 for no limit
+static uint32_t heapAllocs = 0;
+
+/*********************************************************************
+**  Heap allocator
+**  Same role as ps_alloc_function in interpreter.cpp, with the block
+**  size stored in front of each block to track usage.
+**********************************************************************/
+union HeapHeader {
+    size_t size;
+    max_align_t align;
+};
+
+static void *heapAlloc(void *udata, duk_size_t size) {
+    if (size == 0) return NULL;
+    if (hostHeapLimit && hostHeapUsed + size > hostHeapLimit) return NULL;
+    HeapHeader *block = (HeapHeader *)malloc(sizeof(HeapHeader) + size);
+    if (block == NULL) return NULL;
+    block->size = size;
+    hostHeapUsed += size;
+    if (hostHeapUsed > hostHeapPeak) hostHeapPeak = hostHeapUsed;
+    heapAllocs++;
+    return block + 1;
+}
+
+static void heapFree(void *udata, void *ptr) {
+    if (ptr == NULL) return;
+    HeapHeader *block = (HeapHeader *)ptr - 1;
+    hostHeapUsed -= block->size;
+    free(block);
+}
+
+static void *heapRealloc(void *udata, void *ptr, duk_size_t size) {
+    if (ptr == NULL) return heapAlloc(udata, size);
+    if (size == 0) {
+        heapFree(udata, ptr);
+        return NULL;
+    }
+    HeapHeader *block = (HeapHeader *)ptr - 1;
+    size_t oldSize = block->size;
+    if (hostHeapLimit && size > oldSize && hostHeapUsed + size - oldSize > hostHeapLimit) return NULL;
+    block = (HeapHeader *)realloc(block, sizeof(HeapHeader) + size);
+    if (block == NULL) return NULL;
+    block->size = size;
+    hostHeapUsed = hostHeapUsed - oldSize + size;
+    if (hostHeapUsed > hostHeapPeak) hostHeapPeak = hostHeapUsed;
+    heapAllocs++;
+    return block + 1;
+}
+
+static std::chrono::steady_clock::time_point runStart;
+static size_t baseHeap = 0;
+
+static void printReport(bool ok) {
+    double elapsedMs =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - runStart).count();
+    fprintf(
+        stderr,
+        "Script %s in %.1f ms, heap: %zu bytes peak, %zu after natives, %zu in use, %u allocations\n",
+        ok ? "ran" : "failed",
+        elapsedMs,
+        hostHeapPeak,
+        baseHeap,
+        hostHeapUsed,
+        heapAllocs
+    );
+}
+
+void hostStop(const char *reason) {
+    fflush(stdout);
+    fprintf(stderr, "Script stopped: %s\n", reason);
+    jsProfilerEnd();
+    printReport(false);
+    exit(1);
+}
+
+static void fatalHandler(void *udata, const char *msg) {
+    fprintf(stderr, "*** FATAL ERROR: %s\n", msg ? msg : "no message");
+    exit(2);
+}
+
+static void usage() {
+    fprintf(
+        stderr,
+        "usage: bjs_host [options] script.js\n"
+        "  --root <dir>       directory used as SD card and LittleFS (default .)\n"
+        "  --writes <dir>     keep the files the script writes there, the --root dir to write in place\n"
+        "                     (default a temporary directory removed at exit)\n"
+        "  --max-heap <bytes> fail allocations above this, ex: 120000 for a board without PSRAM\n"
+        "  --timeout <ms>     press Esc after this, 0 to wait forever (default 30000)\n"
+        "  --screen <w>x<h>   display size returned by width()/height() (default 240x135)\n"
+        "  --no-delay         delay() and timers advance a virtual clock\n"
+        "  --trace            print the calls to the stand-in hardware\n"
+        "  --profile          print calls and time per native\n"
+    );
+}
+
+int main(int argc, char **argv) {
+    std::string scriptArg;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--root" && hasValue) {
+            hostOptions.root = argv[++i];
+        } else if (arg == "--writes" && hasValue) {
+            hostOptions.writes = argv[++i];
+        } else if (arg == "--max-heap" && hasValue) {
+            hostHeapLimit = strtoul(argv[++i], NULL, 10);
+        } else if (arg == "--timeout" && hasValue) {
+            hostOptions.timeoutMs = strtoul(argv[++i], NULL, 10);
+        } else if (arg == "--screen" && hasValue) {
+            sscanf(argv[++i], "%dx%d", &hostOptions.width, &hostOptions.height);
+        } else if (arg == "--no-delay") {
+            hostOptions.noDelay = true;
+        } else if (arg == "--trace") {
+            hostOptions.trace = true;
+        } else if (arg == "--profile") {
+            hostOptions.profile = true;
+        } else if (arg[0] != '-' && scriptArg.empty()) {
+            scriptArg = arg;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (scriptArg.empty()) {
+        usage();
+        return 2;
+    }
+    if (hostOptions.writes.empty()) {
+        // Bytecode caches and script output stay out of --root, often a checkout
+        char tmp[] = "/tmp/bjs_host.XXXXXX";
+        if (mkdtemp(tmp) == NULL) {
+            perror("mkdtemp");
+            return 2;
+        }
+        hostOptions.writes = tmp;
+        atexit([] {
+            std::error_code ec;
+            std::filesystem::remove_all(hostOptions.writes, ec);
+        });
+    }
+
+    // Scripts see paths relative to the root, like on the SD card
+    std::string scriptPath = scriptArg;
+    if (scriptPath.compare(0, hostOptions.root.size(), hostOptions.root) == 0) {
+        scriptPath = scriptPath.substr(hostOptions.root.size());
+    }
+    if (scriptPath.empty() || scriptPath[0] != '/') scriptPath = "/" + scriptPath;
+    size_t scriptLen = 0;
+    char *script = readBigFile(SD, scriptPath.c_str(), false, &scriptLen);
+    if (script == NULL) return 2;
+    std::string dirpath = scriptPath.substr(0, scriptPath.rfind('/') + 1);
+    std::string name = scriptPath.substr(scriptPath.rfind('/') + 1);
+
+    // Same steps as createInterpreterHeap() and runScript() in interpreter.cpp
+    runStart = std::chrono::steady_clock::now();
+    jsProfilerSetEnabled(hostOptions.profile);
+    duk_context *ctx = duk_create_heap(heapAlloc, heapRealloc, heapFree, NULL, fatalHandler);
+    if (ctx == NULL) {
+        fprintf(stderr, "Could not create the heap\n");
+        return 2;
+    }
+    registerInterpreterNatives(ctx);
+    baseHeap = hostHeapUsed;
+
+    clearDisplayModuleData();
+    clearStorageModuleData();
+    clearTimersModuleData(ctx);
+    registerScriptGlobals(ctx, dirpath.c_str(), name.c_str());
+
+    jsProfilerBegin();
+    duk_int_t rc = bduk_compile_cached(ctx, &SD, scriptPath.c_str(), script, scriptLen, DUK_COMPILE_EVAL);
+    if (rc == DUK_EXEC_SUCCESS) {
+        duk_push_global_object(ctx);
+        rc = duk_pcall_method(ctx, 0);
+    }
+    if (rc == DUK_EXEC_SUCCESS && jsEventLoopPending()) {
+        duk_pop(ctx);
+        rc = runEventLoop(ctx);
+    }
+    if (rc != DUK_EXEC_SUCCESS) {
+        fprintf(stderr, "eval failed: %s\n", duk_safe_to_stacktrace(ctx, -1));
+    }
+    duk_pop(ctx);
+    fflush(stdout);
+    jsProfilerEnd();
+    printReport(rc == DUK_EXEC_SUCCESS);
+
+    clearTimersModuleData(ctx);
+    clearStorageModuleData();
+    clearDisplayModuleData();
+    duk_destroy_heap(ctx);
+    free(script);
+    return rc == DUK_EXEC_SUCCESS ? 0 : 1;
+}
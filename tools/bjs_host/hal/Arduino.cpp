@@ -0,0 +1,242 @@
+#include "Arduino.h"
+#include <chrono>
+#include <poll.h>
+#include <random>
+#include <thread>
+#include <unistd.h>
+
+HostOptions hostOptions;
+HardwareSerial Serial;
+EspClass ESP;
+
+/*********************************************************************
+**  Host clock
+**  With --no-delay, sleeping only moves the clock forward
+**********************************************************************/
+static uint64_t clockOffsetUs = 0;
+
+uint64_t hostMicros() {
+    using namespace std::chrono;
+    static auto start = steady_clock::now();
+    return duration_cast<microseconds>(steady_clock::now() - start).count() + clockOffsetUs;
+}
+
+uint64_t hostMillis() { return hostMicros() / 1000; }
+
+void hostSleep(uint32_t ms) {
+    hostPollTimeout();
+    if (hostOptions.noDelay) clockOffsetUs += (uint64_t)ms * 1000;
+    else std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+static void vtrace(const char *format, va_list args) {
+    if (!hostOptions.trace) return;
+    fputs("[hal] ", stderr);
+    vfprintf(stderr, format, args);
+    fputc('\n', stderr);
+}
+
+void hostTrace(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    vtrace(format, args);
+    va_end(args);
+}
+
+void hostLog(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    vtrace(format, args);
+    va_end(args);
+}
+
+uint32_t millis() { return hostMillis(); }
+uint32_t micros() { return hostMicros(); }
+void delay(uint32_t ms) { hostSleep(ms); }
+
+// Same seed on every run, so a failing script fails again
+static std::mt19937 randomEngine(0);
+
+long random(long max) { return max > 0 ? random(0, max) : 0; }
+long random(long min, long max) {
+    if (min >= max) return min;
+    return min + (long)(randomEngine() % (unsigned long)(max - min));
+}
+
+/*********************************************************************
+**  String
+**********************************************************************/
+String::String(long long value, unsigned char base) {
+    if (value < 0) {
+        _s = "-" + String((unsigned long long)-value, base)._s;
+        return;
+    }
+    *this = String((unsigned long long)value, base);
+}
+
+String::String(unsigned long long value, unsigned char base) {
+    static const char digits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+    if (base < 2 || base > 36) base = DEC;
+    do {
+        _s.insert(_s.begin(), digits[value % base]);
+        value /= base;
+    } while (value);
+}
+
+String::String(double value, unsigned int decimals) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", decimals, value);
+    _s = buf;
+}
+
+bool String::equalsIgnoreCase(const String &rhs) const {
+    return _s.size() == rhs._s.size() && strncasecmp(_s.c_str(), rhs._s.c_str(), _s.size()) == 0;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    if (from > to) std::swap(from, to);
+    if (from >= _s.size()) return "";
+    return _s.substr(from, to - from);
+}
+
+void String::toLowerCase() {
+    for (auto &c : _s) c = tolower((unsigned char)c);
+}
+
+void String::toUpperCase() {
+    for (auto &c : _s) c = toupper((unsigned char)c);
+}
+
+void String::trim() {
+    size_t begin = _s.find_first_not_of(" \t\r\n\f\v");
+    if (begin == std::string::npos) {
+        _s.clear();
+        return;
+    }
+    _s = _s.substr(begin, _s.find_last_not_of(" \t\r\n\f\v") - begin + 1);
+}
+
+size_t Print::printf(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+    if (len <= 0) return 0;
+    std::string buf(len + 1, '\0');
+    va_start(args, format);
+    vsnprintf(&buf[0], buf.size(), format, args);
+    va_end(args);
+    return write((const uint8_t *)buf.data(), len);
+}
+
+/*********************************************************************
+**  Serial
+**  stdout, and stdin read without blocking the script past its timeout
+**********************************************************************/
+static std::string serialInput;
+static bool serialEof = false;
+
+static void serialFill(int timeoutMs) {
+    if (serialEof) return;
+    struct pollfd fd = {STDIN_FILENO, POLLIN, 0};
+    if (poll(&fd, 1, timeoutMs) <= 0) return;
+    char buf[256];
+    ssize_t len = ::read(STDIN_FILENO, buf, sizeof(buf));
+    if (len <= 0) serialEof = true;
+    else serialInput.append(buf, len);
+}
+
+size_t HardwareSerial::write(uint8_t c) { return fwrite(&c, 1, 1, stdout); }
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size) { return fwrite(buffer, 1, size, stdout); }
+
+int HardwareSerial::available() {
+    if (serialInput.empty()) serialFill(0);
+    return serialInput.size();
+}
+
+int HardwareSerial::read() {
+    if (!available()) return -1;
+    uint8_t c = serialInput[0];
+    serialInput.erase(0, 1);
+    return c;
+}
+
+size_t HardwareSerial::readBytes(uint8_t *buffer, size_t length) {
+    size_t got = 0;
+    while (got < length) {
+        if (serialInput.empty()) serialFill(getTimeout());
+        if (serialInput.empty()) break;
+        size_t len = min(length - got, serialInput.size());
+        memcpy(buffer + got, serialInput.data(), len);
+        serialInput.erase(0, len);
+        got += len;
+    }
+    return got;
+}
+
+String HardwareSerial::readStringUntil(char terminator) {
+    String line;
+    while (true) {
+        if (serialInput.empty()) serialFill(getTimeout());
+        if (serialInput.empty()) break;
+        size_t end = serialInput.find(terminator);
+        line += String(serialInput.substr(0, end));
+        if (end != std::string::npos) {
+            serialInput.erase(0, end + 1);
+            break;
+        }
+        serialInput.clear();
+    }
+    return line;
+}
+
+void HardwareSerial::flush() { fflush(stdout); }
+
+/*********************************************************************
+**  GPIO
+**********************************************************************/
+void pinMode(uint8_t pin, uint8_t mode) { hostTrace("pinMode(%u, %u)", pin, mode); }
+void digitalWrite(uint8_t pin, uint8_t val) { hostTrace("digitalWrite(%u, %u)", pin, val); }
+void analogWrite(uint8_t pin, int value) { hostTrace("analogWrite(%u, %d)", pin, value); }
+
+int digitalRead(uint8_t pin) {
+    hostTrace("digitalRead(%u)", pin);
+    return 0;
+}
+
+int analogRead(uint8_t pin) {
+    hostTrace("analogRead(%u)", pin);
+    return 0;
+}
+
+uint16_t touchRead(uint8_t pin) {
+    hostTrace("touchRead(%u)", pin);
+    return 0;
+}
+
+uint32_t ledcSetup(uint8_t channel, uint32_t freq, uint8_t resolution_bits) {
+    hostTrace("ledcSetup(%u, %u, %u)", channel, freq, resolution_bits);
+    return freq;
+}
+
+void ledcAttachPin(uint8_t pin, uint8_t channel) { hostTrace("ledcAttachPin(%u, %u)", pin, channel); }
+void ledcWrite(uint8_t channel, uint32_t duty) { hostTrace("ledcWrite(%u, %u)", channel, duty); }
+
+/*********************************************************************
+**  Memory
+**  Without --max-heap, the peak so far stands in for the heap size
+**********************************************************************/
+static size_t heapSize() { return hostHeapLimit ? hostHeapLimit : max(hostHeapPeak, hostHeapUsed); }
+
+void heap_caps_get_info(multi_heap_info_t *info, uint32_t caps) {
+    memset(info, 0, sizeof(*info));
+    info->total_allocated_bytes = hostHeapUsed;
+    info->total_free_bytes = heapSize() - hostHeapUsed;
+    info->largest_free_block = info->total_free_bytes;
+    info->minimum_free_bytes = heapSize() - hostHeapPeak;
+}
+
+uint32_t EspClass::getHeapSize() { return heapSize(); }
+uint32_t EspClass::getFreeHeap() { return heapSize() - hostHeapUsed; }
+uint32_t EspClass::getMaxAllocHeap() { return heapSize() - hostHeapUsed; }
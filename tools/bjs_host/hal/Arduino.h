@@ -0,0 +1,234 @@
+#ifndef __BJS_HOST_ARDUINO_H__
+#define __BJS_HOST_ARDUINO_H__
+#include "host.h"
+#include <algorithm>
+#include <cmath>
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/types.h>
+
+// Subset of the ESP32 Arduino core used by the interpreter, see host.h
+
+using std::max;
+using std::min;
+
+#define DEC 10
+#define HEX 16
+
+#define LOW 0x0
+#define HIGH 0x1
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define PULLUP 0x04
+#define INPUT_PULLUP 0x05
+#define PULLDOWN 0x08
+#define INPUT_PULLDOWN 0x09
+
+class String {
+public:
+    String(const char *cstr = "") : _s(cstr ? cstr : "") {}
+    String(const std::string &s) : _s(s) {}
+    explicit String(char c) : _s(1, c) {}
+    // Like the ESP32 core, other bases than DEC print negative numbers as unsigned
+    String(int value, unsigned char base = DEC)
+        : String(base == DEC ? (long long)value : (long long)(unsigned int)value, base) {}
+    String(unsigned int value, unsigned char base = DEC) : String((unsigned long long)value, base) {}
+    String(long value, unsigned char base = DEC)
+        : String(base == DEC ? (long long)value : (long long)(unsigned long)value, base) {}
+    String(unsigned long value, unsigned char base = DEC) : String((unsigned long long)value, base) {}
+    String(long long value, unsigned char base = DEC);
+    String(unsigned long long value, unsigned char base = DEC);
+    String(double value, unsigned int decimals = 2);
+
+    const char *c_str() const { return _s.c_str(); }
+    unsigned int length() const { return _s.length(); }
+    void reserve(unsigned int size) { _s.reserve(size); }
+    char charAt(unsigned int index) const { return index < _s.length() ? _s[index] : 0; }
+    char operator[](unsigned int index) const { return charAt(index); }
+
+    String &operator+=(const String &rhs) {
+        _s += rhs._s;
+        return *this;
+    }
+    String &operator+=(const char *rhs) {
+        if (rhs) _s += rhs;
+        return *this;
+    }
+    String &operator+=(char c) {
+        _s += c;
+        return *this;
+    }
+    bool concat(const String &rhs) {
+        _s += rhs._s;
+        return true;
+    }
+
+    bool equals(const String &rhs) const { return _s == rhs._s; }
+    bool equals(const char *cstr) const { return cstr ? _s == cstr : _s.empty(); }
+    bool equalsIgnoreCase(const String &rhs) const;
+    bool operator==(const String &rhs) const { return equals(rhs); }
+    bool operator==(const char *cstr) const { return equals(cstr); }
+    bool operator!=(const String &rhs) const { return !equals(rhs); }
+    bool operator!=(const char *cstr) const { return !equals(cstr); }
+    bool operator<(const String &rhs) const { return _s < rhs._s; }
+
+    bool startsWith(const String &prefix) const { return _s.compare(0, prefix._s.size(), prefix._s) == 0; }
+    bool endsWith(const String &suffix) const {
+        return _s.size() >= suffix._s.size() &&
+               _s.compare(_s.size() - suffix._s.size(), suffix._s.size(), suffix._s) == 0;
+    }
+    int indexOf(char c, unsigned int from = 0) const { return find(_s.find(c, from)); }
+    int indexOf(const String &str, unsigned int from = 0) const { return find(_s.find(str._s, from)); }
+    int lastIndexOf(char c) const { return find(_s.rfind(c)); }
+    String substring(unsigned int from) const { return from < _s.size() ? _s.substr(from) : ""; }
+    String substring(unsigned int from, unsigned int to) const;
+
+    void remove(unsigned int index) { remove(index, (unsigned int)-1); }
+    void remove(unsigned int index, unsigned int count) {
+        if (index < _s.size()) _s.erase(index, count);
+    }
+    void toLowerCase();
+    void toUpperCase();
+    void trim();
+    long toInt() const { return atol(_s.c_str()); }
+
+private:
+    std::string _s;
+    static int find(size_t pos) { return pos == std::string::npos ? -1 : (int)pos; }
+};
+
+inline String operator+(const String &lhs, const String &rhs) {
+    String result = lhs;
+    result += rhs;
+    return result;
+}
+inline String operator+(const String &lhs, const char *rhs) {
+    String result = lhs;
+    result += rhs;
+    return result;
+}
+inline String operator+(const char *lhs, const String &rhs) {
+    String result = lhs;
+    result += rhs;
+    return result;
+}
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size) {
+        for (size_t i = 0; i < size; i++) write(buffer[i]);
+        return size;
+    }
+    size_t write(const char *str) { return write((const uint8_t *)str, strlen(str)); }
+
+    size_t printf(const char *format, ...);
+    size_t print(const String &s) { return write(s.c_str()); }
+    size_t print(const char *str) { return write(str); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int n, int base = DEC) { return print(String(n, base)); }
+    size_t print(unsigned int n, int base = DEC) { return print(String(n, base)); }
+    size_t print(long n, int base = DEC) { return print(String(n, base)); }
+    size_t print(unsigned long n, int base = DEC) { return print(String(n, base)); }
+    size_t print(double n, int digits = 2) { return print(String(n, digits)); }
+    size_t println() { return write("\r\n"); }
+    template <typename T> size_t println(const T &value) { return print(value) + println(); }
+    template <typename T> size_t println(const T &value, int format) {
+        return print(value, format) + println();
+    }
+};
+
+// stdout, and stdin for reading
+class HardwareSerial : public Print {
+public:
+    using Print::write;
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    int available();
+    int read();
+    size_t readBytes(uint8_t *buffer, size_t length);
+    String readStringUntil(char terminator);
+    void flush();
+    unsigned long getTimeout() { return 1000; }
+};
+extern HardwareSerial Serial;
+
+// 32 bits like on the ESP32, the timers rely on the wrap-around
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+
+long random(long max);
+long random(long min, long max);
+
+// GPIO: traced, reads return 0
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+uint16_t touchRead(uint8_t pin);
+uint32_t ledcSetup(uint8_t channel, uint32_t freq, uint8_t resolution_bits);
+void ledcAttachPin(uint8_t pin, uint8_t channel);
+void ledcWrite(uint8_t channel, uint32_t duty);
+
+// Memory: no PSRAM, the internal RAM is the Duktape heap seen by the allocator in bjs_host.cpp
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+struct multi_heap_info_t {
+    size_t total_free_bytes;
+    size_t total_allocated_bytes;
+    size_t largest_free_block;
+    size_t minimum_free_bytes;
+    size_t allocated_blocks;
+    size_t free_blocks;
+    size_t total_blocks;
+};
+void heap_caps_get_info(multi_heap_info_t *info, uint32_t caps);
+
+inline bool psramFound() { return false; }
+inline void *ps_malloc(size_t size) { return malloc(size); }
+inline void *ps_realloc(void *ptr, size_t size) { return realloc(ptr, size); }
+
+class EspClass {
+public:
+    uint32_t getHeapSize();
+    uint32_t getFreeHeap();
+    uint32_t getMaxAllocHeap();
+    uint32_t getPsramSize() { return 0; }
+    uint32_t getFreePsram() { return 0; }
+    uint32_t getMaxAllocPsram() { return 0; }
+};
+extern EspClass ESP;
+
+#define log_e(format, ...) hostLog("[E] " format, ##__VA_ARGS__)
+#define log_w(format, ...) hostLog("[W] " format, ##__VA_ARGS__)
+#define log_i(format, ...) hostLog("[I] " format, ##__VA_ARGS__)
+#define log_d(format, ...) hostLog("[D] " format, ##__VA_ARGS__)
+
+// FreeRTOS: single task, the interpreter task functions are built but never started
+typedef void *TaskHandle_t;
+typedef int BaseType_t;
+typedef uint32_t TickType_t;
+#define pdPASS 1
+#define pdTRUE 1
+#define portMAX_DELAY 0xffffffffUL
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+inline void vTaskDelay(TickType_t ticks) { delay(ticks); }
+inline TaskHandle_t xTaskGetCurrentTaskHandle() { return NULL; }
+inline BaseType_t xTaskCreate(
+    void (*task)(void *), const char *name, uint32_t stack, void *param, int priority, TaskHandle_t *handle
+) {
+    return 0;
+}
+inline void vTaskDelete(TaskHandle_t task) {}
+inline void xTaskNotifyGive(TaskHandle_t task) {}
+inline uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks) { return 0; }
+
+#endif
@@ -0,0 +1,225 @@
+#include "FS.h"
+#include <algorithm>
+#include <dirent.h>
+#include <filesystem>
+#include <set>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+fs::FS SD;
+fs::FS LittleFS;
+
+/*********************************************************************
+**  Write overlay
+**  --root is only read: files the script writes go to the --writes
+**  folder, which is read first. Removed paths are only hidden.
+**********************************************************************/
+static std::set<std::string> removedPaths;
+
+static std::string under(const std::string &dir, const std::string &path) {
+    return path[0] == '/' ? dir + path : dir + "/" + path;
+}
+
+// The path or one of its folders was removed by the script
+static bool isRemoved(const std::string &path) {
+    for (size_t slash = path.find('/', 1); slash != std::string::npos; slash = path.find('/', slash + 1)) {
+        if (removedPaths.count(path.substr(0, slash))) return true;
+    }
+    return removedPaths.count(path) > 0;
+}
+
+std::string hostPath(const char *path) {
+    struct stat st;
+    std::string written = under(hostOptions.writes, path);
+    if (stat(written.c_str(), &st) == 0) return written;
+    return isRemoved(path) ? "" : under(hostOptions.root, path);
+}
+
+static bool hostStat(const std::string &path, struct stat *st) {
+    std::string full = hostPath(path.c_str());
+    return !full.empty() && stat(full.c_str(), st) == 0;
+}
+
+static bool isFolder(const std::string &path) {
+    struct stat st;
+    return path.empty() || path == "/" || (hostStat(path, &st) && S_ISDIR(st.st_mode));
+}
+
+// Folders of the path created in the overlay, they may only exist under --root
+static void makeParents(const std::string &path) {
+    for (size_t slash = path.find('/', 1); slash != std::string::npos; slash = path.find('/', slash + 1)) {
+        ::mkdir(under(hostOptions.writes, path.substr(0, slash)).c_str(), 0755);
+    }
+}
+
+// Where a write to path goes, with the current content brought over when it is kept
+static std::string writePath(const std::string &path, bool keepContent) {
+    std::string written = under(hostOptions.writes, path);
+    std::string current = hostPath(path.c_str());
+    makeParents(path);
+    if (keepContent && !current.empty() && current != written) {
+        std::error_code ec;
+        std::filesystem::copy_file(current, written, std::filesystem::copy_options::overwrite_existing, ec);
+    }
+    removedPaths.erase(path);
+    return written;
+}
+
+static void listFolder(const std::string &dir, std::vector<std::string> &names) {
+    DIR *d = opendir(dir.c_str());
+    if (!d) return;
+    struct dirent *entry;
+    while ((entry = readdir(d)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+        if (std::find(names.begin(), names.end(), entry->d_name) != names.end()) continue;
+        names.push_back(entry->d_name);
+    }
+    closedir(d);
+}
+
+namespace fs {
+
+struct FileImpl {
+    std::string path; // as seen by the script, from the root
+    FILE *file = NULL;
+    bool dir = false;
+    std::vector<std::string> names; // folder entries of --root and of the overlay
+    size_t next = 0;
+
+    ~FileImpl() { close(); }
+    void close() {
+        if (file) fclose(file);
+        file = NULL;
+        dir = false;
+    }
+};
+
+File::operator bool() const { return _p && (_p->file || _p->dir); }
+
+size_t File::write(const uint8_t *buf, size_t size) {
+    return _p && _p->file ? fwrite(buf, 1, size, _p->file) : 0;
+}
+
+int File::read() {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+size_t File::read(uint8_t *buf, size_t size) { return _p && _p->file ? fread(buf, 1, size, _p->file) : 0; }
+
+int File::available() { return _p && _p->file ? size() - position() : 0; }
+
+String File::readStringUntil(char terminator) {
+    std::string line;
+    int c;
+    while ((c = read()) >= 0 && c != terminator) line += (char)c;
+    return line;
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+    static const int whence[] = {SEEK_SET, SEEK_CUR, SEEK_END};
+    return _p && _p->file && fseek(_p->file, pos, whence[mode]) == 0;
+}
+
+size_t File::position() const { return _p && _p->file ? ftell(_p->file) : 0; }
+
+size_t File::size() const {
+    if (!_p || !_p->file) return 0;
+    fflush(_p->file);
+    struct stat st;
+    return fstat(fileno(_p->file), &st) == 0 ? st.st_size : 0;
+}
+
+void File::close() {
+    if (_p) _p->close();
+}
+
+const char *File::name() const {
+    if (!_p) return NULL;
+    size_t slash = _p->path.rfind('/');
+    return _p->path.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+}
+
+const char *File::path() const { return _p ? _p->path.c_str() : NULL; }
+
+bool File::isDirectory() const { return _p && _p->dir; }
+
+File File::openNextFile(const char *mode) {
+    if (!_p || !_p->dir) return File();
+    std::string folder = _p->path == "/" ? "" : _p->path;
+    while (_p->next < _p->names.size()) {
+        std::string path = folder + "/" + _p->names[_p->next++];
+        if (!isRemoved(path)) return SD.open(String(path), mode);
+    }
+    return File();
+}
+
+time_t File::getLastWrite() {
+    struct stat st;
+    return _p && hostStat(_p->path, &st) ? st.st_mtime : 0;
+}
+
+File FS::open(const String &path, const char *mode, const bool create) {
+    auto impl = std::make_shared<FileImpl>();
+    impl->path = path.c_str();
+    if (impl->path.empty() || impl->path[0] != '/') impl->path = "/" + impl->path;
+
+    if (isFolder(impl->path)) {
+        impl->dir = true;
+        if (!isRemoved(impl->path)) listFolder(under(hostOptions.root, impl->path), impl->names);
+        listFolder(under(hostOptions.writes, impl->path), impl->names);
+    } else if (mode[0] == 'r' && mode[1] != '+') {
+        std::string full = hostPath(impl->path.c_str());
+        if (!full.empty()) impl->file = fopen(full.c_str(), mode);
+    } else if (create || isFolder(impl->path.substr(0, impl->path.rfind('/')))) {
+        // "w" starts empty, "a" and "r+" keep the content
+        impl->file = fopen(writePath(impl->path, mode[0] != 'w').c_str(), mode);
+    }
+    bool opened = impl->file || impl->dir;
+    hostTrace("fs.open(\"%s\", \"%s\")%s", impl->path.c_str(), mode, opened ? "" : " failed");
+    return File(impl);
+}
+
+bool FS::exists(const String &path) {
+    struct stat st;
+    return hostStat(path.c_str(), &st);
+}
+
+bool FS::remove(const String &path) {
+    if (!exists(path) || isFolder(path.c_str())) return false;
+    ::remove(under(hostOptions.writes, path.c_str()).c_str());
+    removedPaths.insert(path.c_str());
+    return true;
+}
+
+bool FS::rename(const String &pathFrom, const String &pathTo) {
+    std::string from = pathFrom.c_str();
+    if (!exists(pathFrom) || exists(pathTo)) return false;
+    // Copied: the --root side of a folder stays where it is
+    using std::filesystem::copy_options;
+    auto options = copy_options::recursive | copy_options::overwrite_existing;
+    std::error_code ec;
+    std::string to = writePath(pathTo.c_str(), false);
+    if (!isRemoved(from)) std::filesystem::copy(under(hostOptions.root, from), to, options, ec);
+    std::filesystem::copy(under(hostOptions.writes, from), to, options, ec);
+    std::filesystem::remove_all(under(hostOptions.writes, from), ec);
+    removedPaths.insert(from);
+    return true;
+}
+
+bool FS::mkdir(const String &path) {
+    std::string folder = path.c_str();
+    if (exists(path) || !isFolder(folder.substr(0, folder.rfind('/')))) return false;
+    return ::mkdir(writePath(folder, false).c_str(), 0755) == 0;
+}
+
+bool FS::rmdir(const String &path) {
+    File dir = open(path);
+    if (!dir.isDirectory() || dir.openNextFile()) return false;
+    ::rmdir(under(hostOptions.writes, path.c_str()).c_str());
+    removedPaths.insert(path.c_str());
+    return true;
+}
+
+} // namespace fs
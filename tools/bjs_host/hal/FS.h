@@ -0,0 +1,60 @@
+#ifndef __BJS_HOST_FS_H__
+#define __BJS_HOST_FS_H__
+#include "Arduino.h"
+#include <memory>
+
+// fs::FS over the host file system, every instance uses the --root directory
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+namespace fs {
+
+struct FileImpl;
+
+// Copies share the open file, like the FileImplPtr of the ESP32 core
+class File {
+public:
+    File() {}
+    explicit File(std::shared_ptr<FileImpl> impl) : _p(impl) {}
+
+    operator bool() const;
+    size_t write(const uint8_t *buf, size_t size);
+    size_t write(uint8_t c) { return write(&c, 1); }
+    int read();
+    size_t read(uint8_t *buf, size_t size);
+    int available();
+    String readStringUntil(char terminator);
+    bool seek(uint32_t pos, SeekMode mode = SeekSet);
+    size_t position() const;
+    size_t size() const;
+    void close();
+    const char *name() const;
+    const char *path() const;
+    bool isDirectory() const;
+    File openNextFile(const char *mode = FILE_READ);
+    time_t getLastWrite();
+
+private:
+    std::shared_ptr<FileImpl> _p;
+};
+
+class FS {
+public:
+    File open(const String &path, const char *mode = FILE_READ, const bool create = false);
+    bool exists(const String &path);
+    bool remove(const String &path);
+    bool rename(const String &pathFrom, const String &pathTo);
+    bool mkdir(const String &path);
+    bool rmdir(const String &path);
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
+
+#endif
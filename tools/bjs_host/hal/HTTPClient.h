@@ -0,0 +1,31 @@
+#ifndef __BJS_HOST_HTTPCLIENT_H__
+#define __BJS_HOST_HTTPCLIENT_H__
+#include "WiFi.h"
+
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+
+// Requests fail with HTTPC_ERROR_CONNECTION_REFUSED, only reached if a script skips the WiFi check
+class HTTPClient {
+public:
+    void setReuse(bool reuse) {}
+    bool begin(const String &url);
+    void addHeader(const String &name, const String &value) {}
+    void collectHeaders(const char *headerKeys[], const size_t headerKeysCount) {}
+    int sendRequest(const char *type, uint8_t *payload = NULL, size_t size = 0) {
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+    static String errorToString(int error) { return "connection refused"; }
+    WiFiClient *getStreamPtr() { return &_client; }
+    int getSize() { return -1; }
+    String header(const char *name) { return ""; }
+    String header(size_t i) { return ""; }
+    String headerName(size_t i) { return ""; }
+    int headers() { return 0; }
+    bool connected() { return false; }
+    void end() {}
+
+private:
+    WiFiClient _client;
+};
+
+#endif
@@ -0,0 +1,7 @@
+#ifndef __BJS_HOST_LITTLEFS_H__
+#define __BJS_HOST_LITTLEFS_H__
+#include "FS.h"
+
+extern fs::FS LittleFS;
+
+#endif
@@ -0,0 +1,7 @@
+#ifndef __BJS_HOST_SD_H__
+#define __BJS_HOST_SD_H__
+#include "FS.h"
+
+extern fs::FS SD;
+
+#endif
@@ -0,0 +1,4 @@
+#ifndef __BJS_HOST_SPI_H__
+#define __BJS_HOST_SPI_H__
+// Nothing is used from it, included by interpreter.h
+#endif
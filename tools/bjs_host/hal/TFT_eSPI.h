@@ -0,0 +1,91 @@
+#ifndef __BJS_HOST_TFT_ESPI_H__
+#define __BJS_HOST_TFT_ESPI_H__
+#include "Arduino.h"
+
+// Screen and sprites drawing nothing, each call is traced with --trace
+
+#define TFT_BLACK 0x0000
+#define TFT_BLUE 0x001F
+#define TFT_RED 0xF800
+#define TFT_GREEN 0x07E0
+#define TFT_YELLOW 0xFFE0
+#define TFT_WHITE 0xFFFF
+
+class TFT_eSPI : public Print {
+public:
+    TFT_eSPI(const char *name = "tft") : _name(name) {}
+    virtual ~TFT_eSPI() {}
+
+    using Print::write;
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t *buffer, size_t size) override;
+
+    virtual int16_t width();
+    virtual int16_t height();
+    void setRotation(uint8_t rotation);
+    void startWrite();
+    void endWrite();
+
+    void fillScreen(uint32_t color);
+    void drawPixel(int32_t x, int32_t y, uint32_t color);
+    void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color);
+    void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color);
+    void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color);
+    void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+    void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+    void fillRectHGradient(int16_t x, int16_t y, int16_t w, int16_t h, uint32_t color1, uint32_t color2);
+    void fillRectVGradient(int16_t x, int16_t y, int16_t w, int16_t h, uint32_t color1, uint32_t color2);
+    void drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t radius, uint32_t color);
+    void fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t radius, uint32_t color);
+    void drawCircle(int32_t x, int32_t y, int32_t r, uint32_t color);
+    void fillCircle(int32_t x, int32_t y, int32_t r, uint32_t color);
+    void drawXBitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t fgcolor);
+    void drawXBitmap(
+        int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t fgcolor, uint16_t bgcolor
+    );
+    void pushImage(
+        int32_t x, int32_t y, int32_t w, int32_t h, uint8_t *data, bool bpp8 = true, uint16_t *cmap = nullptr
+    );
+
+    void setCursor(int16_t x, int16_t y);
+    int16_t getCursorX() { return _cursorX; }
+    int16_t getCursorY() { return _cursorY; }
+    void setTextSize(uint8_t size);
+    void setTextColor(uint16_t color);
+    void setTextColor(uint16_t fgcolor, uint16_t bgcolor, bool bgfill = false);
+    void setTextDatum(uint8_t datum);
+    int16_t drawString(const String &string, int32_t x, int32_t y);
+    int16_t drawString(const char *string, int32_t x, int32_t y);
+    int16_t drawCentreString(const String &string, int32_t x, int32_t y, uint8_t font);
+
+protected:
+    const char *_name;
+    int16_t _cursorX = 0;
+    int16_t _cursorY = 0;
+    uint8_t _textSize = 1;
+};
+
+class TFT_eSprite : public TFT_eSPI {
+public:
+    explicit TFT_eSprite(TFT_eSPI *tft) : TFT_eSPI("sprite") {}
+    ~TFT_eSprite() override;
+
+    int16_t width() override { return _width; }
+    int16_t height() override { return _height; }
+    void setColorDepth(int8_t bpp);
+    void *createSprite(int16_t width, int16_t height, uint8_t frames = 1);
+    void deleteSprite();
+    void fillSprite(uint32_t color);
+    void pushSprite(int32_t x, int32_t y);
+    void pushSprite(int32_t x, int32_t y, uint16_t transparent);
+    bool pushToSprite(TFT_eSprite *dspr, int32_t x, int32_t y);
+    bool pushToSprite(TFT_eSprite *dspr, int32_t x, int32_t y, uint16_t transparent);
+
+private:
+    int16_t _width = 0;
+    int16_t _height = 0;
+    uint8_t _bpp = 16;
+    void *_buffer = nullptr; // allocated like on the device, so the sprite counts in the host memory
+};
+
+#endif
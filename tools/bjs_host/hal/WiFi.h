@@ -0,0 +1,37 @@
+#ifndef __BJS_HOST_WIFI_H__
+#define __BJS_HOST_WIFI_H__
+#include "Arduino.h"
+
+// No network on the host: the radio never connects and scans find nothing
+
+typedef enum { WIFI_MODE_NULL = 0, WIFI_MODE_STA, WIFI_MODE_AP, WIFI_MODE_APSTA } wifi_mode_t;
+typedef enum { WL_IDLE_STATUS = 0, WL_NO_SSID_AVAIL = 1, WL_CONNECTED = 3, WL_DISCONNECTED = 6 } wl_status_t;
+
+class IPAddress {
+public:
+    String toString() const { return "0.0.0.0"; }
+};
+
+class WiFiClass {
+public:
+    bool mode(wifi_mode_t mode);
+    wl_status_t begin(const String &ssid, const String &passphrase = "");
+    wl_status_t status() { return WL_DISCONNECTED; }
+    IPAddress localIP() { return IPAddress(); }
+    int16_t scanNetworks();
+    int encryptionType(uint8_t i) { return 0; }
+    String SSID(uint8_t i) { return ""; }
+    String BSSIDstr(uint8_t i) { return ""; }
+};
+extern WiFiClass WiFi;
+
+class WiFiClient {
+public:
+    int available() { return 0; }
+    int read() { return -1; }
+    size_t readBytes(char *buffer, size_t length) { return 0; }
+    size_t readBytes(uint8_t *buffer, size_t length) { return 0; }
+    String readStringUntil(char terminator) { return ""; }
+};
+
+#endif
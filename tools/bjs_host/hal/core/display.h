@@ -0,0 +1,54 @@
+#ifndef __DISPLAY_H__
+#define __DISPLAY_H__
+#include "core/sd_functions.h"
+#include "core/serialcmds.h"
+#include <globals.h>
+
+// Screen UI of the firmware: traced, dialogs return as if dismissed
+
+#define BORDER_PAD_X 10
+#define BORDER_PAD_Y 28
+#define MENU_TYPE_MAIN 0
+#define MENU_TYPE_SUBMENU 1
+#define MENU_TYPE_REGULAR 2
+
+// No GIF decoder on the host, openGIF() fails
+class Gif {
+public:
+    bool openGIF(FS *fs, const char *filename);
+    int playFrame(int x = 0, int y = 0, bool bSync = true) { return 0; }
+    void reset() {}
+    void close() {}
+    int getCanvasWidth() { return 0; }
+    int getCanvasHeight() { return 0; }
+};
+
+bool drawImg(FS &fs, String filename, int x = 0, int y = 0, bool center = false, int playDurationMs = 0);
+bool showGif(FS *fs, const char *filename, int x = 0, int y = 0, bool center = false, int playDurationMs = 0);
+bool showJpeg(FS &fs, String filename, int x = 0, int y = 0, bool center = false);
+
+int8_t displayMessage(
+    const char *message, const char *leftButton, const char *centerButton, const char *rightButton,
+    uint16_t color
+);
+void displayError(String txt, bool waitKeyPress = false);
+void displayWarning(String txt, bool waitKeyPress = false);
+void displayInfo(String txt, bool waitKeyPress = false);
+void displaySuccess(String txt, bool waitKeyPress = false);
+
+// Returns index without running an option, like Esc on the device
+int loopOptions(
+    std::vector<Option> &options, uint8_t menuType, const char *subText, int index = 0,
+    bool interpreter = false
+);
+inline int loopOptions(std::vector<Option> &options, int _index) {
+    return loopOptions(options, MENU_TYPE_REGULAR, "", _index, false);
+}
+inline int loopOptions(std::vector<Option> &options) {
+    return loopOptions(options, MENU_TYPE_REGULAR, "", 0, false);
+}
+
+void drawStatusBar();
+int getBattery();
+
+#endif
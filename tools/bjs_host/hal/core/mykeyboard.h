@@ -0,0 +1,8 @@
+#ifndef __MYKEYBOARD_H__
+#define __MYKEYBOARD_H__
+#include <globals.h>
+
+// Returns mytext, as if confirmed without typing
+String keyboard(String mytext, int maxSize = 76, String msg = "Type your message:");
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef __SCROLLABLE_TEXT_AREA_H__
+#define __SCROLLABLE_TEXT_AREA_H__
+#include "display.h"
+
+// Keeps the lines like the firmware, drawing is traced
+class ScrollableTextArea {
+public:
+    ScrollableTextArea(
+        uint8_t fontSize, int16_t startX, int16_t startY, int32_t width, int32_t height,
+        bool drawBorders = true, bool indentWrappedLines = false
+    );
+
+    void scrollUp();
+    void scrollDown();
+    void scrollToLine(size_t lineNumber);
+    String getLine(size_t lineNumber);
+    size_t getMaxLines();
+    void addLine(const String &text);
+    void clear();
+    void fromString(const String &text);
+    void draw(bool force = false);
+    void show(bool force = false);
+    uint32_t getMaxVisibleTextLength();
+
+    size_t firstVisibleLine = 0;
+    size_t lastVisibleLine = 0;
+    std::vector<String> linesBuffer;
+
+private:
+    uint8_t _fontSize;
+    int32_t _width, _height;
+    bool _indentWrappedLines;
+    size_t _maxCharactersPerLine;
+    size_t _maxVisibleLines;
+};
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef __SD_FUNCTIONS_H__
+#define __SD_FUNCTIONS_H__
+#include <globals.h>
+
+bool setupSdCard();
+
+// No file index or icon cache on the host
+inline void fileChanged(FS &fs, const String &path, bool removed = false) {}
+
+char *readBigFile(FS &fs, String filepath, bool binary = false, size_t *fileSize = NULL);
+
+enum FileHashType { HASH_MD5, HASH_CRC32, HASH_SHA256 };
+
+// Only CRC32 on the host, the other types return ""
+String hashFile(
+    FS &fs, String filepath, FileHashType type, void (*progress)(size_t done, size_t total) = NULL
+);
+
+// The file browser returns "" like Esc on the device
+String loopSD(FS &fs, bool filePicker = false, String allowed_ext = "*", String rootPath = "/");
+void viewFile(FS fs, String filepath);
+
+#endif
@@ -0,0 +1,5 @@
+#ifndef __SERIALCMDS_H__
+#define __SERIALCMDS_H__
+#include <globals.h>
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef __WIFI_COMMON_H__
+#define __WIFI_COMMON_H__
+#include <WiFi.h>
+#include <globals.h>
+
+// No network on the host: the menu fails and the radio stays off
+bool wifiConnectMenu(wifi_mode_t = WIFI_MODE_STA);
+void wifiDisconnect();
+
+#endif
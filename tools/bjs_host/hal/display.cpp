@@ -0,0 +1,314 @@
+#include "core/display.h"
+#include "core/scrollableTextArea.h"
+
+tft_logger tft;
+volatile int tftWidth = 240;
+volatile int tftHeight = 135;
+
+/*********************************************************************
+**  TFT_eSPI
+**  Nothing is drawn, the calls are traced with --trace
+**********************************************************************/
+size_t TFT_eSPI::write(const uint8_t *buffer, size_t size) {
+    hostTrace("%s.print(\"%.*s\")", _name, (int)size, (const char *)buffer);
+    for (size_t i = 0; i < size; i++) {
+        if (buffer[i] == '\n') {
+            _cursorX = 0;
+            _cursorY += 8 * _textSize;
+        } else if (buffer[i] != '\r') {
+            _cursorX += 6 * _textSize;
+        }
+    }
+    return size;
+}
+
+int16_t TFT_eSPI::width() { return hostOptions.width; }
+int16_t TFT_eSPI::height() { return hostOptions.height; }
+
+void TFT_eSPI::setRotation(uint8_t rotation) { hostTrace("%s.setRotation(%u)", _name, rotation); }
+void TFT_eSPI::startWrite() {}
+void TFT_eSPI::endWrite() {}
+
+void TFT_eSPI::fillScreen(uint32_t color) { hostTrace("%s.fillScreen(0x%04x)", _name, color); }
+
+void TFT_eSPI::drawPixel(int32_t x, int32_t y, uint32_t color) {
+    hostTrace("%s.drawPixel(%d, %d, 0x%04x)", _name, x, y, color);
+}
+
+void TFT_eSPI::drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color) {
+    hostTrace("%s.drawLine(%d, %d, %d, %d, 0x%04x)", _name, x0, y0, x1, y1, color);
+}
+
+void TFT_eSPI::drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) {
+    hostTrace("%s.drawFastHLine(%d, %d, %d, 0x%04x)", _name, x, y, w, color);
+}
+
+void TFT_eSPI::drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color) {
+    hostTrace("%s.drawFastVLine(%d, %d, %d, 0x%04x)", _name, x, y, h, color);
+}
+
+void TFT_eSPI::drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+    hostTrace("%s.drawRect(%d, %d, %d, %d, 0x%04x)", _name, x, y, w, h, color);
+}
+
+void TFT_eSPI::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+    hostTrace("%s.fillRect(%d, %d, %d, %d, 0x%04x)", _name, x, y, w, h, color);
+}
+
+void TFT_eSPI::fillRectHGradient(
+    int16_t x, int16_t y, int16_t w, int16_t h, uint32_t color1, uint32_t color2
+) {
+    hostTrace("%s.fillRectHGradient(%d, %d, %d, %d, 0x%04x, 0x%04x)", _name, x, y, w, h, color1, color2);
+}
+
+void TFT_eSPI::fillRectVGradient(
+    int16_t x, int16_t y, int16_t w, int16_t h, uint32_t color1, uint32_t color2
+) {
+    hostTrace("%s.fillRectVGradient(%d, %d, %d, %d, 0x%04x, 0x%04x)", _name, x, y, w, h, color1, color2);
+}
+
+void TFT_eSPI::drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t radius, uint32_t color) {
+    hostTrace("%s.drawRoundRect(%d, %d, %d, %d, %d, 0x%04x)", _name, x, y, w, h, radius, color);
+}
+
+void TFT_eSPI::fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t radius, uint32_t color) {
+    hostTrace("%s.fillRoundRect(%d, %d, %d, %d, %d, 0x%04x)", _name, x, y, w, h, radius, color);
+}
+
+void TFT_eSPI::drawCircle(int32_t x, int32_t y, int32_t r, uint32_t color) {
+    hostTrace("%s.drawCircle(%d, %d, %d, 0x%04x)", _name, x, y, r, color);
+}
+
+void TFT_eSPI::fillCircle(int32_t x, int32_t y, int32_t r, uint32_t color) {
+    hostTrace("%s.fillCircle(%d, %d, %d, 0x%04x)", _name, x, y, r, color);
+}
+
+void TFT_eSPI::drawXBitmap(
+    int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t fgcolor
+) {
+    hostTrace("%s.drawXBitmap(%d, %d, %dx%d, 0x%04x)", _name, x, y, w, h, fgcolor);
+}
+
+void TFT_eSPI::drawXBitmap(
+    int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t fgcolor, uint16_t bgcolor
+) {
+    hostTrace("%s.drawXBitmap(%d, %d, %dx%d, 0x%04x, 0x%04x)", _name, x, y, w, h, fgcolor, bgcolor);
+}
+
+void TFT_eSPI::pushImage(
+    int32_t x, int32_t y, int32_t w, int32_t h, uint8_t *data, bool bpp8, uint16_t *cmap
+) {
+    hostTrace("%s.pushImage(%d, %d, %dx%d, %s)", _name, x, y, w, h, bpp8 ? "8 bpp" : "palette");
+}
+
+void TFT_eSPI::setCursor(int16_t x, int16_t y) {
+    _cursorX = x;
+    _cursorY = y;
+}
+
+void TFT_eSPI::setTextSize(uint8_t size) { _textSize = size ? size : 1; }
+void TFT_eSPI::setTextColor(uint16_t color) {}
+void TFT_eSPI::setTextColor(uint16_t fgcolor, uint16_t bgcolor, bool bgfill) {}
+void TFT_eSPI::setTextDatum(uint8_t datum) {}
+
+int16_t TFT_eSPI::drawString(const String &string, int32_t x, int32_t y) {
+    return drawString(string.c_str(), x, y);
+}
+
+int16_t TFT_eSPI::drawString(const char *string, int32_t x, int32_t y) {
+    hostTrace("%s.drawString(\"%s\", %d, %d)", _name, string, x, y);
+    return strlen(string) * 6 * _textSize;
+}
+
+int16_t TFT_eSPI::drawCentreString(const String &string, int32_t x, int32_t y, uint8_t font) {
+    hostTrace("%s.drawCentreString(\"%s\", %d, %d)", _name, string.c_str(), x, y);
+    return string.length() * 6 * _textSize;
+}
+
+void tft_logger::beginFrame(const char *name) { hostTrace("tft.beginFrame(\"%s\")", name); }
+void tft_logger::endFrame() { hostTrace("tft.endFrame()"); }
+
+/*********************************************************************
+**  TFT_eSprite
+**********************************************************************/
+TFT_eSprite::~TFT_eSprite() { deleteSprite(); }
+
+void TFT_eSprite::setColorDepth(int8_t bpp) { _bpp = bpp; }
+
+void *TFT_eSprite::createSprite(int16_t width, int16_t height, uint8_t frames) {
+    deleteSprite();
+    _buffer = calloc((size_t)width * height * frames, max<int>(_bpp / 8, 1));
+    if (_buffer) {
+        _width = width;
+        _height = height;
+    }
+    hostTrace("sprite.createSprite(%d, %d, %u)%s", width, height, frames, _buffer ? "" : " failed");
+    return _buffer;
+}
+
+void TFT_eSprite::deleteSprite() {
+    free(_buffer);
+    _buffer = nullptr;
+    _width = 0;
+    _height = 0;
+}
+
+void TFT_eSprite::fillSprite(uint32_t color) { hostTrace("sprite.fillSprite(0x%04x)", color); }
+
+void TFT_eSprite::pushSprite(int32_t x, int32_t y) { hostTrace("sprite.pushSprite(%d, %d)", x, y); }
+
+void TFT_eSprite::pushSprite(int32_t x, int32_t y, uint16_t transparent) {
+    hostTrace("sprite.pushSprite(%d, %d, 0x%04x)", x, y, transparent);
+}
+
+bool TFT_eSprite::pushToSprite(TFT_eSprite *dspr, int32_t x, int32_t y) {
+    hostTrace("sprite.pushToSprite(%d, %d)", x, y);
+    return _buffer != nullptr;
+}
+
+bool TFT_eSprite::pushToSprite(TFT_eSprite *dspr, int32_t x, int32_t y, uint16_t transparent) {
+    hostTrace("sprite.pushToSprite(%d, %d, 0x%04x)", x, y, transparent);
+    return _buffer != nullptr;
+}
+
+/*********************************************************************
+**  Bruce UI
+**********************************************************************/
+bool Gif::openGIF(FS *fs, const char *filename) {
+    hostTrace("gif.openGIF(\"%s\") not supported", filename);
+    return false;
+}
+
+bool drawImg(FS &fs, String filename, int x, int y, bool center, int playDurationMs) {
+    hostTrace("drawImg(\"%s\", %d, %d)", filename.c_str(), x, y);
+    return fs.exists(filename);
+}
+
+bool showGif(FS *fs, const char *filename, int x, int y, bool center, int playDurationMs) {
+    hostTrace("showGif(\"%s\", %d, %d)", filename, x, y);
+    return fs->exists(filename);
+}
+
+bool showJpeg(FS &fs, String filename, int x, int y, bool center) {
+    hostTrace("showJpeg(\"%s\", %d, %d)", filename.c_str(), x, y);
+    return fs.exists(filename);
+}
+
+int8_t displayMessage(
+    const char *message, const char *leftButton, const char *centerButton, const char *rightButton,
+    uint16_t color
+) {
+    hostTrace("displayMessage(\"%s\"), first button selected", message);
+    return 0;
+}
+
+void displayError(String txt, bool waitKeyPress) { hostTrace("displayError(\"%s\")", txt.c_str()); }
+void displayWarning(String txt, bool waitKeyPress) { hostTrace("displayWarning(\"%s\")", txt.c_str()); }
+void displayInfo(String txt, bool waitKeyPress) { hostTrace("displayInfo(\"%s\")", txt.c_str()); }
+void displaySuccess(String txt, bool waitKeyPress) { hostTrace("displaySuccess(\"%s\")", txt.c_str()); }
+
+int loopOptions(
+    std::vector<Option> &options, uint8_t menuType, const char *subText, int index, bool interpreter
+) {
+    hostTrace("loopOptions(%zu options), closed", options.size());
+    return index;
+}
+
+void drawStatusBar() { hostTrace("drawStatusBar()"); }
+
+int getBattery() { return 100; }
+
+/*********************************************************************
+**  ScrollableTextArea
+**  Same line wrapping as the firmware, with the 6x8 pixels font
+**********************************************************************/
+ScrollableTextArea::ScrollableTextArea(
+    uint8_t fontSize, int16_t startX, int16_t startY, int32_t width, int32_t height, bool drawBorders,
+    bool indentWrappedLines
+)
+    : _fontSize(fontSize ? fontSize : 1), _width(width), _height(height),
+      _indentWrappedLines(indentWrappedLines) {
+    _maxCharactersPerLine = max<int32_t>(_width / (6 * _fontSize), 1);
+    _maxVisibleLines = _height / (8 * _fontSize + 2);
+}
+
+void ScrollableTextArea::scrollUp() {
+    if (firstVisibleLine) firstVisibleLine--;
+}
+
+void ScrollableTextArea::scrollDown() {
+    if (firstVisibleLine + _maxVisibleLines <= linesBuffer.size()) {
+        if (firstVisibleLine == 0) firstVisibleLine++;
+        firstVisibleLine++;
+    }
+}
+
+void ScrollableTextArea::scrollToLine(size_t lineNumber) {
+    size_t rows = linesBuffer.size();
+    if (rows == 0) return;
+    if (lineNumber > rows - _maxVisibleLines) {
+        firstVisibleLine = (rows > _maxVisibleLines) ? rows - _maxVisibleLines : 0;
+    } else {
+        firstVisibleLine = lineNumber;
+    }
+}
+
+String ScrollableTextArea::getLine(size_t lineNumber) {
+    return lineNumber < linesBuffer.size() ? linesBuffer[lineNumber] : "";
+}
+
+size_t ScrollableTextArea::getMaxLines() { return linesBuffer.size(); }
+
+uint32_t ScrollableTextArea::getMaxVisibleTextLength() { return _maxVisibleLines * _maxCharactersPerLine; }
+
+void ScrollableTextArea::clear() {
+    firstVisibleLine = 0;
+    linesBuffer.clear();
+}
+
+void ScrollableTextArea::fromString(const String &text) {
+    clear();
+    int startIdx = 0;
+    for (int endIdx = 0; endIdx < (int)text.length(); endIdx++) {
+        if (text[endIdx] != '\n') continue;
+        addLine(text.substring(startIdx, endIdx));
+        startIdx = endIdx + 1;
+    }
+    if (startIdx < (int)text.length()) addLine(text.substring(startIdx));
+}
+
+void ScrollableTextArea::addLine(const String &text) {
+    if (text.length() == 0) {
+        linesBuffer.emplace_back("");
+        return;
+    }
+    size_t start = 0;
+    bool firstLine = true;
+    while (start < text.length()) {
+        String buff;
+        if (!firstLine && _indentWrappedLines) {
+            buff = " " + text.substring(start, start + _maxCharactersPerLine - 1);
+            start += _maxCharactersPerLine - 1;
+        } else {
+            buff = text.substring(start, start + _maxCharactersPerLine);
+            start += _maxCharactersPerLine;
+        }
+        if (buff.endsWith("\r")) buff.remove(buff.length() - 1);
+        linesBuffer.emplace_back(buff);
+        firstLine = false;
+    }
+}
+
+void ScrollableTextArea::draw(bool force) {
+    size_t lines = 0;
+    if (firstVisibleLine) lines++;
+    if (linesBuffer.size() - firstVisibleLine >= _maxVisibleLines) lines++;
+    for (size_t idx = firstVisibleLine; lines < _maxVisibleLines && idx < linesBuffer.size(); idx++) lines++;
+    lastVisibleLine = firstVisibleLine + lines;
+    hostTrace(
+        "textArea.draw(), rows %zu to %zu of %zu", firstVisibleLine, lastVisibleLine, linesBuffer.size()
+    );
+}
+
+// Closed right away, like Sel pressed as soon as it is shown
+void ScrollableTextArea::show(bool force) { draw(force); }
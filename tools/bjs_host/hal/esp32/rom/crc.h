@@ -0,0 +1,8 @@
+#ifndef __BJS_HOST_CRC_H__
+#define __BJS_HOST_CRC_H__
+#include <stdint.h>
+
+// Same CRC32 as the ESP32 ROM, so the bytecode cache is checked the same way
+uint32_t crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len);
+
+#endif
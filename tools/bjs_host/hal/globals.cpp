@@ -0,0 +1,155 @@
+#include "core/mykeyboard.h"
+#include "core/sd_functions.h"
+#include "core/wifi/wifi_common.h"
+#include "modules/ir/ir_read.h"
+#include "modules/rf/rf_scan.h"
+#include <HTTPClient.h>
+#include <esp32/rom/crc.h>
+#include <globals.h>
+
+BruceConfig bruceConfig;
+SerialCli serialCli;
+std::vector<Option> options;
+bool interpreter_start = false;
+bool returnToMenu = false;
+bool sdcardMounted = true; // the --root directory
+bool wifiConnected = false;
+String wifiIP = "";
+WiFiClass WiFi;
+
+volatile bool NextPress = false;
+volatile bool PrevPress = false;
+volatile bool UpPress = false;
+volatile bool DownPress = false;
+volatile bool SelPress = false;
+volatile bool EscPress = false;
+volatile bool AnyKeyPress = false;
+
+void hostPollTimeout() {
+    static uint64_t escPressedAt = 0;
+    if (hostOptions.timeoutMs == 0) return;
+    if (escPressedAt == 0 && hostMillis() >= hostOptions.timeoutMs) {
+        hostTrace("--timeout of %u ms over, pressing Esc", hostOptions.timeoutMs);
+        EscPress = true;
+        AnyKeyPress = true;
+        escPressedAt = hostMillis();
+    } else if (escPressedAt && hostMillis() - escPressedAt > 1000) {
+        hostStop("still running a second after Esc");
+    }
+}
+
+// Same as the firmware, without the input task to suspend
+bool check(volatile bool &btn) {
+    hostPollTimeout();
+    if (!btn) return false;
+    btn = false;
+    AnyKeyPress = false;
+    return true;
+}
+
+bool SerialCli::parse(String input) {
+    hostTrace("serialCli.parse(\"%s\") not run", input.c_str());
+    return false;
+}
+
+/*********************************************************************
+**  Storage
+**********************************************************************/
+bool setupSdCard() { return true; }
+
+char *readBigFile(FS &fs, String filepath, bool binary, size_t *fileSize) {
+    File file = fs.open(filepath);
+    if (!file || file.isDirectory()) {
+        Serial.printf("Could not open file: %s\n", filepath.c_str());
+        return NULL;
+    }
+    size_t fileLen = file.size();
+    char *buf = (char *)malloc(fileLen + 1);
+    if (fileSize != NULL) *fileSize = fileLen;
+    if (!buf) {
+        Serial.printf("Could not allocate memory for file: %s\n", filepath.c_str());
+        return NULL;
+    }
+    size_t bytesRead = file.read((uint8_t *)buf, fileLen);
+    buf[bytesRead] = '\0';
+    file.close();
+    return buf;
+}
+
+String hashFile(FS &fs, String filepath, FileHashType type, void (*progress)(size_t done, size_t total)) {
+    if (type != HASH_CRC32) {
+        hostTrace("hashFile(\"%s\", %d) not supported", filepath.c_str(), type);
+        return "";
+    }
+    File file = fs.open(filepath, FILE_READ);
+    if (!file || file.isDirectory()) return "";
+    uint8_t buf[4096];
+    uint32_t crc = 0;
+    size_t bytesRead;
+    while ((bytesRead = file.read(buf, sizeof(buf))) > 0) crc = crc32_le(crc, buf, bytesRead);
+    file.close();
+    char s[9];
+    snprintf(s, sizeof(s), "%08X", crc);
+    return String(s);
+}
+
+// Same polynomial and conditioning as the ESP32 ROM function
+uint32_t crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len) {
+    crc = ~crc;
+    while (len--) {
+        crc ^= *buf++;
+        for (int i = 0; i < 8; i++) crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+    }
+    return ~crc;
+}
+
+String loopSD(FS &fs, bool filePicker, String allowed_ext, String rootPath) {
+    hostTrace("loopSD(\"%s\"), closed", rootPath.c_str());
+    return "";
+}
+
+void viewFile(FS fs, String filepath) { hostTrace("viewFile(\"%s\")", filepath.c_str()); }
+
+String keyboard(String mytext, int maxSize, String msg) {
+    hostTrace("keyboard(\"%s\"), confirmed", msg.c_str());
+    return mytext;
+}
+
+/*********************************************************************
+**  Radios
+**********************************************************************/
+IrRead::IrRead(bool headless_mode, bool raw_mode) { hostTrace("IrRead(%d, %d)", headless_mode, raw_mode); }
+
+String IrRead::loop_headless(int max_loops) { return ""; }
+
+String RCSwitch_Read(float frequency, int max_loops, bool raw) {
+    hostTrace("RCSwitch_Read(%.2f, %d, %d)", frequency, max_loops, raw);
+    return "";
+}
+
+bool WiFiClass::mode(wifi_mode_t mode) {
+    hostTrace("WiFi.mode(%d)", mode);
+    return true;
+}
+
+wl_status_t WiFiClass::begin(const String &ssid, const String &passphrase) {
+    hostTrace("WiFi.begin(\"%s\")", ssid.c_str());
+    return WL_DISCONNECTED;
+}
+
+int16_t WiFiClass::scanNetworks() {
+    hostTrace("WiFi.scanNetworks()");
+    return 0;
+}
+
+bool HTTPClient::begin(const String &url) {
+    hostTrace("http.begin(\"%s\")", url.c_str());
+    return true;
+}
+
+bool wifiConnectMenu(wifi_mode_t mode) {
+    hostTrace("wifiConnectMenu(), closed");
+    return false;
+}
+
+void wifiDisconnect() { hostTrace("wifiDisconnect()"); }
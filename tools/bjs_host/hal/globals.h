@@ -0,0 +1,91 @@
+#ifndef __GLOBALS__
+#define __GLOBALS__
+#include "Arduino.h"
+#include "FS.h"
+#include "LittleFS.h"
+#include "SD.h"
+#include "tftLogger.h"
+#include <functional>
+#include <vector>
+
+// Bruce globals used by the interpreter, with the defaults of a fresh config
+
+#ifndef BRUCE_VERSION
+#define BRUCE_VERSION "dev"
+#endif
+#ifndef FP
+#define FP 1
+#endif
+#ifndef FM
+#define FM 2
+#endif
+#ifndef FG
+#define FG 3
+#endif
+#ifndef LH
+#define LH 8
+#endif
+#ifndef LW
+#define LW 6
+#endif
+#define ALCOLOR TFT_RED
+
+struct BruceConfig {
+    struct WiFiCredential {
+        String ssid;
+        String pwd;
+    };
+    uint16_t priColor = 0xA80F;
+    uint16_t secColor = 0x880F;
+    uint16_t bgColor = TFT_BLACK;
+    int rotation = 1;
+    int soundEnabled = 1;
+    float rfFreq = 433.92;
+    WiFiCredential wifiAp = {"BruceNet", "brucenet"};
+};
+
+// Commands are traced and not run, parse() returns false like for an unknown command
+class SerialCli {
+public:
+    bool parse(String input);
+};
+
+struct Option {
+    String label;
+    std::function<void()> operation;
+    bool selected = false;
+    bool (*hover)(void *hoverPointer, bool shouldRender);
+    void *hoverPointer;
+    bool hovered;
+
+    Option(
+        String lbl, const std::function<void()> &op, bool sel = false,
+        bool (*hov)(void *hoverPointer, bool shouldRender) = nullptr, void *ptr = nullptr, bool hvrd = false
+    )
+        : label(lbl), operation(op), selected(sel), hover(hov), hoverPointer(ptr), hovered(hvrd) {}
+};
+
+extern tft_logger tft;
+extern bool interpreter_start;
+extern BruceConfig bruceConfig;
+extern SerialCli serialCli;
+extern bool sdcardMounted;
+extern bool wifiConnected;
+extern String wifiIP;
+extern volatile int tftWidth;
+extern volatile int tftHeight;
+extern std::vector<Option> options;
+extern bool returnToMenu;
+
+// Never pressed, except Esc and AnyKey once --timeout is over
+extern volatile bool NextPress;
+extern volatile bool PrevPress;
+extern volatile bool UpPress;
+extern volatile bool DownPress;
+extern volatile bool SelPress;
+extern volatile bool EscPress;
+extern volatile bool AnyKeyPress;
+
+bool check(volatile bool &btn);
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef __BJS_HOST_H__
+#define __BJS_HOST_H__
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+/*
+ * Host side of the stand-in HAL: the firmware natives in
+ * src/modules/bjs_interpreter are built unchanged against the headers of
+ * this directory, which replace the Arduino core, the file systems and the
+ * Bruce functions they call.
+ */
+struct HostOptions {
+    std::string root = ".";     // stands in for the SD card and LittleFS, only read
+    std::string writes;         // files written by the script, read before root
+    bool trace = false;         // print every call to the hardware
+    bool profile = false;       // print the per-native report at the end
+    bool noDelay = false;       // delay() and timers advance a virtual clock instead of sleeping
+    uint32_t timeoutMs = 30000; // press Esc after this, 0 to wait forever
+    int width = 240;
+    int height = 135;
+};
+extern HostOptions hostOptions;
+
+// Duktape heap statistics, kept by the allocator in bjs_host.cpp
+extern size_t hostHeapUsed;
+extern size_t hostHeapPeak;
+extern size_t hostHeapLimit;
+
+uint64_t hostMillis();
+uint64_t hostMicros();
+void hostSleep(uint32_t ms);
+
+// Prints the call to stderr with --trace
+void hostTrace(const char *format, ...) __attribute__((format(printf, 1, 2)));
+// Same for the log_* macros, without the format check: firmware formats expect the 32-bit long of the ESP32
+void hostLog(const char *format, ...);
+
+// Host file behind a file system path: the written copy, else the one under root, "" once removed
+std::string hostPath(const char *path);
+
+// Presses Esc once --timeout is over, and stops a script still running a second later.
+// Called by check() and delay(), so a script busy in a loop that calls neither is not stopped
+void hostPollTimeout();
+
+// Prints the report and exits with 1, implemented in bjs_host.cpp
+[[noreturn]] void hostStop(const char *reason);
+
+#endif
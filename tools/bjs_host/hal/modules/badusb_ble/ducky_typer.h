@@ -0,0 +1,7 @@
+#ifndef __DUCKY_TYPER_H__
+#define __DUCKY_TYPER_H__
+#include <globals.h>
+
+// The host build has no USB_as_HID, the badusb natives are not registered
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef __IR_READ_H__
+#define __IR_READ_H__
+#include <globals.h>
+
+// Nothing received, loop_headless() returns ""
+class IrRead {
+public:
+    IrRead(bool headless_mode = false, bool raw_mode = false);
+    String loop_headless(int max_loops);
+};
+
+#endif
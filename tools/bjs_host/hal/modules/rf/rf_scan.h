@@ -0,0 +1,8 @@
+#ifndef __RF_SCAN_H__
+#define __RF_SCAN_H__
+#include <globals.h>
+
+// Nothing received, returns ""
+String RCSwitch_Read(float frequency = 0, int max_loops = -1, bool raw = false);
+
+#endif
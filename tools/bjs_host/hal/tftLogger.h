@@ -0,0 +1,12 @@
+#ifndef __BJS_HOST_TFT_LOGGER_H__
+#define __BJS_HOST_TFT_LOGGER_H__
+#include "TFT_eSPI.h"
+
+class tft_logger : public TFT_eSPI {
+public:
+    // Frame markers of the display profiler, traced
+    void beginFrame(const char *name);
+    void endFrame();
+};
+
+#endif
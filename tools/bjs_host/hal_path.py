@@ -0,0 +1,13 @@
+from os.path import join
+from typing import TYPE_CHECKING, Any
+
+if TYPE_CHECKING:
+    Import: Any = None
+    env: Any = {}
+    projenv: Any = {}
+
+Import("env", "projenv")  # type: ignore
+
+# The stand-in headers replace include/globals.h, src/core/*.h and the Arduino core,
+# so they must be searched before the project include and src folders
+projenv.Prepend(CPPPATH=[join(env.subst("$PROJECT_DIR"), "tools", "bjs_host", "hal")])
@@ -0,0 +1,214 @@
+#!/usr/bin/env python3
+"""Binary file transfer with the "storage put" / "storage get" serial commands.
+
+    bruce_transfer.py -p /dev/ttyUSB0 put firmware.bin /files/firmware.bin
+    bruce_transfer.py -p /dev/ttyUSB0 --fast 921600 get /BruceRF/capture.sub capture.sub
+
+The frame format is described in src/core/serial_transfer.h.
+"""
+
+import argparse
+import os
+import struct
+import sys
+import time
+import zlib
+
+import serial
+
+MAGIC = b"\xb5\x5b"
+TIMEOUT = 2.0  # XFER_TIMEOUT_MS
+RETRIES = 8  # XFER_RETRIES
+
+
+class TransferError(Exception):
+    pass
+
+
+def send_frame(port, kind, seq, payload=b""):
+    head = struct.pack("<cHH", kind, seq, len(payload))
+    crc = zlib.crc32(head + payload)
+    port.write(MAGIC + head + payload + struct.pack("<I", crc))
+
+
+def read_exact(port, size, deadline):
+    data = b""
+    while len(data) < size:
+        if time.monotonic() > deadline:
+            return None
+        data += port.read(size - len(data))
+    return data
+
+
+def read_frame(port, max_len):
+    """(kind, seq, payload), None on timeout or a bad frame."""
+    deadline = time.monotonic() + TIMEOUT
+    prev = b""
+    while True:
+        byte = read_exact(port, 1, deadline)
+        if byte is None:
+            return None
+        if prev + byte == MAGIC:
+            break
+        prev = byte
+    head = read_exact(port, 5, deadline)
+    if head is None:
+        return None
+    kind, seq, size = struct.unpack("<cHH", head)
+    if size > max_len:
+        return None
+    rest = read_exact(port, size + 4, deadline)
+    if rest is None:
+        return None
+    payload, (crc,) = rest[:size], struct.unpack("<I", rest[size:])
+    if crc != zlib.crc32(head + payload):
+        return None
+    return kind, seq, payload
+
+
+def read_line(port, prefix, timeout=10.0):
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        line = port.readline().decode(errors="replace").strip()
+        if line.startswith("XFER FAIL"):
+            raise TransferError(line)
+        if line.startswith(prefix):
+            return line.split()
+    raise TransferError("no '%s' from the device" % prefix)
+
+
+def start(port, command):
+    port.reset_input_buffer()
+    port.write((command + "\n").encode())
+    _, _, size, chunk, baud = read_line(port, "XFER READY")
+    if int(baud):
+        port.flush()
+        port.baudrate = int(baud)
+    return int(size), int(chunk)
+
+
+def finish(port, console_baud):
+    if port.baudrate != console_baud:
+        time.sleep(0.02)  # the device is back at the console speed 50ms after the last frame
+        port.baudrate = console_baud
+    _, _, size, ms = read_line(port, "XFER OK")
+    return int(size), int(ms)
+
+
+def put(port, local, remote, fast):
+    with open(local, "rb") as f:
+        data = f.read()
+    console_baud = port.baudrate
+    _, chunk = start(port, "storage put %s %d %d" % (remote, len(data), fast))
+    frames = [data[i : i + chunk] for i in range(0, len(data), chunk)]
+    end = struct.pack("<II", len(data), zlib.crc32(data))
+
+    seq, retries, started = 0, 0, False
+    while True:
+        reply = read_frame(port, 8)
+        if reply is None:
+            retries += 1
+            if retries > RETRIES:
+                raise TransferError("no answer from the device")
+            if started:
+                send_frame_seq(port, frames, end, seq)  # the frame or its ACK got lost
+            continue
+        retries = 0
+        kind, rseq, _ = reply
+        if kind == b"X":
+            break  # the device prints why
+        # Asking for the next frame also acknowledges this one, in case its ACK got lost
+        acked = kind == b"A" and rseq == seq & 0xFFFF
+        acked = acked or (kind == b"N" and rseq == (seq + 1) & 0xFFFF and seq < len(frames))
+        if started and acked:
+            if seq == len(frames):
+                break
+            seq += 1
+            progress(seq * chunk, len(data))
+        elif kind != b"N" or rseq != seq & 0xFFFF:
+            continue
+        send_frame_seq(port, frames, end, seq)
+        started = True
+    return finish(port, console_baud)
+
+
+def send_frame_seq(port, frames, end, seq):
+    if seq < len(frames):
+        send_frame(port, b"D", seq & 0xFFFF, frames[seq])
+    else:
+        send_frame(port, b"E", seq & 0xFFFF, end)
+
+
+def get(port, remote, local, fast):
+    console_baud = port.baudrate
+    size, chunk = start(port, "storage get %s %d" % (remote, fast))
+    data = bytearray()
+    seq, retries = 0, 0
+    send_frame(port, b"N", seq)
+    while True:
+        frame = read_frame(port, chunk)
+        if frame is None:
+            retries += 1
+            if retries > RETRIES:
+                send_frame(port, b"X", seq & 0xFFFF)
+                raise TransferError("no answer from the device")
+            send_frame(port, b"N", seq & 0xFFFF)
+            continue
+        retries = 0
+        kind, fseq, payload = frame
+        if kind == b"X":
+            break
+        if kind == b"D" and fseq == seq & 0xFFFF:
+            # If this ACK gets lost, "N seq + 1" after the timeout acknowledges the frame too
+            data += payload
+            send_frame(port, b"A", fseq)
+            seq += 1
+            progress(len(data), size)
+        elif kind == b"D" and fseq == (seq - 1) & 0xFFFF:
+            send_frame(port, b"A", fseq)
+        elif kind == b"E" and fseq == seq & 0xFFFF:
+            end_size, end_crc = struct.unpack("<II", payload)
+            if end_size != len(data) or end_crc != zlib.crc32(data):
+                send_frame(port, b"X", fseq)
+                raise TransferError("size or CRC mismatch")
+            send_frame(port, b"A", fseq)
+            break
+        else:
+            send_frame(port, b"N", seq & 0xFFFF)
+    result = finish(port, console_baud)
+    with open(local, "wb") as f:
+        f.write(data)
+    return result
+
+
+def progress(done, total):
+    if total:
+        sys.stderr.write("\r%3d%%" % (min(done, total) * 100 // total))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("-p", "--port", required=True, help="serial port of the device")
+    parser.add_argument("-b", "--baud", type=int, default=115200, help="console speed (default 115200)")
+    parser.add_argument("--fast", type=int, default=0, metavar="BAUD", help="speed during the transfer")
+    parser.add_argument("action", choices=["put", "get"])
+    parser.add_argument("source")
+    parser.add_argument("dest")
+    args = parser.parse_args()
+
+    with serial.Serial(args.port, args.baud, timeout=0.1) as port:
+        try:
+            if args.action == "put":
+                size, ms = put(port, args.source, args.dest, args.fast)
+            else:
+                size, ms = get(port, args.source, args.dest, args.fast)
+        except (TransferError, OSError) as e:
+            sys.stderr.write("\n%s\n" % e)
+            return 1
+    sys.stderr.write("\r")
+    print("%d bytes in %.2fs, %.1f KB/s" % (size, ms / 1000.0, size / 1024.0 / max(ms, 1) * 1000))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())